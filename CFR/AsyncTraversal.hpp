@@ -0,0 +1,223 @@
+#ifndef ASYNCTRAVERSAL_HPP
+#define ASYNCTRAVERSAL_HPP
+
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../Storage/NodeStorage.hpp"
+
+namespace CFR {
+
+/// @brief Fixed set of threads running blocking storage reads for the trainers
+class IoThreadPool {
+public:
+    explicit IoThreadPool(uint32_t numThreads = 4) {
+        if (numThreads == 0) {
+            throw std::invalid_argument("I/O pool needs at least one thread");
+        }
+        m_threads.reserve(numThreads);
+        for (uint32_t i = 0; i < numThreads; ++i) {
+            m_threads.emplace_back([this] { run(); });
+        }
+    }
+
+    ~IoThreadPool() {
+        {
+            std::lock_guard lock(m_mutex);
+            m_stopping = true;
+        }
+        m_condition.notify_all();
+        for (auto& thread : m_threads) {
+            thread.join();
+        }
+    }
+
+    IoThreadPool(const IoThreadPool&) = delete;
+    IoThreadPool& operator=(const IoThreadPool&) = delete;
+
+    /// @brief Queue a job, jobs still queued at destruction are run before the threads exit
+    void post(std::function<void()> job) {
+        {
+            std::lock_guard lock(m_mutex);
+            m_jobs.push_back(std::move(job));
+        }
+        m_condition.notify_one();
+    }
+
+private:
+    void run() {
+        while (true) {
+            std::function<void()> job;
+            {
+                std::unique_lock lock(m_mutex);
+                m_condition.wait(lock, [this] { return m_stopping || !m_jobs.empty(); });
+                if (m_jobs.empty()) {
+                    return;
+                }
+                job = std::move(m_jobs.front());
+                m_jobs.pop_front();
+            }
+            job();
+        }
+    }
+
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::deque<std::function<void()>> m_jobs;
+    bool m_stopping = false;
+};
+
+/// @brief Coroutine driven by hand, starts suspended and stays suspended at its end so the owner can destroy it
+class TraversalTask {
+public:
+    struct promise_type {
+        std::exception_ptr error;
+
+        TraversalTask get_return_object() { return TraversalTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { error = std::current_exception(); }
+    };
+
+    explicit TraversalTask(std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+    TraversalTask(TraversalTask&& other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) {}
+    TraversalTask& operator=(TraversalTask&&) = delete;
+    TraversalTask(const TraversalTask&) = delete;
+    ~TraversalTask() {
+        if (m_handle) {
+            m_handle.destroy();
+        }
+    }
+
+    void resume() const { m_handle.resume(); }
+    [[nodiscard]] bool done() const { return m_handle.done(); }
+    [[nodiscard]] std::exception_ptr error() const { return m_handle.promise().error; }
+
+private:
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+/// @brief Node reads of one worker's in-flight traversals, issued to an I/O pool and resumed on the worker's thread
+/// @details A traversal that misses co_awaits read(key) and the worker moves on to its other traversals. Reads of a key
+/// already in flight join the outstanding one, so two traversals never load separate copies of the same node.
+class AsyncNodeReads {
+public:
+    AsyncNodeReads(NodeStorage& storage, IoThreadPool& pool) : m_storage(storage), m_pool(pool) {}
+
+    AsyncNodeReads(const AsyncNodeReads&) = delete;
+    AsyncNodeReads& operator=(const AsyncNodeReads&) = delete;
+
+    /// @brief Awaitable for one node, resumes with the stored node or nullptr when there is none
+    class Read {
+    public:
+        Read(AsyncNodeReads& reads, const std::string& infoSet) : m_reads(reads), m_infoSet(infoSet) {}
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) {
+            m_handle = handle;
+            m_reads.submit(this);
+        }
+        std::shared_ptr<Node> await_resume() {
+            if (m_error) {
+                std::rethrow_exception(m_error);
+            }
+            return std::move(m_node);
+        }
+
+    private:
+        friend class AsyncNodeReads;
+
+        AsyncNodeReads& m_reads;
+        const std::string& m_infoSet;
+        std::coroutine_handle<> m_handle;
+        std::shared_ptr<Node> m_node;
+        std::exception_ptr m_error;
+    };
+
+    /// @brief Suspend the calling traversal until the node for infoSet has been read
+    /// @param infoSet Must stay alive and unchanged until the read resumes
+    Read read(const std::string& infoSet) { return Read(*this, infoSet); }
+
+    /// @brief Reads issued and not yet delivered
+    [[nodiscard]] size_t outstanding() const { return m_waiting.size(); }
+
+    /// @brief Block for the next finished read, admit its node to storage and resume every traversal waiting on it
+    void resumeNext() {
+        Completion completion;
+        {
+            std::unique_lock lock(m_mutex);
+            m_condition.wait(lock, [this] { return !m_completed.empty(); });
+            completion = std::move(m_completed.front());
+            m_completed.pop_front();
+        }
+
+        const auto it = m_waiting.find(completion.infoSet);
+        std::vector<Read*> waiters = std::move(it->second);
+        m_waiting.erase(it);
+
+        if (!completion.error && completion.node) {
+            m_storage.admitNode(completion.infoSet, completion.node);
+        }
+        for (Read* waiter : waiters) {
+            waiter->m_node = completion.node;
+            waiter->m_error = completion.error;
+            waiter->m_handle.resume();
+        }
+    }
+
+private:
+    struct Completion {
+        std::string infoSet;
+        std::shared_ptr<Node> node;
+        std::exception_ptr error;
+    };
+
+    void submit(Read* read) {
+        auto [it, inserted] = m_waiting.try_emplace(read->m_infoSet);
+        it->second.push_back(read);
+        if (!inserted) {
+            return;
+        }
+        m_pool.post([this, infoSet = read->m_infoSet] {
+            Completion completion{infoSet, nullptr, nullptr};
+            try {
+                completion.node = m_storage.loadNode(infoSet);
+            } catch (...) {
+                completion.error = std::current_exception();
+            }
+            {
+                std::lock_guard lock(m_mutex);
+                m_completed.push_back(std::move(completion));
+            }
+            m_condition.notify_one();
+        });
+    }
+
+    NodeStorage& m_storage;
+    IoThreadPool& m_pool;
+
+    /// owned by the worker thread
+    std::unordered_map<std::string, std::vector<Read*>> m_waiting;
+
+    /// shared with the I/O threads
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::deque<Completion> m_completed;
+};
+
+} // namespace CFR
+
+#endif //ASYNCTRAVERSAL_HPP
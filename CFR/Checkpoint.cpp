@@ -0,0 +1,173 @@
+#include "Checkpoint.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace CFR {
+namespace {
+
+const std::string CheckpointPrefix = "checkpoint-";
+const std::string StagingSuffix = ".partial";
+
+/// @brief Iteration count in a published checkpoint directory name, nullopt for anything else
+std::optional<uint64_t> checkpointIterations(const std::filesystem::path& dir) {
+    const std::string name = dir.filename().string();
+    if (!name.starts_with(CheckpointPrefix) || name.ends_with(StagingSuffix)) {
+        return std::nullopt;
+    }
+    try {
+        return std::stoull(name.substr(CheckpointPrefix.size()));
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
+} // namespace
+
+void TrainingGate::enter() {
+    std::unique_lock lock(m_mutex);
+    m_condition.wait(lock, [this] { return !m_paused; });
+    ++m_active;
+}
+
+void TrainingGate::leave() {
+    {
+        std::lock_guard lock(m_mutex);
+        --m_active;
+    }
+    m_condition.notify_all();
+}
+
+void TrainingGate::pause() {
+    std::unique_lock lock(m_mutex);
+    // a second pauser waits for the first to resume
+    m_condition.wait(lock, [this] { return !m_paused; });
+    m_paused = true;
+    m_condition.wait(lock, [this] { return m_active == 0; });
+}
+
+void TrainingGate::resume() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_paused = false;
+    }
+    m_condition.notify_all();
+}
+
+void CheckpointManifest::write(const std::filesystem::path& path) const {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Failed to create checkpoint manifest " + path.string());
+    }
+    out << "format " << FormatVersion << '\n'
+        << "game " << game << '\n'
+        << "masterSeed " << masterSeed << '\n'
+        << "iterations " << iterations << '\n'
+        << "runRemaining " << runRemaining << '\n'
+        << "numThreads " << numThreads << '\n'
+        << "batchSize " << batchSize << '\n'
+        << "asyncInFlight " << asyncInFlight << '\n';
+    for (const std::string& engine : engines) {
+        out << "engine " << engine << '\n';
+    }
+    out.flush();
+    if (!out) {
+        throw std::runtime_error("Failed to write checkpoint manifest " + path.string());
+    }
+}
+
+CheckpointManifest CheckpointManifest::read(const std::filesystem::path& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("Failed to open checkpoint manifest " + path.string());
+    }
+    CheckpointManifest manifest;
+    uint32_t format = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+        const size_t space = line.find(' ');
+        const std::string key = line.substr(0, space);
+        const std::string value = space == std::string::npos ? std::string() : line.substr(space + 1);
+        std::istringstream field(value);
+        if (key == "format") field >> format;
+        else if (key == "game") manifest.game = value;
+        else if (key == "masterSeed") field >> manifest.masterSeed;
+        else if (key == "iterations") field >> manifest.iterations;
+        else if (key == "runRemaining") field >> manifest.runRemaining;
+        else if (key == "numThreads") field >> manifest.numThreads;
+        else if (key == "batchSize") field >> manifest.batchSize;
+        else if (key == "asyncInFlight") field >> manifest.asyncInFlight;
+        else if (key == "engine") manifest.engines.push_back(value);
+    }
+    if (format == 0 || format > FormatVersion) {
+        throw std::runtime_error("Unsupported checkpoint manifest format in " + path.string());
+    }
+    if (manifest.engines.size() != manifest.numThreads) {
+        throw std::runtime_error("Checkpoint manifest " + path.string() + " is missing worker engine states");
+    }
+    return manifest;
+}
+
+std::filesystem::path beginCheckpoint(const std::filesystem::path& root, uint64_t iterations) {
+    std::filesystem::path staging = root / (CheckpointPrefix + std::to_string(iterations) + StagingSuffix);
+    std::filesystem::remove_all(staging);
+    std::filesystem::create_directories(staging);
+    return staging;
+}
+
+std::filesystem::path commitCheckpoint(const std::filesystem::path& staging, uint32_t keep) {
+    const std::filesystem::path root = staging.parent_path();
+    std::string name = staging.filename().string();
+    name.resize(name.size() - StagingSuffix.size());
+    // a second checkpoint at the same iteration count gets its own name, LATEST may still point at the first
+    const std::string base = name;
+    for (uint32_t repeat = 1; std::filesystem::exists(root / name); ++repeat) {
+        name = base + "-" + std::to_string(repeat);
+    }
+    const std::filesystem::path published = root / name;
+    std::filesystem::rename(staging, published);
+
+    const std::filesystem::path latest = root / "LATEST";
+    std::filesystem::path latestTemporary = latest;
+    latestTemporary += ".tmp";
+    {
+        std::ofstream out(latestTemporary, std::ios::trunc);
+        out << name << '\n';
+        out.flush();
+        if (!out) {
+            throw std::runtime_error("Failed to write " + latestTemporary.string());
+        }
+    }
+    std::filesystem::rename(latestTemporary, latest);
+
+    std::vector<std::pair<uint64_t, std::filesystem::path>> checkpoints;
+    for (const auto& entry : std::filesystem::directory_iterator(root)) {
+        if (const auto iterations = checkpointIterations(entry.path()); iterations && entry.is_directory()) {
+            checkpoints.emplace_back(*iterations, entry.path());
+        }
+    }
+    std::ranges::sort(checkpoints, std::greater<>{});
+    for (size_t i = std::max<size_t>(keep, 1); i < checkpoints.size(); ++i) {
+        if (checkpoints[i].second != published) {
+            std::filesystem::remove_all(checkpoints[i].second);
+        }
+    }
+    return published;
+}
+
+std::optional<std::filesystem::path> latestCheckpoint(const std::filesystem::path& root) {
+    std::ifstream in(root / "LATEST");
+    std::string name;
+    if (!(in >> name)) {
+        return std::nullopt;
+    }
+    std::filesystem::path dir = root / name;
+    if (!std::filesystem::exists(dir / CheckpointManifest::FileName)) {
+        return std::nullopt;
+    }
+    return dir;
+}
+
+} // namespace CFR
@@ -0,0 +1,84 @@
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace CFR {
+
+/// @brief Lets a checkpoint hold trainer threads between units of work
+/// @details Workers wrap each grain of iterations in enter/leave. pause() stops new grains from starting and returns
+/// once the grains in progress are done, so storage and RNG state are not being changed while they are captured.
+class TrainingGate {
+public:
+    /// @brief Called by a worker before a unit of work, blocks while a pause is in effect
+    void enter();
+    void leave();
+
+    /// @brief Hold workers at their next enter and wait for every started unit to leave
+    void pause();
+    void resume();
+
+    /// @brief Pause for the lifetime of the object
+    class Pause {
+    public:
+        explicit Pause(TrainingGate& gate) : m_gate(gate) { m_gate.pause(); }
+        ~Pause() { m_gate.resume(); }
+        Pause(const Pause&) = delete;
+        Pause& operator=(const Pause&) = delete;
+
+    private:
+        TrainingGate& m_gate;
+    };
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    uint32_t m_active = 0;
+    bool m_paused = false;
+};
+
+/// @brief Trainer state stored next to the nodes of a checkpoint, as a text file of "key value" lines
+struct CheckpointManifest {
+    static constexpr uint32_t FormatVersion = 1;
+    static constexpr const char* FileName = "trainer.state";
+
+    /// @brief Identifies the game type the nodes belong to
+    std::string game;
+    uint64_t masterSeed = 0;
+    /// @brief Iterations trained over every run up to the checkpoint
+    uint64_t iterations = 0;
+    /// @brief Iterations of the run in progress that had not been trained yet, 0 if no run was active
+    uint64_t runRemaining = 0;
+    uint32_t numThreads = 0;
+    uint32_t batchSize = 0;
+    uint32_t asyncInFlight = 0;
+    /// @brief Engine state of each worker in the engine's stream format
+    std::vector<std::string> engines;
+
+    void write(const std::filesystem::path& path) const;
+
+    /// @throws std::runtime_error if the file is missing, from a newer format or incomplete
+    [[nodiscard]] static CheckpointManifest read(const std::filesystem::path& path);
+};
+
+/// @brief Create an empty staging directory for a checkpoint under root, replacing a stale one
+[[nodiscard]] std::filesystem::path beginCheckpoint(const std::filesystem::path& root, uint64_t iterations);
+
+/// @brief Publish a fully written staging directory
+/// @details The directory is renamed into place, then root/LATEST is replaced by rename to name it. A crash at any
+/// point leaves LATEST naming a complete checkpoint. Only the newest keep checkpoints are retained.
+/// @return The published checkpoint directory
+std::filesystem::path commitCheckpoint(const std::filesystem::path& staging, uint32_t keep = 2);
+
+/// @brief Directory named by root/LATEST, nullopt when root holds no committed checkpoint
+[[nodiscard]] std::optional<std::filesystem::path> latestCheckpoint(const std::filesystem::path& root);
+
+} // namespace CFR
+
+#endif //CHECKPOINT_HPP
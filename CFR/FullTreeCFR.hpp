@@ -0,0 +1,427 @@
+#ifndef FULLTREECFR_HPP
+#define FULLTREECFR_HPP
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Node.hpp"
+#include "PublicTree.hpp"
+#include "WorkStealingScheduler.hpp"
+#include "../Game/Utility/HandAbstraction/hand_index.h"
+#include "../Storage/NodeStorage.hpp"
+
+namespace CFR {
+
+/// @brief How a FullTreeCFR deals its boards and splits them over threads
+struct FullTreeOptions {
+    uint32_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    /// @brief Solve over this many random boards, drawn once and kept for every iteration, instead of every board; 0 is exact
+    uint64_t boardSamples = 0;
+    /// @brief Seed of the board sample, the same seed gives BestResponse the same boards
+    uint64_t seed = 0;
+};
+
+/// @brief Vanilla CFR over the whole tree of a game whose board is dealt in one chance node, as Preflop's is
+/// @details Nothing is sampled while iterating. The PublicTree is walked with a vector holding a reach for every one of the 1326 hole
+/// card pairs, so one walk updates the info sets of every private hand, and the board is enumerated with one board per
+/// suit isomorphism class weighted by the class size. Each iteration updates seat 0 and then seat 1 against the other
+/// seat's current strategy, which makes it deterministic and its average strategy converge to an equilibrium without
+/// sampling noise; BestResponse over the same boards measures how far it has got.
+///
+/// The boards are split into a fixed number of chunks handed to the worker threads by a WorkStealingScheduler. Boards of
+/// different isomorphism classes never share a postflop info set, so workers update their own nodes without locking, and
+/// the chunks' preflop values are added in chunk order, so the result does not depend on the thread count. With more
+/// than one thread the storage must allow concurrent use, as ShardedLRUCache does, and it must keep every node: the
+/// exact tree holds an info set per isomorphic hand and board for each postflop decision, far beyond one machine's memory
+/// for Preflop, so the exact mode is meant for smaller games and boardSamples for solving Preflop on a board sample.
+template <typename GameType>
+class FullTreeCFR {
+    static_assert(GameType::cardsPerRound.size() == 2, "FullTreeCFR deals the whole board at one chance node");
+
+public:
+    explicit FullTreeCFR(std::shared_ptr<NodeStorage> storage, FullTreeOptions options = {});
+
+    /// @brief Run iterations, each one updating both seats over every board
+    void Train(uint32_t iterations);
+
+    [[nodiscard]] uint64_t getIterations() const { return m_iterations; }
+
+    /// @brief Boards each iteration walks, one per suit isomorphism class present
+    [[nodiscard]] size_t getBoards() const { return m_boards.size(); }
+
+    [[nodiscard]] const std::shared_ptr<NodeStorage>& getStorage() const { return m_storage; }
+
+private:
+    using Tree = PublicTree<GameType>;
+    using PublicNode = typename Tree::PublicNode;
+    using Board = typename Tree::Board;
+    using Range = typename Tree::Range;
+
+    static constexpr uint32_t HandCount = Tree::HandCount;
+    /// @brief Boards are summed in this many chunks whatever the thread count
+    static constexpr size_t MaxChunks = 256;
+
+    /// @brief A worker's current board with every live hand's info set index and strength
+    struct Deal {
+        uint64_t mask = 0;
+        std::vector<hand_index_t> indices;
+        std::vector<int> strength;
+        std::vector<uint16_t> byStrength;
+        std::string key;
+    };
+
+    /// @brief Nodes and current strategy, hand major, of the hands at one decision
+    struct Policy {
+        std::vector<std::shared_ptr<Node>> nodes;
+        std::vector<float> strategy;
+    };
+
+    [[nodiscard]] bool live(uint32_t hand, uint64_t mask) const { return m_tree.live(hand, mask); }
+    void dealBoard(Deal& deal, const Board& board) const;
+
+    /// @brief Current strategy at node of every live hand with reach, creating the nodes of info sets not seen yet
+    void fetch(const PublicNode& node, std::span<const hand_index_t> indices, uint64_t mask, const Range& reach,
+               std::string& key, Policy& policy) const;
+
+    /// @brief One half iteration, updating player's regrets against the other seat's current strategy
+    void traverse(int player);
+
+    /// @brief Both seats' reach at each preflop chance node, adding player's preflop strategies to their averages
+    void collectReach(uint32_t id, const std::array<Range, 2>& reach, int player, std::vector<std::array<Range, 2>>& out);
+
+    /// @brief Value of each of player's hands below postflop node id on the deal's board, updating player's nodes
+    void walkBoard(Deal& deal, uint32_t id, const Range& own, const Range& opp, int player, double weight, Range& out) const;
+
+    /// @brief Value of each of player's hands below preflop node id, updating player's preflop regrets
+    void walkPreflop(uint32_t id, const Range& opp, int player, const std::vector<Range>& slotValues, Range& out);
+
+
+    /// @brief Adds the regret of every action against the node value to each hand's node, then regret matches
+    static void updateRegrets(Policy& policy, const std::vector<Range>& actionValues, const Range& value,
+                              std::span<const uint32_t> hands, double weight);
+
+    std::shared_ptr<NodeStorage> m_storage;
+    FullTreeOptions m_options;
+    uint64_t m_iterations = 0;
+
+    Tree m_tree;
+    std::vector<Board> m_boards;
+    /// @brief Board weight each hand's suit class sees, the preflop values are means over it
+    Range m_classCoverage;
+    /// @brief Per chunk and slot sums of the board values, the only state workers write besides their own nodes
+    std::vector<std::vector<Range>> m_chunkValues;
+    WorkStealingScheduler m_scheduler;
+
+    /// @brief Preflop decisions' policies, fetched once per half iteration and reused to update the regrets
+    std::vector<Policy> m_preflop;
+};
+
+template <typename GameType>
+FullTreeCFR<GameType>::FullTreeCFR(std::shared_ptr<NodeStorage> storage, FullTreeOptions options)
+    : m_storage(std::move(storage)), m_options(options), m_scheduler(std::max(1u, options.numThreads), 8)
+{
+    if (m_options.numThreads == 0) {
+        throw std::invalid_argument("FullTreeCFR needs at least one thread");
+    }
+    if (m_storage == nullptr) {
+        throw std::invalid_argument("FullTreeCFR needs a storage to train into");
+    }
+    m_preflop.resize(m_tree.size());
+    // the same boards BestResponse walks for these options, a class drawn twice is walked once with twice the weight,
+    // which also keeps two workers from updating one node
+    m_boards = Tree::firstBoards(m_options.boardSamples, m_options.seed);
+    m_classCoverage = m_tree.classCoverage(m_boards);
+    m_chunkValues.assign(std::min(MaxChunks, m_boards.size()), std::vector<Range>(m_tree.firstDeals().size()));
+}
+
+template <typename GameType>
+void FullTreeCFR<GameType>::dealBoard(Deal& deal, const Board& board) const
+{
+    deal.mask = 0;
+    for (const uint8_t card : board.cards) {
+        deal.mask |= uint64_t{1} << card;
+    }
+    deal.indices.resize(HandCount);
+    const hand_indexer_t& indexer = GameType::Cards::indexer();
+    for (uint32_t h = 0; h < HandCount; ++h) {
+        if (live(h, deal.mask)) {
+            hand_indexer_state_t state = m_tree.holeStates()[h];
+            deal.indices[h] = hand_index_next_round(&indexer, board.cards.data(), &state);
+        }
+    }
+    m_tree.rankHands(board.cards, deal.mask, deal.strength, deal.byStrength);
+}
+
+template <typename GameType>
+void FullTreeCFR<GameType>::fetch(const PublicNode& node, std::span<const hand_index_t> indices, uint64_t mask,
+                                  const Range& reach, std::string& key, Policy& policy) const
+{
+    const size_t actions = node.children.size();
+    policy.nodes.assign(HandCount, nullptr);
+    policy.strategy.assign(HandCount * actions, 0.0f);
+    for (uint32_t h = 0; h < HandCount; ++h) {
+        if (reach[h] <= 0 || !live(h, mask)) {
+            continue;
+        }
+        char digits[20];
+        const auto end = std::to_chars(digits, digits + sizeof(digits), indices[h]).ptr;
+        key.assign(digits, end);
+        key += node.history;
+
+        std::shared_ptr<Node> stored = m_storage->getNode(key);
+        if (stored == nullptr) {
+            stored = std::make_shared<Node>(static_cast<uint8_t>(actions));
+            m_storage->putNode(key, stored);
+        }
+        const std::vector<float>& strategy = stored->getStrategy();
+        if (strategy.size() != actions) {
+            throw std::logic_error("Info set " + key + " has " + std::to_string(strategy.size()) + " actions, the game has " +
+                                   std::to_string(actions));
+        }
+        std::copy(strategy.begin(), strategy.end(), policy.strategy.begin() + static_cast<std::ptrdiff_t>(h * actions));
+        policy.nodes[h] = std::move(stored);
+    }
+}
+
+template <typename GameType>
+void FullTreeCFR<GameType>::Train(uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; ++i) {
+        for (int player = 0; player < 2; ++player) {
+            traverse(player);
+        }
+        ++m_iterations;
+    }
+}
+
+template <typename GameType>
+void FullTreeCFR<GameType>::traverse(int player)
+{
+    const std::vector<uint32_t>& firstDeals = m_tree.firstDeals();
+    std::vector<std::array<Range, 2>> reach(firstDeals.size());
+    collectReach(m_tree.root(), {Range(HandCount, 1.0), Range(HandCount, 1.0)}, player, reach);
+
+    const size_t chunks = m_chunkValues.size();
+    m_scheduler.reset(chunks);
+    {
+        std::vector<std::jthread> threads;
+        threads.reserve(m_options.numThreads);
+        for (uint32_t w = 0; w < m_options.numThreads; ++w) {
+            threads.emplace_back([&, w] {
+                Deal deal;
+                Range own(HandCount);
+                Range opp(HandCount);
+                Range out(HandCount);
+                for (auto range = m_scheduler.next(w); range.size() > 0; range = m_scheduler.next(w)) {
+                    for (uint64_t chunk = range.begin; chunk < range.end; ++chunk) {
+                        std::vector<Range>& values = m_chunkValues[chunk];
+                        for (Range& value : values) {
+                            value.assign(HandCount, 0.0);
+                        }
+                        const size_t first = m_boards.size() * chunk / chunks;
+                        const size_t last = m_boards.size() * (chunk + 1) / chunks;
+                        for (size_t b = first; b < last; ++b) {
+                            const Board& board = m_boards[b];
+                            dealBoard(deal, board);
+                            for (size_t slot = 0; slot < firstDeals.size(); ++slot) {
+                                for (uint32_t h = 0; h < HandCount; ++h) {
+                                    own[h] = live(h, deal.mask) ? reach[slot][player][h] : 0.0;
+                                    opp[h] = live(h, deal.mask) ? reach[slot][1 - player][h] : 0.0;
+                                }
+                                walkBoard(deal, m_tree.node(firstDeals[slot]).children[0], own, opp, player, board.weight, out);
+                                for (uint32_t h = 0; h < HandCount; ++h) {
+                                    values[slot][h] += board.weight * out[h];
+                                }
+                            }
+                        }
+                    }
+                }
+            });
+        }
+    }
+
+    std::vector<Range> slotValues(firstDeals.size());
+    for (size_t slot = 0; slot < firstDeals.size(); ++slot) {
+        Range total(HandCount, 0.0);
+        for (const std::vector<Range>& values : m_chunkValues) {
+            for (uint32_t h = 0; h < HandCount; ++h) {
+                total[h] += values[slot][h];
+            }
+        }
+        m_tree.resolveFirstDeal(total, m_classCoverage, slotValues[slot]);
+    }
+
+    Range out(HandCount);
+    walkPreflop(m_tree.root(), Range(HandCount, 1.0), player, slotValues, out);
+}
+
+template <typename GameType>
+void FullTreeCFR<GameType>::collectReach(uint32_t id, const std::array<Range, 2>& reach, int player,
+                                         std::vector<std::array<Range, 2>>& out)
+{
+    const PublicNode& node = m_tree.node(id);
+    if (PublicNode::Kind::Chance == node.kind) {
+        out[node.firstDeal] = reach;
+        return;
+    }
+    if (PublicNode::Kind::Action != node.kind) {
+        return;
+    }
+    // every hand is fetched, player's hands need their regrets updated even where their own reach is gone
+    std::string key;
+    Policy& policy = m_preflop[id];
+    fetch(node, m_tree.holeIndices(), 0, Range(HandCount, 1.0), key, policy);
+    const size_t actions = node.children.size();
+    if (node.player == player) {
+        std::vector<float> strategy(actions);
+        for (uint32_t h = 0; h < HandCount; ++h) {
+            std::copy_n(policy.strategy.begin() + static_cast<std::ptrdiff_t>(h * actions), actions, strategy.begin());
+            policy.nodes[h]->updateStrategySum(strategy, static_cast<float>(reach[player][h]));
+        }
+    }
+    for (size_t a = 0; a < actions; ++a) {
+        std::array<Range, 2> child = reach;
+        for (uint32_t h = 0; h < HandCount; ++h) {
+            child[node.player][h] *= policy.strategy[h * actions + a];
+        }
+        collectReach(node.children[a], child, player, out);
+    }
+}
+
+template <typename GameType>
+void FullTreeCFR<GameType>::walkBoard(Deal& deal, uint32_t id, const Range& own, const Range& opp, int player,
+                                      double weight, Range& out) const
+{
+    const PublicNode& node = m_tree.node(id);
+    out.assign(HandCount, 0.0);
+    // nothing below is reached by the opponent, every counterfactual value is zero
+    if (std::ranges::none_of(opp, [](double r) { return r > 0; })) {
+        return;
+    }
+
+    switch (node.kind) {
+    case PublicNode::Kind::Fold:
+        m_tree.foldValues(node, deal.mask, opp, player, out);
+        return;
+    case PublicNode::Kind::Showdown:
+        m_tree.showdown(node, deal.byStrength, deal.strength, opp, player, out);
+        return;
+    case PublicNode::Kind::Chance:
+        throw std::logic_error("chance node after the board is dealt");
+    case PublicNode::Kind::Action:
+        break;
+    }
+
+    const size_t actions = node.children.size();
+    Policy policy;
+    std::vector<Range> actionValues(actions, Range(HandCount));
+    if (node.player == player) {
+        fetch(node, deal.indices, deal.mask, Range(HandCount, 1.0), deal.key, policy);
+        Range childOwn(HandCount);
+        for (size_t a = 0; a < actions; ++a) {
+            for (uint32_t h = 0; h < HandCount; ++h) {
+                childOwn[h] = own[h] * policy.strategy[h * actions + a];
+            }
+            walkBoard(deal, node.children[a], childOwn, opp, player, weight, actionValues[a]);
+            for (uint32_t h = 0; h < HandCount; ++h) {
+                out[h] += policy.strategy[h * actions + a] * actionValues[a][h];
+            }
+        }
+        std::vector<float> strategy(actions);
+        for (const uint16_t h : deal.byStrength) {
+            std::copy_n(policy.strategy.begin() + static_cast<std::ptrdiff_t>(h * actions), actions, strategy.begin());
+            policy.nodes[h]->updateStrategySum(strategy, static_cast<float>(weight * own[h]));
+        }
+        const std::vector<uint32_t> hands(deal.byStrength.begin(), deal.byStrength.end());
+        updateRegrets(policy, actionValues, out, hands, weight);
+        return;
+    }
+
+    fetch(node, deal.indices, deal.mask, opp, deal.key, policy);
+    Range childOpp(HandCount);
+    for (size_t a = 0; a < actions; ++a) {
+        for (uint32_t h = 0; h < HandCount; ++h) {
+            childOpp[h] = opp[h] * policy.strategy[h * actions + a];
+        }
+        walkBoard(deal, node.children[a], own, childOpp, player, weight, actionValues[a]);
+        for (uint32_t h = 0; h < HandCount; ++h) {
+            out[h] += actionValues[a][h];
+        }
+    }
+}
+
+template <typename GameType>
+void FullTreeCFR<GameType>::walkPreflop(uint32_t id, const Range& opp, int player, const std::vector<Range>& slotValues, Range& out)
+{
+    const PublicNode& node = m_tree.node(id);
+    switch (node.kind) {
+    case PublicNode::Kind::Fold:
+        out.assign(HandCount, 0.0);
+        m_tree.foldValues(node, 0, opp, player, out);
+        return;
+    case PublicNode::Kind::Showdown:
+        throw std::logic_error("showdown before the board is dealt");
+    case PublicNode::Kind::Chance:
+        out = slotValues[node.firstDeal];
+        return;
+    case PublicNode::Kind::Action:
+        break;
+    }
+
+    const size_t actions = node.children.size();
+    Policy& policy = m_preflop[id];
+    std::vector<Range> actionValues(actions, Range(HandCount));
+    out.assign(HandCount, 0.0);
+    if (node.player == player) {
+        for (size_t a = 0; a < actions; ++a) {
+            walkPreflop(node.children[a], opp, player, slotValues, actionValues[a]);
+            for (uint32_t h = 0; h < HandCount; ++h) {
+                out[h] += policy.strategy[h * actions + a] * actionValues[a][h];
+            }
+        }
+        std::vector<uint32_t> hands(HandCount);
+        std::iota(hands.begin(), hands.end(), 0u);
+        updateRegrets(policy, actionValues, out, hands, 1.0);
+        return;
+    }
+
+    Range childOpp(HandCount);
+    for (size_t a = 0; a < actions; ++a) {
+        for (uint32_t h = 0; h < HandCount; ++h) {
+            childOpp[h] = opp[h] * policy.strategy[h * actions + a];
+        }
+        walkPreflop(node.children[a], childOpp, player, slotValues, actionValues[a]);
+        for (uint32_t h = 0; h < HandCount; ++h) {
+            out[h] += actionValues[a][h];
+        }
+    }
+}
+
+template <typename GameType>
+void FullTreeCFR<GameType>::updateRegrets(Policy& policy, const std::vector<Range>& actionValues, const Range& value,
+                                          std::span<const uint32_t> hands, double weight)
+{
+    // suit isomorphic hands share a node, so every update lands before any node regret matches
+    for (const uint32_t h : hands) {
+        for (size_t a = 0; a < actionValues.size(); ++a) {
+            policy.nodes[h]->updateRegretSum(static_cast<int>(a), static_cast<float>(actionValues[a][h] - value[h]),
+                                             static_cast<float>(weight));
+        }
+    }
+    for (const uint32_t h : hands) {
+        policy.nodes[h]->calcUpdatedStrategy();
+    }
+}
+
+} // namespace CFR
+
+#endif //FULLTREECFR_HPP
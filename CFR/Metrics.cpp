@@ -0,0 +1,195 @@
+#include "Metrics.hpp"
+
+#include <format>
+#include <fstream>
+#include <stdexcept>
+#include <unistd.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+
+namespace CFR {
+namespace {
+
+void appendMetric(std::string& out, const std::string& name, const std::string& help, const char* type, double value) {
+    out += std::format("# HELP cfr_{} {}\n# TYPE cfr_{} {}\ncfr_{} {}\n", name, help, name, type, name, value);
+}
+
+} // namespace
+
+std::shared_ptr<WorkerMetrics> MetricsRegistry::addWorker() {
+    std::lock_guard lock(m_mutex);
+    return m_workers.emplace_back(std::make_shared<WorkerMetrics>());
+}
+
+void MetricsRegistry::addSampled(const std::string& name, const std::string& help, Kind kind, std::function<double()> read) {
+    std::lock_guard lock(m_mutex);
+    m_sampled.push_back({name, help, kind, std::move(read)});
+}
+
+MetricsSnapshot MetricsRegistry::snapshot() const {
+    MetricsSnapshot snapshot;
+    snapshot.taken = std::chrono::steady_clock::now();
+    std::lock_guard lock(m_mutex);
+    snapshot.workerIterations.reserve(m_workers.size());
+    for (const auto& worker : m_workers) {
+        const uint64_t iterations = worker->iterations.load(std::memory_order_relaxed);
+        snapshot.iterations += iterations;
+        snapshot.workerIterations.push_back(iterations);
+        snapshot.nodesTouched += worker->nodesTouched.load(std::memory_order_relaxed);
+        snapshot.nodesCreated += worker->nodesCreated.load(std::memory_order_relaxed);
+        snapshot.regretUpdates += worker->regretUpdates.load(std::memory_order_relaxed);
+        snapshot.regretMagnitude += worker->regretMagnitude.load(std::memory_order_relaxed);
+    }
+    return snapshot;
+}
+
+std::string MetricsRegistry::prometheusText() const {
+    const MetricsSnapshot current = snapshot();
+    std::string out;
+
+    std::lock_guard lock(m_mutex);
+    appendMetric(out, "iterations_total", "Training iterations completed", "counter", static_cast<double>(current.iterations));
+    appendMetric(out, "nodes_touched_total", "Game tree nodes visited", "counter", static_cast<double>(current.nodesTouched));
+    appendMetric(out, "node_allocations_total", "Info set nodes allocated", "counter", static_cast<double>(current.nodesCreated));
+    appendMetric(out, "regret_updates_total", "Regret sum updates", "counter", static_cast<double>(current.regretUpdates));
+    appendMetric(out, "average_regret_magnitude", "Mean absolute instantaneous regret over all updates", "gauge",
+                 current.averageRegretMagnitude());
+
+    out += "# HELP cfr_worker_iterations_total Training iterations completed by each worker\n"
+           "# TYPE cfr_worker_iterations_total counter\n";
+    for (size_t i = 0; i < current.workerIterations.size(); ++i) {
+        out += std::format("cfr_worker_iterations_total{{worker=\"{}\"}} {}\n", i, current.workerIterations[i]);
+    }
+
+    for (const Sampled& sampled : m_sampled) {
+        appendMetric(out, sampled.name, sampled.help, sampled.kind == Kind::Counter ? "counter" : "gauge", sampled.read());
+    }
+    appendMetric(out, "resident_bytes", "Resident set size of the process", "gauge", static_cast<double>(residentBytes()));
+    return out;
+}
+
+uint64_t residentBytes() {
+    std::ifstream statm("/proc/self/statm");
+    uint64_t sizePages = 0;
+    uint64_t residentPages = 0;
+    if (!(statm >> sizePages >> residentPages)) {
+        return 0;
+    }
+    return residentPages * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+}
+
+MetricsFileWriter::MetricsFileWriter(std::shared_ptr<MetricsRegistry> registry, std::filesystem::path path, std::chrono::milliseconds interval)
+    : m_registry(std::move(registry)), m_path(std::move(path)), m_interval(interval) {
+    m_thread = std::thread([this] { run(); });
+}
+
+MetricsFileWriter::~MetricsFileWriter() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    m_thread.join();
+}
+
+void MetricsFileWriter::write() {
+    std::filesystem::path temporary = m_path;
+    temporary += ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::trunc);
+        out << m_registry->prometheusText();
+        if (!out) {
+            return;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, m_path, error);
+}
+
+void MetricsFileWriter::run() {
+    std::unique_lock lock(m_mutex);
+    while (!m_stop) {
+        m_cv.wait_for(lock, m_interval, [this] { return m_stop; });
+        lock.unlock();
+        write();
+        lock.lock();
+    }
+}
+
+MetricsHttpServer::MetricsHttpServer(std::shared_ptr<MetricsRegistry> registry, uint16_t port) : m_registry(std::move(registry)) {
+    m_socket = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (m_socket < 0) {
+        throw std::runtime_error("Failed to create metrics socket");
+    }
+    const int reuse = 1;
+    ::setsockopt(m_socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    socklen_t length = sizeof(address);
+    if (::bind(m_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || ::listen(m_socket, 8) < 0 ||
+        ::getsockname(m_socket, reinterpret_cast<sockaddr*>(&address), &length) < 0) {
+        ::close(m_socket);
+        throw std::runtime_error("Failed to bind metrics port " + std::to_string(port));
+    }
+    m_port = ntohs(address.sin_port);
+    m_thread = std::thread([this] { run(); });
+}
+
+MetricsHttpServer::~MetricsHttpServer() {
+    m_stop = true;
+    m_thread.join();
+    ::close(m_socket);
+}
+
+void MetricsHttpServer::run() {
+    pollfd listening{m_socket, POLLIN, 0};
+    while (!m_stop) {
+        // wake regularly to notice shutdown, scrapes are seconds apart so the latency does not matter
+        if (::poll(&listening, 1, 100) <= 0) {
+            continue;
+        }
+        const int client = ::accept(m_socket, nullptr, nullptr);
+        if (client >= 0) {
+            serve(client);
+            ::close(client);
+        }
+    }
+}
+
+void MetricsHttpServer::serve(int client) {
+    // one request per connection, only its first line matters
+    char request[1024];
+    pollfd readable{client, POLLIN, 0};
+    if (::poll(&readable, 1, 1000) <= 0) {
+        return;
+    }
+    const ssize_t received = ::recv(client, request, sizeof(request) - 1, 0);
+    if (received <= 0) {
+        return;
+    }
+    const std::string_view line(request, static_cast<size_t>(received));
+
+    std::string response;
+    if (line.starts_with("GET /metrics ") || line.starts_with("GET / ")) {
+        const std::string body = m_registry->prometheusText();
+        response = std::format("HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: {}\r\n"
+                               "Connection: close\r\n\r\n{}", body.size(), body);
+    } else {
+        response = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    }
+    for (size_t sent = 0; sent < response.size();) {
+        const ssize_t written = ::send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+        if (written <= 0) {
+            return;
+        }
+        sent += static_cast<size_t>(written);
+    }
+}
+
+} // namespace CFR
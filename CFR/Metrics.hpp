@@ -0,0 +1,135 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace CFR {
+
+/// @brief Counters published by one training thread
+/// @details Every counter has a single writer, which stores its running totals with relaxed stores, so publishing
+/// costs no locked instruction and readers on other threads see a recent value. Each block fills its own cache lines.
+struct alignas(64) WorkerMetrics {
+    std::atomic<uint64_t> iterations{0};
+    std::atomic<uint64_t> nodesTouched{0};
+    /// @brief Nodes allocated for info sets seen for the first time
+    std::atomic<uint64_t> nodesCreated{0};
+    std::atomic<uint64_t> regretUpdates{0};
+    /// @brief Sum of |regret| over every regret update
+    std::atomic<double> regretMagnitude{0};
+};
+
+/// @brief Totals over every worker at one point in time
+struct MetricsSnapshot {
+    std::chrono::steady_clock::time_point taken{};
+    uint64_t iterations = 0;
+    uint64_t nodesTouched = 0;
+    uint64_t nodesCreated = 0;
+    uint64_t regretUpdates = 0;
+    double regretMagnitude = 0;
+    std::vector<uint64_t> workerIterations;
+
+    [[nodiscard]] double averageRegretMagnitude() const {
+        return regretUpdates > 0 ? regretMagnitude / static_cast<double>(regretUpdates) : 0.0;
+    }
+};
+
+/// @brief Collects worker counters and sampled values such as storage statistics, aggregated only when read
+class MetricsRegistry {
+public:
+    enum class Kind { Counter, Gauge };
+
+    /// @brief Counter block for a new training thread, kept alive by the registry after the thread is gone
+    std::shared_ptr<WorkerMetrics> addWorker();
+
+    /// @brief Value read from its source each time the metrics are exported
+    /// @param name Prometheus metric name, prefixed with cfr_
+    void addSampled(const std::string& name, const std::string& help, Kind kind, std::function<double()> read);
+
+    /// @brief Sum the worker counters
+    [[nodiscard]] MetricsSnapshot snapshot() const;
+
+    /// @brief Every metric in the Prometheus text exposition format
+    /// @details Training progress is exported as monotonic counters only, rates are left to Prometheus' rate(). Exports
+    /// keep no state, so a file writer, an HTTP scrape and any number of scrapers don't disturb each other.
+    [[nodiscard]] std::string prometheusText() const;
+
+private:
+    struct Sampled {
+        std::string name;
+        std::string help;
+        Kind kind;
+        std::function<double()> read;
+    };
+
+    mutable std::mutex m_mutex;
+    std::vector<std::shared_ptr<WorkerMetrics>> m_workers;
+    std::vector<Sampled> m_sampled;
+};
+
+/// @brief Resident set size of this process, 0 where it cannot be read
+[[nodiscard]] uint64_t residentBytes();
+
+/// @brief Rewrites a file with the registry's Prometheus text at a fixed interval, for a node exporter textfile collector
+class MetricsFileWriter {
+public:
+    MetricsFileWriter(std::shared_ptr<MetricsRegistry> registry, std::filesystem::path path, std::chrono::milliseconds interval);
+
+    /// @brief Writes a final sample and joins the thread
+    ~MetricsFileWriter();
+
+    MetricsFileWriter(const MetricsFileWriter&) = delete;
+    MetricsFileWriter& operator=(const MetricsFileWriter&) = delete;
+
+    /// @brief Write the file now, through a temporary renamed into place so readers never see a partial file
+    void write();
+
+private:
+    void run();
+
+    std::shared_ptr<MetricsRegistry> m_registry;
+    std::filesystem::path m_path;
+    std::chrono::milliseconds m_interval;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_stop = false;
+    std::thread m_thread;
+};
+
+/// @brief Serves GET /metrics on a loopback port for Prometheus to scrape
+class MetricsHttpServer {
+public:
+    /// @param port Port on 127.0.0.1, 0 picks a free one
+    /// @throws std::runtime_error if the port cannot be bound
+    MetricsHttpServer(std::shared_ptr<MetricsRegistry> registry, uint16_t port);
+    ~MetricsHttpServer();
+
+    MetricsHttpServer(const MetricsHttpServer&) = delete;
+    MetricsHttpServer& operator=(const MetricsHttpServer&) = delete;
+
+    /// @brief Port actually bound
+    [[nodiscard]] uint16_t port() const { return m_port; }
+
+private:
+    void run();
+    void serve(int client);
+
+    std::shared_ptr<MetricsRegistry> m_registry;
+    int m_socket = -1;
+    uint16_t m_port = 0;
+    std::atomic<bool> m_stop{false};
+    std::thread m_thread;
+};
+
+} // namespace CFR
+
+#endif //METRICS_HPP
@@ -4,49 +4,219 @@
 
 #ifndef MULTITHREADEDTRAINER_HPP
 #define MULTITHREADEDTRAINER_HPP
+#include <algorithm>
+#include <barrier>
 #include <condition_variable>
+#include <filesystem>
+#include <future>
 #include <memory>
 #include <random>
 #include <iostream>
-#include <queue>
+#include <latch>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <typeinfo>
+#include <vector>
 
+#include "Checkpoint.hpp"
+#include "Metrics.hpp"
 #include "RegretMinimizer.hpp"
+#include "ThreadTopology.hpp"
+#include "WorkStealingScheduler.hpp"
 #include "../Storage/LRUList.hpp"
 #include "../Storage/ShardedLRUCache.hpp"
 template<typename K, typename V> using MyMap = std::unordered_map<K, V>;
 
 namespace CFR {
-template<typename GameType, typename StorageType = ShardedLRUCache<MyMap,LRUList>>
+
+/// @brief Throughput and load balance of one training run
+struct TrainingRunStats {
+    uint64_t requested = 0;
+    uint64_t iterations = 0;
+    bool cancelled = false;
+    double wallSeconds = 0;
+    double iterationsPerSecond = 0;
+    /// @brief Summed time workers sat idle between finishing their last grain and the end of the run
+    double tailIdleSeconds = 0;
+    double maxTailIdleSeconds = 0;
+    uint64_t steals = 0;
+};
+
+/// @brief Shared state of one training run, owned jointly by the trainer and every handle to the run
+struct TrainingRunState {
+    explicit TrainingRunState(uint64_t requestedIterations)
+        : requested(requestedIterations), future(promise.get_future().share()) {}
+
+    const uint64_t requested;
+    std::atomic<uint64_t> completed{0};
+    std::atomic<bool> cancelled{false};
+    std::chrono::steady_clock::time_point start;
+    std::promise<TrainingRunStats> promise;
+    std::shared_future<TrainingRunStats> future;
+};
+
+/// @brief Handle to a run started with MultiThreadedTrainer::startRun
+class RunHandle {
+public:
+    explicit RunHandle(std::shared_ptr<TrainingRunState> state) : m_state(std::move(state)) {}
+
+    /// @brief Block until every worker has finished the run
+    TrainingRunStats wait() const { return m_state->future.get(); }
+
+    /// @return true if the run finished within the timeout
+    template<typename Rep, typename Period>
+    bool waitFor(const std::chrono::duration<Rep, Period>& timeout) const {
+        return m_state->future.wait_for(timeout) == std::future_status::ready;
+    }
+
+    /// @brief Stop handing out iterations, workers finish the grain they are on and the run completes early
+    void cancel() const { m_state->cancelled = true; }
+
+    [[nodiscard]] bool done() const { return waitFor(std::chrono::seconds(0)); }
+    [[nodiscard]] uint64_t completed() const { return m_state->completed.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t requested() const { return m_state->requested; }
+    [[nodiscard]] std::shared_future<TrainingRunStats> future() const { return m_state->future; }
+
+private:
+    std::shared_ptr<TrainingRunState> m_state;
+};
+
+/// @brief Thread count, placement and seeding of a MultiThreadedTrainer
+struct TrainerOptions {
+    uint32_t numThreads = std::thread::hardware_concurrency();
+    /// @brief Pin workers to CPUs, whole physical cores first and SMT siblings last, grouped by NUMA node
+    bool pinThreads = false;
+    /// @brief Every worker seed is derived from this, a random master is drawn when unset
+    std::optional<uint64_t> masterSeed;
+    /// @brief Deals each worker walks together through RegretMinimizer::TrainBatched, 0 trains one deal at a time
+    uint32_t batchSize = 0;
+    /// @brief Deals each worker keeps in flight through RegretMinimizer::TrainAsync, 0 leaves async training off
+    uint32_t asyncInFlight = 0;
+    /// @brief Threads in the pool all workers share for async node reads
+    uint32_t ioThreads = 4;
+    /// @brief Directory for periodic checkpoints taken while a run is active, empty turns them off
+    std::filesystem::path checkpointDir;
+    std::chrono::seconds checkpointInterval{600};
+    /// @brief Published checkpoints kept in checkpointDir, older ones are deleted
+    uint32_t checkpointsKept = 2;
+    /// @brief Serve Prometheus metrics on this loopback port, 0 picks a free port
+    std::optional<uint16_t> metricsPort;
+    /// @brief Rewrite this file with Prometheus metrics every metricsInterval, empty turns it off
+    std::filesystem::path metricsFile;
+    std::chrono::milliseconds metricsInterval{10000};
+    /// @brief Record every worker's storage accesses to worker-<i>.trace in this directory, empty turns tracing off
+    std::filesystem::path traceDir;
+};
+
+/// @tparam Sampling traversal policy every worker's RegretMinimizer trains with
+template<typename GameType, typename StorageType = ShardedLRUCache<MyMap,LRUList>, typename Sampling = ExternalSampling>
 class MultiThreadedTrainer {
 public:
     explicit MultiThreadedTrainer(const uint32_t numThreads = std::thread::hardware_concurrency())
+        : MultiThreadedTrainer(optionsWithThreads(numThreads)) {}
+
+    explicit MultiThreadedTrainer(const TrainerOptions& options)
     : m_storage(std::make_shared<StorageType>()),
-        m_numThreads(numThreads),
-        m_totalIterationsCompleted(0),
+        m_numThreads(options.numThreads),
+        m_batchSize(options.batchSize),
+        m_asyncInFlight(options.asyncInFlight),
+        m_ioPool(options.asyncInFlight > 0 ? std::make_shared<IoThreadPool>(options.ioThreads) : nullptr),
+        m_masterSeed(options.masterSeed.value_or((static_cast<uint64_t>(std::random_device()()) << 32) | std::random_device()())),
+        m_scheduler(options.numThreads),
+        m_runBarrier(options.numThreads, RunCompletion{this}),
+        m_workerFinish(options.numThreads),
+        m_pinnedCpus(options.numThreads, -1),
+        m_checkpointsKept(options.checkpointsKept),
         m_shouldStop(false),
         m_updateInterval(std::chrono::milliseconds(100)) // UI update every 100ms
        {
+        registerMetrics();
 
-        m_threads.reserve(numThreads);
-        m_regretMinimizers.reserve(numThreads);
-        for (uint32_t i = 0; i < numThreads; ++i) {
-        m_regretMinimizers.emplace_back(
-            std::make_unique<RegretMinimizer<GameType, StorageType>>(
-                std::random_device()(), m_storage));
-        m_threads.emplace_back(&MultiThreadedTrainer::workerLoop, this, i);
-    }
+        std::vector<uint32_t> placement;
+        if (options.pinThreads) {
+            placement = CpuTopology::detect().placementOrder();
+        }
+
+        // Each worker pins itself and then builds its own minimizer, so the game copy, RNG and node allocations it
+        // makes come from its thread's malloc arena and are first touched on its own NUMA node
+        if (!options.traceDir.empty()) {
+            std::filesystem::create_directories(options.traceDir);
+        }
+
+        std::latch ready(m_numThreads);
+        std::vector<std::exception_ptr> errors(m_numThreads);
+        m_regretMinimizers.resize(m_numThreads);
+        m_threads.reserve(m_numThreads);
+        for (uint32_t i = 0; i < m_numThreads; ++i) {
+            const int cpu = placement.empty() ? -1 : static_cast<int>(placement[i % placement.size()]);
+            const std::filesystem::path tracePath =
+                options.traceDir.empty() ? std::filesystem::path{} : options.traceDir / ("worker-" + std::to_string(i) + ".trace");
+            m_threads.emplace_back([this, i, cpu, tracePath, &ready, &errors] {
+                try {
+                    if (cpu >= 0 && pinCurrentThread(static_cast<uint32_t>(cpu))) {
+                        m_pinnedCpus[i] = cpu;
+                    }
+                    m_regretMinimizers[i] = std::make_unique<RegretMinimizer<GameType, StorageType, Sampling>>(
+                        static_cast<uint32_t>(threadSeed(m_masterSeed, i)), m_storage);
+                    m_regretMinimizers[i]->setIoPool(m_ioPool);
+                    m_regretMinimizers[i]->setMetrics(m_workerMetrics[i]);
+                    if (!tracePath.empty()) {
+                        m_regretMinimizers[i]->setTrace(std::make_shared<AccessTraceWriter>(tracePath));
+                    }
+                } catch (...) {
+                    errors[i] = std::current_exception();
+                }
+                // ready and errors live on the constructor's stack, neither may be touched after counting down
+                const bool constructed = m_regretMinimizers[i] != nullptr;
+                ready.count_down();
+                if (constructed) {
+                    workerLoop(i);
+                }
+            });
+        }
+        ready.wait();
+
+        for (const auto& error : errors) {
+            if (error) {
+                stop();
+                std::rethrow_exception(error);
+            }
+        }
+
+        if (options.metricsPort) {
+            m_metricsServer = std::make_unique<MetricsHttpServer>(m_metrics, *options.metricsPort);
+        }
+        if (!options.metricsFile.empty()) {
+            m_metricsWriter = std::make_unique<MetricsFileWriter>(m_metrics, options.metricsFile, options.metricsInterval);
+        }
+
+        if (!options.checkpointDir.empty()) {
+            m_checkpointThread = std::thread([this, root = options.checkpointDir, interval = options.checkpointInterval] {
+                checkpointLoop(root, interval);
+            });
+        }
     }
 
     ~MultiThreadedTrainer() {
         stop();
     }
 
+    /// @brief Shut the worker threads down, a run in progress completes as cancelled
     void stop() {
         {
             std::lock_guard<std::mutex> lock(m_workMutex);
             m_shouldStop = true;
         }
         m_workCondition.notify_all();
+        {
+            // taken so the periodic checkpointer cannot miss the wakeup between its check and its wait
+            std::lock_guard<std::mutex> lock(m_checkpointLoopMutex);
+        }
+        m_checkpointCondition.notify_all();
+        if (m_checkpointThread.joinable()) {
+            m_checkpointThread.join();
+        }
 
         for (auto& thread : m_threads) {
             if (thread.joinable()) {
@@ -55,44 +225,144 @@ public:
         }
     }
 
-    // Train with callback for UI updates
-    void TrainWithCallback(uint32_t totalIterations, std::function<void(uint32_t)> progressCallback = nullptr) {
-        const uint32_t batchSize = std::max(1000u, totalIterations / (m_numThreads * 20)); // Larger batches
-        const uint32_t iterationsPerThread = totalIterations / m_numThreads;
-
-        std::cout << "Starting training with " << m_numThreads << " threads, "
-                  << "batch size: " << batchSize << ", total iterations: " << totalIterations << "\n";
+    /// @brief Start a run of exactly the given number of iterations on the existing worker threads
+    /// @throws std::logic_error if a run is still in progress or the trainer was stopped
+    RunHandle startRun(uint64_t iterations) {
+        auto run = std::make_shared<TrainingRunState>(iterations);
+        {
+            std::lock_guard<std::mutex> lock(m_workMutex);
+            if (m_shouldStop) {
+                throw std::logic_error("Trainer has been stopped");
+            }
+            if (m_activeRun) {
+                throw std::logic_error("A training run is already in progress");
+            }
+            // Hand every worker its share of the run, the scheduler rebalances from there
+            m_scheduler.reset(iterations);
+            run->start = std::chrono::steady_clock::now();
+            m_activeRun = run;
+            m_lastRun = run;
+            ++m_runGeneration;
+        }
+        m_workCondition.notify_all();
+        return RunHandle(run);
+    }
 
-        m_totalIterationsCompleted = 0;
+    /// @brief Write a checkpoint of the nodes, iteration count, worker engines and parameters under root
+    /// @details Workers are held between grains only while storage and engines are captured, which pins the nodes
+    /// without copying them. The nodes are then serialized, written and published on a background thread while
+    /// training carries on, a node is copied early only when a worker is about to change it. One write is in flight
+    /// at a time, a second checkpoint waits for the previous write first.
+    /// @return Resolves to the published checkpoint directory, or rethrows what went wrong writing it
+    std::shared_future<std::filesystem::path> checkpoint(const std::filesystem::path& root) {
+        std::lock_guard<std::mutex> checkpointLock(m_checkpointMutex);
+        if (m_checkpointWrite.valid()) {
+            m_checkpointWrite.wait();
+        }
 
-        // Queue work for each thread
+        CheckpointManifest manifest;
+        std::filesystem::path staging;
+        std::function<void()> writeNodes;
+        std::chrono::steady_clock::time_point pauseStart;
         {
-            std::lock_guard<std::mutex> lock(m_workMutex);
+            TrainingGate::Pause pause(m_gate);
+            pauseStart = std::chrono::steady_clock::now();
+            manifest = captureManifest();
+            staging = beginCheckpoint(root, manifest.iterations);
+            writeNodes = m_storage->captureSnapshot(staging);
+        }
+        m_lastCheckpointPause = std::chrono::steady_clock::now() - pauseStart;
+
+        m_checkpointWrite = std::async(std::launch::async,
+            // the storage is held so the write can finish even if the trainer is destroyed first
+            [staging, manifest = std::move(manifest), writeNodes = std::move(writeNodes), keep = m_checkpointsKept,
+             storage = m_storage] {
+                writeNodes();
+                manifest.write(staging / CheckpointManifest::FileName);
+                return commitCheckpoint(staging, keep);
+            }).share();
+        return m_checkpointWrite;
+    }
+
+    /// @brief Restore the state of a checkpoint, root may be a checkpoint directory or a directory holding LATEST
+    /// @details Workers beyond the number the checkpoint was taken with are seeded from the master seed and iteration
+    /// count. Start a run of the returned runRemaining iterations to finish the interrupted run.
+    /// @throws std::logic_error if a run is in progress, std::invalid_argument if the checkpoint is for another game
+    CheckpointManifest resume(const std::filesystem::path& root) {
+        std::optional<std::filesystem::path> dir = std::filesystem::exists(root / CheckpointManifest::FileName)
+            ? std::optional<std::filesystem::path>(root) : latestCheckpoint(root);
+        if (!dir) {
+            throw std::runtime_error("No checkpoint found in " + root.string());
+        }
+        CheckpointManifest manifest = CheckpointManifest::read(*dir / CheckpointManifest::FileName);
+        if (manifest.game != typeid(GameType).name()) {
+            throw std::invalid_argument("Checkpoint " + dir->string() + " was taken for a different game");
+        }
+
+        // A checkpoint still being written reads the storage about to be replaced. Taken before m_workMutex as in checkpoint()
+        std::lock_guard<std::mutex> checkpointLock(m_checkpointMutex);
+        if (m_checkpointWrite.valid()) {
+            m_checkpointWrite.wait();
+        }
+        // Held throughout so no run can start on half restored state, idle workers never take this lock
+        std::lock_guard<std::mutex> lock(m_workMutex);
+        if (m_activeRun) {
+            throw std::logic_error("Cannot resume while a training run is in progress");
+        }
+        m_storage->restoreSnapshot(*dir);
+        m_masterSeed = manifest.masterSeed;
+        m_iterationsTrained = manifest.iterations;
         for (uint32_t i = 0; i < m_numThreads; ++i) {
-                uint32_t remaining = iterationsPerThread;
-                while (remaining > 0) {
-                    uint32_t batch = std::min(batchSize, remaining);
-                    m_workQueue.push(batch);
-                    remaining -= batch;
+            typename GameType::Engine engine(threadSeed(m_masterSeed + manifest.iterations, i));
+            if (i < manifest.engines.size()) {
+                std::istringstream state(manifest.engines[i]);
+                if (!(state >> engine)) {
+                    throw std::runtime_error("Corrupt engine state in checkpoint " + dir->string());
                 }
+            }
+            m_regretMinimizers[i]->setEngine(engine);
         }
-        }
-        m_workCondition.notify_all();
+        return manifest;
+    }
+
+    /// @brief Worker counters and storage statistics, aggregated when read
+    const std::shared_ptr<MetricsRegistry>& getMetrics() const { return m_metrics; }
+
+    /// @brief Port the metrics endpoint listens on, 0 when it is not enabled
+    uint16_t getMetricsPort() const { return m_metricsServer ? m_metricsServer->port() : 0; }
+
+    /// @brief Storage shared by every worker, touch it only while no run is active
+    const std::shared_ptr<StorageType>& getStorage() const { return m_storage; }
+
+    /// @brief Iterations trained over every run, including those restored from a checkpoint
+    uint64_t getTotalIterations() const { return m_iterationsTrained.load(std::memory_order_relaxed); }
+
+    /// @brief How long every worker was held for the last checkpoint
+    /// @details Counted from the moment the grains in flight had finished, waiting for those is bounded by the grain size
+    /// rather than by the number of nodes
+    std::chrono::nanoseconds getLastCheckpointPause() const {
+        std::lock_guard<std::mutex> lock(m_checkpointMutex);
+        return m_lastCheckpointPause;
+    }
+
+    // Train with callback for UI updates
+    void TrainWithCallback(uint32_t totalIterations, std::function<void(uint32_t)> progressCallback = nullptr) {
+        std::cout << "Starting training with " << m_numThreads << " threads, "
+                  << "total iterations: " << totalIterations << "\n";
 
-        // Monitor progress and call callback
-        auto lastUpdate = std::chrono::steady_clock::now();
-        while (m_totalIterationsCompleted < totalIterations && !m_shouldStop) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        const RunHandle run = startRun(totalIterations);
 
-            auto now = std::chrono::steady_clock::now();
-            if (progressCallback && (now - lastUpdate) >= m_updateInterval) {
-                progressCallback(m_totalIterationsCompleted.load());
-                lastUpdate = now;
+        // Wake for progress updates, return as soon as the run completes
+        while (!run.waitFor(m_updateInterval)) {
+            if (progressCallback) {
+                progressCallback(static_cast<uint32_t>(run.completed()));
             }
         }
+        run.wait();
+        printRunStats();
 
         if (progressCallback) {
-            progressCallback(totalIterations);
+            progressCallback(static_cast<uint32_t>(run.completed()));
         }
         }
 
@@ -109,57 +379,240 @@ public:
         {
             res.push_back(node->getRegretSum());
             res.push_back(node->getStrategy());
-            node->calcAverageStrategy();
-            res.push_back(node->getAverageStrategy());
+            res.push_back(node->averageStrategyOf());
         }
         return res;
     }
 
+    /// @brief Iterations finished so far in the current or most recent run
     uint32_t getCompletedIterations() const {
-        return m_totalIterationsCompleted.load();
+        std::lock_guard<std::mutex> lock(m_workMutex);
+        return m_lastRun ? static_cast<uint32_t>(m_lastRun->completed.load()) : 0;
     }
 
+    /// @brief Master seed the worker seeds were derived from, pass it back in TrainerOptions to reproduce the seeding
+    uint64_t getMasterSeed() const { return m_masterSeed; }
 
-  /// @brief Set cancellation flag to interrupt training
-  void setCancelled(bool cancelled) { m_shouldStop = cancelled; }
+    /// @brief CPU each worker is pinned to, -1 for workers that were not pinned
+    const std::vector<int>& getPinnedCpus() const { return m_pinnedCpus; }
+
+    /// @brief Phase cycles and storage latencies summed over every worker, empty unless built with CFR_ENABLE_PROFILING
+    /// @details Safe to call while a run is active, e.g. from TrainWithCallback's progress callback
+    PhaseProfile getProfile() const {
+        PhaseProfile profile;
+        for (const auto& minimizer : m_regretMinimizers) {
+            profile += minimizer->getProfile();
+        }
+        return profile;
+    }
+
+    /// @brief Throughput, tail idle time and steals of the last completed run
+    TrainingRunStats getLastRunStats() const {
+        std::lock_guard<std::mutex> lock(m_workMutex);
+        return m_lastRunStats;
+    }
+
+  /// @brief Cancel the run in progress, if any; later runs are unaffected
+  void setCancelled(bool cancelled) {
+      std::lock_guard<std::mutex> lock(m_workMutex);
+      if (cancelled && m_activeRun) {
+          m_activeRun->cancelled = true;
+      }
+  }
 
 private:
+    static TrainerOptions optionsWithThreads(uint32_t numThreads) {
+        TrainerOptions options;
+        options.numThreads = numThreads;
+        return options;
+    }
+
+    /// @brief Barrier completion step, runs once per run after every worker has drained its work
+    struct RunCompletion {
+        MultiThreadedTrainer* trainer;
+        void operator()() noexcept { trainer->finishRun(); }
+    };
+
     void workerLoop(uint32_t threadId) {
+        uint64_t seenGeneration = 0;
         while (true) {
-            uint32_t workAmount = 0;
-
-            // Wait for work
+            std::shared_ptr<TrainingRunState> run;
+            // Wait for a run to start
             {
                 std::unique_lock<std::mutex> lock(m_workMutex);
-                m_workCondition.wait(lock, [this] { return m_shouldStop || !m_workQueue.empty(); });
+                m_workCondition.wait(lock, [&] { return m_shouldStop || m_runGeneration != seenGeneration; });
 
-                if (m_shouldStop) break;
+                // A run that was already started is still joined so its barrier completes
+                if (m_runGeneration == seenGeneration) break;
+                seenGeneration = m_runGeneration;
+                run = m_activeRun;
+            }
 
-                if (!m_workQueue.empty()) {
-                    workAmount = m_workQueue.front();
-                    m_workQueue.pop();
+            while (!m_shouldStop && !run->cancelled.load(std::memory_order_relaxed)) {
+                // Checkpoints hold workers here, between grains
+                m_gate.enter();
+                const WorkStealingScheduler::Range range = m_scheduler.next(threadId);
+                if (range.size() == 0) {
+                    m_gate.leave();
+                    break;
                 }
+                // Do the actual training work
+                if (m_asyncInFlight > 0) {
+                    m_regretMinimizers[threadId]->TrainAsync(static_cast<uint32_t>(range.size()), m_asyncInFlight);
+                } else if (m_batchSize > 0) {
+                    m_regretMinimizers[threadId]->TrainBatched(static_cast<uint32_t>(range.size()), m_batchSize);
+                } else {
+                    m_regretMinimizers[threadId]->Train(static_cast<uint32_t>(range.size()));
+                }
+                run->completed.fetch_add(range.size(), std::memory_order_relaxed);
+                m_iterationsTrained.fetch_add(range.size(), std::memory_order_relaxed);
+                m_gate.leave();
             }
 
-            if (workAmount > 0) {
-                // Do the actual training work
-                m_regretMinimizers[threadId]->Train(workAmount);
-                m_totalIterationsCompleted.fetch_add(workAmount);
+            m_workerFinish[threadId] = std::chrono::steady_clock::now();
+            m_runBarrier.arrive_and_wait();
+        }
+    }
+
+    void finishRun() noexcept {
+        std::shared_ptr<TrainingRunState> run;
+        TrainingRunStats stats;
+        {
+            std::lock_guard<std::mutex> lock(m_workMutex);
+            run = std::move(m_activeRun);
+
+            const auto runEnd = *std::max_element(m_workerFinish.begin(), m_workerFinish.end());
+            stats.requested = run->requested;
+            stats.iterations = run->completed.load();
+            stats.cancelled = stats.iterations < stats.requested;
+            stats.wallSeconds = std::chrono::duration<double>(runEnd - run->start).count();
+            stats.iterationsPerSecond = stats.wallSeconds > 0 ? static_cast<double>(stats.iterations) / stats.wallSeconds : 0;
+            for (const auto& finish : m_workerFinish) {
+                const double idle = std::chrono::duration<double>(runEnd - finish).count();
+                stats.tailIdleSeconds += idle;
+                stats.maxTailIdleSeconds = std::max(stats.maxTailIdleSeconds, idle);
+            }
+            stats.steals = m_scheduler.steals();
+            m_lastRunStats = stats;
+        }
+        // Published after the run is cleared so a waiter can start the next run straight away
+        run->promise.set_value(stats);
+    }
+
+    /// @brief Give each worker a counter block and sample whatever statistics the storage type offers
+    void registerMetrics() {
+        for (uint32_t i = 0; i < m_numThreads; ++i) {
+            m_workerMetrics.push_back(m_metrics->addWorker());
+        }
+        using Kind = MetricsRegistry::Kind;
+        const std::shared_ptr<StorageType> storage = m_storage;
+        if constexpr (requires(const StorageType& s) { s.getStats(); }) {
+            m_metrics->addSampled("storage_hits_total", "Node cache hits", Kind::Counter, [storage] { return static_cast<double>(storage->getStats().cache.hits); });
+            m_metrics->addSampled("storage_misses_total", "Node cache misses", Kind::Counter, [storage] { return static_cast<double>(storage->getStats().cache.misses); });
+            m_metrics->addSampled("storage_evictions_total", "Nodes evicted from the cache", Kind::Counter, [storage] { return static_cast<double>(storage->getStats().cache.evictions); });
+            m_metrics->addSampled("storage_cache_bytes", "Bytes held by the node cache", Kind::Gauge, [storage] { return static_cast<double>(storage->getStats().memory.usedBytes); });
+            m_metrics->addSampled("storage_disk_read_bytes_total", "Bytes read from disk", Kind::Counter, [storage] { return static_cast<double>(storage->getStats().disk.bytesRead); });
+            m_metrics->addSampled("storage_nodes", "Nodes in storage", Kind::Gauge, [storage] { return static_cast<double>(storage->getStats().nodes); });
+        } else if constexpr (requires(const StorageType& s) { s.getCounters(); }) {
+            m_metrics->addSampled("storage_hits_total", "Node cache hits", Kind::Counter, [storage] { return static_cast<double>(storage->getCounters().hits); });
+            m_metrics->addSampled("storage_misses_total", "Node cache misses", Kind::Counter, [storage] { return static_cast<double>(storage->getCounters().misses); });
+            m_metrics->addSampled("storage_evictions_total", "Nodes evicted from the cache", Kind::Counter, [storage] { return static_cast<double>(storage->getCounters().evictions); });
+            m_metrics->addSampled("storage_nodes", "Nodes in storage", Kind::Gauge, [storage] { return static_cast<double>(storage->size()); });
+        }
+        // plain storages are not safe to read while workers write to them, they only report the worker counters
+    }
+
+    /// @brief Trainer state for a checkpoint, called with workers held at the gate
+    CheckpointManifest captureManifest() {
+        CheckpointManifest manifest;
+        manifest.game = typeid(GameType).name();
+        manifest.masterSeed = m_masterSeed;
+        manifest.iterations = m_iterationsTrained.load(std::memory_order_relaxed);
+        manifest.numThreads = m_numThreads;
+        manifest.batchSize = m_batchSize;
+        manifest.asyncInFlight = m_asyncInFlight;
+        {
+            std::lock_guard<std::mutex> lock(m_workMutex);
+            if (m_activeRun && !m_activeRun->cancelled) {
+                manifest.runRemaining = m_activeRun->requested - m_activeRun->completed.load(std::memory_order_relaxed);
             }
         }
+        for (const auto& minimizer : m_regretMinimizers) {
+            std::ostringstream state;
+            state << minimizer->getEngine();
+            manifest.engines.push_back(state.str());
+        }
+        return manifest;
+    }
+
+    void checkpointLoop(const std::filesystem::path& root, std::chrono::seconds interval) {
+        std::unique_lock<std::mutex> lock(m_checkpointLoopMutex);
+        while (!m_checkpointCondition.wait_for(lock, interval, [this] { return m_shouldStop.load(); })) {
+            {
+                std::lock_guard<std::mutex> workLock(m_workMutex);
+                if (!m_activeRun) {
+                    continue;
+                }
+            }
+            lock.unlock();
+            try {
+                checkpoint(root).get();
+            } catch (const std::exception& e) {
+                std::cerr << "Checkpoint failed: " << e.what() << "\n";
+            }
+            lock.lock();
+        }
+    }
+
+    void printRunStats() const {
+        const TrainingRunStats stats = getLastRunStats();
+        std::cout << "Trained " << stats.iterations << " iterations in " << stats.wallSeconds << "s ("
+                  << stats.iterationsPerSecond << " it/s), tail idle " << stats.tailIdleSeconds * 1000.0
+                  << "ms total / " << stats.maxTailIdleSeconds * 1000.0 << "ms max, " << stats.steals << " steals\n";
+        if constexpr (PhaseProfiler::Enabled) {
+            std::cout << getProfile().report();
+        }
     }
 
     std::shared_ptr<StorageType> m_storage;
     std::vector<std::thread> m_threads;
-    std::vector<std::unique_ptr<RegretMinimizer<GameType, StorageType>>> m_regretMinimizers;
+    std::vector<std::unique_ptr<RegretMinimizer<GameType, StorageType, Sampling>>> m_regretMinimizers;
     uint32_t m_numThreads;
+    uint32_t m_batchSize;
+    uint32_t m_asyncInFlight;
+    std::shared_ptr<IoThreadPool> m_ioPool;
+    uint64_t m_masterSeed;
 
-    // Work queue management
-    std::queue<uint32_t> m_workQueue;
-    std::mutex m_workMutex;
+    // Work scheduling
+    WorkStealingScheduler m_scheduler;
+    std::barrier<RunCompletion> m_runBarrier;
+    mutable std::mutex m_workMutex;
     std::condition_variable m_workCondition;
+    uint64_t m_runGeneration = 0;
+    std::shared_ptr<TrainingRunState> m_activeRun;
+    std::shared_ptr<TrainingRunState> m_lastRun;
+    std::vector<std::chrono::steady_clock::time_point> m_workerFinish;
+    TrainingRunStats m_lastRunStats;
+    std::vector<int> m_pinnedCpus;
+    std::atomic<uint64_t> m_iterationsTrained{0};
+
+    // Telemetry
+    std::shared_ptr<MetricsRegistry> m_metrics = std::make_shared<MetricsRegistry>();
+    std::vector<std::shared_ptr<WorkerMetrics>> m_workerMetrics;
+    std::unique_ptr<MetricsHttpServer> m_metricsServer;
+    std::unique_ptr<MetricsFileWriter> m_metricsWriter;
+
+    // Checkpointing
+    TrainingGate m_gate;
+    uint32_t m_checkpointsKept;
+    mutable std::mutex m_checkpointMutex;
+    std::shared_future<std::filesystem::path> m_checkpointWrite;
+    std::chrono::nanoseconds m_lastCheckpointPause{0};
+    std::mutex m_checkpointLoopMutex;
+    std::condition_variable m_checkpointCondition;
+    std::thread m_checkpointThread;
+
     std::atomic<bool> m_shouldStop;
-    std::atomic<uint32_t> m_totalIterationsCompleted;
 
     // UI update timing
     std::chrono::milliseconds m_updateInterval;
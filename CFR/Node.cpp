@@ -2,15 +2,48 @@
 
 #include "Node.hpp"
 
+#include <utility>
+
 namespace CFR {
 
-    Node::Node(uint8_t actionNum) : actionNum(actionNum) {
-        for (int i=0; i<actionNum; ++i) {
-            strategy.push_back(1.F / static_cast<float>(actionNum));
-            regretSum.push_back(0.F);
-            strategySum.push_back(0.F);
-            averageStrategy.push_back(0.F);
-        }
+    // sized up front, one exact allocation per vector
+    Node::Node(uint8_t actionNum)
+        : regretSum(actionNum, 0.F),
+          strategy(actionNum, 1.F / static_cast<float>(actionNum)),
+          strategySum(actionNum, 0.F),
+          averageStrategy(actionNum, 0.F),
+          actionNum(actionNum) {}
+
+    Node::Node(const Node& other)
+        : regretSum(other.regretSum),
+          strategy(other.strategy),
+          strategySum(other.strategySum),
+          averageStrategy(other.averageStrategy),
+          actionNum(other.actionNum) {}
+
+    Node::Node(Node&& other) noexcept
+        : regretSum(std::move(other.regretSum)),
+          strategy(std::move(other.strategy)),
+          strategySum(std::move(other.strategySum)),
+          averageStrategy(std::move(other.averageStrategy)),
+          actionNum(other.actionNum) {}
+
+    Node& Node::operator=(const Node& other) {
+        regretSum = other.regretSum;
+        strategy = other.strategy;
+        strategySum = other.strategySum;
+        averageStrategy = other.averageStrategy;
+        actionNum = other.actionNum;
+        return *this;
+    }
+
+    Node& Node::operator=(Node&& other) noexcept {
+        regretSum = std::move(other.regretSum);
+        strategy = std::move(other.strategy);
+        strategySum = std::move(other.strategySum);
+        averageStrategy = std::move(other.averageStrategy);
+        actionNum = other.actionNum;
+        return *this;
     }
 
     void Node::calcUpdatedStrategy() {
@@ -42,6 +75,20 @@ namespace CFR {
         }
     }
 
+    std::vector<float> Node::averageStrategyOf() const {
+        std::vector<float> average(actionNum, 1.f / static_cast<float>(actionNum));
+        float normalizingSum = 0;
+        for (int a = 0; a < actionNum; a++) {
+            normalizingSum += strategySum[a];
+        }
+        if (normalizingSum > 0) {
+            for (int a = 0; a < actionNum; a++) {
+                average[a] = strategySum[a] / normalizingSum;
+            }
+        }
+        return average;
+    }
+
     auto Node::getStrategy() const -> const std::vector<float> & {
         return strategy;
     }
@@ -79,4 +126,9 @@ namespace CFR {
             strategySum[i] += probUpdatePlayer * currentStrategy[i];
         }
     }
+
+    size_t Node::memoryFootprint() const {
+        const size_t floats = regretSum.capacity() + strategy.capacity() + strategySum.capacity() + averageStrategy.capacity();
+        return sizeof(Node) + floats * sizeof(float);
+    }
 }
@@ -3,8 +3,10 @@
 #ifndef INC_2PLAYERCFR_NODE_HPP
 #define INC_2PLAYERCFR_NODE_HPP
 
+#include <atomic>
 #include <vector>
 #include <cstdint>
+#include <cstddef>
 
 namespace CFR {
 /// @class Node
@@ -14,12 +16,21 @@ namespace CFR {
         /// @param actionNum allowable actions at this node
         explicit Node(uint8_t actionNum);
 
+        /// @brief copies the values only, a copy is a new node to a checkpoint capture
+        Node(const Node& other);
+        Node(Node&& other) noexcept;
+        Node& operator=(const Node& other);
+        Node& operator=(Node&& other) noexcept;
+
         void calcUpdatedStrategy();
 
         void calcAverageStrategy();
 
         [[nodiscard]] const std::vector<float> & getAverageStrategy() const;
 
+        /// @brief Normalised strategySum, what calcAverageStrategy stores, without modifying the node
+        [[nodiscard]] std::vector<float> averageStrategyOf() const;
+
         [[nodiscard]] const std::vector<float> & getStrategy() const;
 
         [[nodiscard]] const std::vector<float> & getRegretSum() const;
@@ -36,12 +47,22 @@ namespace CFR {
 
         void updateStrategySum(const std::vector<float> &currentStrategy, float probUpdatePlayer);
 
+        /// @brief bytes owned by this node, the object itself plus its four vector buffers
+        [[nodiscard]] size_t memoryFootprint() const;
+
     private:
+        /// decodes stored records directly into the vectors below
+        friend class NodeSerializer;
+        /// claims the node through captureEpoch while a checkpoint is written
+        friend class NodeCapture;
+
         std::vector<float> regretSum;
         std::vector<float> strategy;
         std::vector<float> strategySum;
         std::vector<float> averageStrategy;
         uint8_t actionNum;
+        /// NodeCapture epoch the node was last copied in, fits in the padding after actionNum
+        std::atomic<uint32_t> captureEpoch{0};
     };
 }
 #endif //INC_2PLAYERCFR_NODE_HPP
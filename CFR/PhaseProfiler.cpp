@@ -0,0 +1,70 @@
+#include "PhaseProfiler.hpp"
+
+#include <algorithm>
+#include <format>
+
+namespace CFR {
+namespace {
+
+void merge(LatencyHistogram::Snapshot& into, const LatencyHistogram::Snapshot& from) {
+    into.count += from.count;
+    into.sumNanos += from.sumNanos;
+    into.maxNanos = std::max(into.maxNanos, from.maxNanos);
+    for (size_t i = 0; i < LatencyHistogram::BucketCount; ++i) {
+        into.buckets[i] += from.buckets[i];
+    }
+}
+
+std::string latencyLine(std::string_view name, const LatencyHistogram::Snapshot& latency) {
+    return std::format("{:<13}{:>12} calls  mean {:.0f}ns  p50 {}ns  p99 {}ns  p99.9 {}ns  max {}ns\n", name,
+                       latency.count, latency.meanNanos(), latency.percentileNanos(0.5),
+                       latency.percentileNanos(0.99), latency.percentileNanos(0.999), latency.maxNanos);
+}
+
+} // namespace
+
+PhaseProfile& PhaseProfile::operator+=(const PhaseProfile& other) {
+    for (size_t i = 0; i < PhaseCount; ++i) {
+        cycles[i] += other.cycles[i];
+        calls[i] += other.calls[i];
+    }
+    merge(storageGets, other.storageGets);
+    merge(storagePuts, other.storagePuts);
+    return *this;
+}
+
+std::string PhaseProfile::report() const {
+    if (!PhaseProfiler::Enabled) {
+        return "Phase profiling is compiled out, build with -DCFR_ENABLE_PROFILING=ON\n";
+    }
+    const auto total = static_cast<double>(std::max<uint64_t>(cycles[static_cast<size_t>(Phase::Total)], 1));
+    std::string text = std::format("{:<13}{:>16}{:>8}{:>14}{:>12}\n", "phase", "cycles", "share", "calls", "cycles/call");
+    uint64_t accounted = 0;
+    for (size_t i = 0; i < PhaseCount; ++i) {
+        if (i != static_cast<size_t>(Phase::Total)) {
+            accounted += cycles[i];
+        }
+        const double perCall = calls[i] > 0 ? static_cast<double>(cycles[i]) / static_cast<double>(calls[i]) : 0.0;
+        text += std::format("{:<13}{:>16}{:>7.1f}%{:>14}{:>12.0f}\n", phaseName(static_cast<Phase>(i)), cycles[i],
+                            100.0 * static_cast<double>(cycles[i]) / total, calls[i], perCall);
+    }
+    // traversal bookkeeping, sampling and profiling itself
+    const uint64_t other = cycles[static_cast<size_t>(Phase::Total)] - std::min(accounted, cycles[static_cast<size_t>(Phase::Total)]);
+    text += std::format("{:<13}{:>16}{:>7.1f}%\n", "other", other, 100.0 * static_cast<double>(other) / total);
+    text += latencyLine("storage get", storageGets);
+    text += latencyLine("storage put", storagePuts);
+    return text;
+}
+
+PhaseProfile PhaseProfiler::snapshot() const {
+    PhaseProfile profile;
+    for (size_t i = 0; i < PhaseCount; ++i) {
+        profile.cycles[i] = m_cycles[i].load(std::memory_order_relaxed);
+        profile.calls[i] = m_calls[i].load(std::memory_order_relaxed);
+    }
+    profile.storageGets = m_storageGets.snapshot();
+    profile.storagePuts = m_storagePuts.snapshot();
+    return profile;
+}
+
+} // namespace CFR
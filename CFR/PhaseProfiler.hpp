@@ -0,0 +1,138 @@
+#ifndef PHASEPROFILER_HPP
+#define PHASEPROFILER_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "../Storage/LatencyHistogram.hpp"
+
+namespace CFR {
+
+/// @brief Where a training thread spends its time
+enum class Phase : uint8_t {
+    /// @brief Everything inside a Train call, the other phases are parts of it
+    Total,
+    /// @brief Copying a game into the child frame and applying the action
+    Transition,
+    /// @brief Building the info set key of a decision node
+    InfoSet,
+    /// @brief Node lookups and stores
+    Storage,
+    /// @brief Strategy copy, regret and average strategy updates and regret matching
+    Regret,
+    /// @brief Terminal utility, the hand evaluation at a showdown
+    Showdown,
+};
+
+inline constexpr size_t PhaseCount = 6;
+
+[[nodiscard]] constexpr std::string_view phaseName(Phase phase) {
+    constexpr std::array<std::string_view, PhaseCount> names{"total", "transition", "info set", "storage", "regret", "showdown"};
+    return names[static_cast<size_t>(phase)];
+}
+
+/// @brief Time stamp counter where the CPU has one, steady clock nanoseconds elsewhere
+[[nodiscard]] inline uint64_t readCycles() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+/// @brief Phase totals of one or more training threads
+struct PhaseProfile {
+    std::array<uint64_t, PhaseCount> cycles{};
+    std::array<uint64_t, PhaseCount> calls{};
+    /// @brief Wall time of single node lookups, a batched getNodes call counts as one
+    LatencyHistogram::Snapshot storageGets;
+    LatencyHistogram::Snapshot storagePuts;
+
+    PhaseProfile& operator+=(const PhaseProfile& other);
+
+    /// @brief Table of cycles, share of total and cycles per call for every phase, then storage latency percentiles
+    [[nodiscard]] std::string report() const;
+};
+
+/// @brief Per thread phase counters, compiled in with CFR_ENABLE_PROFILING
+/// @details Only the owning thread writes, with relaxed loads and stores, so counting costs no locked instruction and
+/// another thread may take a snapshot while training runs. Without CFR_ENABLE_PROFILING the CFR_PROFILE_* macros
+/// expand to nothing and the minimizer holds no profiler.
+class PhaseProfiler {
+public:
+#ifdef CFR_ENABLE_PROFILING
+    static constexpr bool Enabled = true;
+#else
+    static constexpr bool Enabled = false;
+#endif
+
+    /// @brief Adds the cycles spent in its scope to a phase
+    class Scope {
+    public:
+        Scope(PhaseProfiler& profiler, Phase phase) noexcept : m_profiler(profiler), m_phase(phase), m_start(readCycles()) {}
+        ~Scope() { m_profiler.add(m_phase, readCycles() - m_start); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        PhaseProfiler& m_profiler;
+        Phase m_phase;
+        uint64_t m_start;
+    };
+
+    /// @brief A storage phase scope that also records its wall time into a latency histogram
+    class StorageScope {
+    public:
+        StorageScope(PhaseProfiler& profiler, LatencyHistogram& latency) noexcept
+            : m_timer(latency), m_scope(profiler, Phase::Storage) {}
+
+    private:
+        LatencyHistogram::ScopedTimer m_timer;
+        Scope m_scope;
+    };
+
+    void add(Phase phase, uint64_t cycles) noexcept {
+        const auto index = static_cast<size_t>(phase);
+        m_cycles[index].store(m_cycles[index].load(std::memory_order_relaxed) + cycles, std::memory_order_relaxed);
+        m_calls[index].store(m_calls[index].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    LatencyHistogram& storageGets() noexcept { return m_storageGets; }
+    LatencyHistogram& storagePuts() noexcept { return m_storagePuts; }
+
+    [[nodiscard]] PhaseProfile snapshot() const;
+
+private:
+    std::array<std::atomic<uint64_t>, PhaseCount> m_cycles{};
+    std::array<std::atomic<uint64_t>, PhaseCount> m_calls{};
+    LatencyHistogram m_storageGets;
+    LatencyHistogram m_storagePuts;
+};
+
+} // namespace CFR
+
+#define CFR_PROFILE_CONCAT_INNER(a, b) a##b
+#define CFR_PROFILE_CONCAT(a, b) CFR_PROFILE_CONCAT_INNER(a, b)
+
+#ifdef CFR_ENABLE_PROFILING
+/// @brief Count the rest of the enclosing scope towards phase
+#define CFR_PROFILE_PHASE(profiler, phase) \
+    const ::CFR::PhaseProfiler::Scope CFR_PROFILE_CONCAT(cfrPhase, __LINE__)((profiler), (phase))
+/// @brief Count the rest of the enclosing scope as storage and record its latency into histogram
+#define CFR_PROFILE_STORAGE(profiler, histogram) \
+    const ::CFR::PhaseProfiler::StorageScope CFR_PROFILE_CONCAT(cfrStorage, __LINE__)((profiler), (profiler).histogram())
+#else
+#define CFR_PROFILE_PHASE(profiler, phase) static_cast<void>(0)
+#define CFR_PROFILE_STORAGE(profiler, histogram) static_cast<void>(0)
+#endif
+
+#endif //PHASEPROFILER_HPP
@@ -0,0 +1,413 @@
+#ifndef PUBLICTREE_HPP
+#define PUBLICTREE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../Game/Utility/HandAbstraction/hand_index.h"
+#include "../Game/Utility/Random.hpp"
+#include "../Game/Utility/Utility.hpp"
+
+namespace CFR {
+
+/// @brief The betting tree of a game and the card removal arithmetic of walking it with one value per hole card pair
+/// @details Betting does not depend on the cards, so the tree is built once from any deal and walked with vectors holding
+/// a reach or value for each of the 1326 hole card pairs. BestResponse and FullTreeCFR both walk it, which keeps the
+/// payoffs, card removal and boards a solver trains on the same as those its exploitability is measured with.
+template <typename GameType>
+class PublicTree
+{
+public:
+    static constexpr uint32_t HandCount = 52 * 51 / 2;
+    static constexpr size_t Rounds = GameType::cardsPerRound.size();
+    static constexpr uint8_t FirstDealCards = GameType::cardsPerRound[1];
+    static constexpr uint8_t BoardCards =
+        std::accumulate(GameType::cardsPerRound.begin() + 1, GameType::cardsPerRound.end(), uint8_t{0});
+
+    using Range = std::vector<double>;
+
+    struct PublicNode {
+        enum class Kind : uint8_t { Action, Chance, Fold, Showdown };
+        Kind kind = Kind::Action;
+        uint8_t player = 0;
+        /// @brief Betting round, a chance node closes it
+        uint8_t round = 0;
+        /// @brief Slot in the first deal values for a chance node closing the first round, -1 otherwise
+        int32_t firstDeal = -1;
+        /// @brief Action tokens of the info set keys at this node
+        std::string history;
+        std::vector<uint32_t> children;
+        /// @brief Payoff of each seat after a fold
+        std::array<float, 2> fold{};
+        /// @brief Payoff of each seat when it wins, loses or ties the showdown
+        std::array<float, 2> win{}, lose{}, tie{};
+    };
+
+    struct Hand {
+        uint8_t low;
+        uint8_t high;
+        uint64_t mask;
+    };
+
+    /// @brief First public deal and the number of deals it stands for
+    struct Board {
+        std::array<uint8_t, FirstDealCards> cards{};
+        double weight = 0;
+    };
+
+    PublicTree();
+
+    [[nodiscard]] const PublicNode& node(uint32_t id) const { return m_tree[id]; }
+    [[nodiscard]] size_t size() const { return m_tree.size(); }
+    [[nodiscard]] uint32_t root() const { return m_root; }
+    /// @brief Chance nodes closing the first round, by their firstDeal slot
+    [[nodiscard]] const std::vector<uint32_t>& firstDeals() const { return m_firstDeals; }
+
+    [[nodiscard]] const Hand& hand(uint32_t h) const { return m_hands[h]; }
+    [[nodiscard]] bool live(uint32_t h, uint64_t mask) const { return (m_hands[h].mask & mask) == 0; }
+    /// @brief Indexer state and info set index of every hand before the board
+    [[nodiscard]] const std::vector<hand_indexer_state_t>& holeStates() const { return m_holeStates; }
+    [[nodiscard]] const std::vector<hand_index_t>& holeIndices() const { return m_holeIndices; }
+
+    /// @brief One board per suit isomorphism class weighted by the class size, or samples random first deals when nonzero
+    /// @details Deals of one class share their info sets and are worth the same, so a class drawn more than once is walked
+    /// once with the weight of its draws. The same samples and seed always give the same boards.
+    [[nodiscard]] static std::vector<Board> firstBoards(uint64_t samples, uint64_t seed);
+
+    /// @brief Board weight each hand's suit class sees over boards, the weight first deal values are averaged over
+    [[nodiscard]] Range classCoverage(std::span<const Board> boards) const;
+
+    /// @brief Each hand's value of a first deal from its values summed over boards, each times its board's weight
+    void resolveFirstDeal(const Range& total, const Range& classCoverage, Range& value) const;
+
+    /// @brief Strength of every hand live on a complete board, and the live hands sorted by it
+    void rankHands(std::span<const uint8_t, BoardCards> board, uint64_t mask, std::vector<int>& strength,
+                   std::vector<uint16_t>& byStrength) const;
+
+    /// @brief Value to seat of each hand live under mask at a fold, against the opponent reach opp
+    void foldValues(const PublicNode& node, uint64_t mask, const Range& opp, int seat, Range& out) const;
+
+    /// @brief Adds the showdown value to seat of each hand in byStrength, against the opponent reach opp
+    void showdown(const PublicNode& node, std::span<const uint16_t> byStrength, std::span<const int> strength,
+                  const Range& opp, int seat, Range& out) const;
+
+    /// @brief Calls visit with every k card subset of cards, in lexicographic order
+    template <typename Visit>
+    static void forEachCombination(std::span<const uint8_t> cards, uint8_t k, Visit&& visit);
+    static constexpr double choose(uint32_t n, uint32_t k);
+
+private:
+    uint32_t build(GameType& game, uint8_t round, const std::string& history, typename GameType::Action last);
+
+    std::vector<PublicNode> m_tree;
+    uint32_t m_root = 0;
+    std::vector<uint32_t> m_firstDeals;
+    std::vector<Hand> m_hands;
+    std::array<std::array<uint16_t, 52>, 52> m_handOf{};
+    /// @brief Hand each hand becomes under each of the 24 suit permutations
+    std::vector<std::array<uint16_t, HandCount>> m_suitImages;
+    std::vector<hand_indexer_state_t> m_holeStates;
+    std::vector<hand_index_t> m_holeIndices;
+};
+
+template <typename GameType>
+PublicTree<GameType>::PublicTree()
+{
+    Utility::initLookup();
+
+    // betting does not depend on the cards, so any deal walks the public tree
+    typename GameType::Engine engine(0);
+    GameType game(engine);
+    game.transition(GameType::Action::None);
+    m_root = build(game, 0, "", GameType::Action::None);
+
+    for (uint8_t low = 0; low < 52; ++low) {
+        for (uint8_t high = low + 1; high < 52; ++high) {
+            m_handOf[low][high] = m_handOf[high][low] = static_cast<uint16_t>(m_hands.size());
+            m_hands.push_back({low, high, (uint64_t{1} << low) | (uint64_t{1} << high)});
+        }
+    }
+
+    std::array<uint8_t, 4> suits{0, 1, 2, 3};
+    do {
+        auto& image = m_suitImages.emplace_back();
+        const auto permute = [&suits](uint8_t card) { return static_cast<uint8_t>((card & ~3) | suits[card & 3]); };
+        for (uint32_t h = 0; h < HandCount; ++h) {
+            image[h] = m_handOf[permute(m_hands[h].low)][permute(m_hands[h].high)];
+        }
+    } while (std::next_permutation(suits.begin(), suits.end()));
+
+    const hand_indexer_t& indexer = GameType::Cards::indexer();
+    m_holeStates.resize(HandCount);
+    m_holeIndices.resize(HandCount);
+    for (uint32_t h = 0; h < HandCount; ++h) {
+        const uint8_t cards[]{m_hands[h].low, m_hands[h].high};
+        hand_indexer_state_init(&indexer, &m_holeStates[h]);
+        m_holeIndices[h] = hand_index_next_round(&indexer, cards, &m_holeStates[h]);
+    }
+}
+
+template <typename GameType>
+uint32_t PublicTree<GameType>::build(GameType& game, uint8_t round, const std::string& history, typename GameType::Action last)
+{
+    const auto id = static_cast<uint32_t>(m_tree.size());
+    m_tree.emplace_back();
+    PublicNode node;
+    node.round = round;
+    node.history = history;
+
+    const std::string& type = game.getType();
+    if ("terminal" == type) {
+        for (int p = 0; p < 2; ++p) {
+            if (GameType::Action::Fold == last) {
+                node.kind = PublicNode::Kind::Fold;
+                node.fold[p] = game.getUtility(p);
+            } else {
+                node.kind = PublicNode::Kind::Showdown;
+                node.win[p] = game.getPayoff(p, p);
+                node.lose[p] = game.getPayoff(p, 1 - p);
+                node.tie[p] = game.getPayoff(p, 3);
+            }
+        }
+    } else if ("chance" == type) {
+        if (round + 1u >= Rounds) {
+            throw std::logic_error("chance node after the last round");
+        }
+        node.kind = PublicNode::Kind::Chance;
+        if (0 == round) {
+            node.firstDeal = static_cast<int32_t>(m_firstDeals.size());
+            m_firstDeals.push_back(id);
+        }
+        GameType next = game;
+        next.transition(GameType::Action::None);
+        node.children.push_back(build(next, round + 1, history, GameType::Action::None));
+    } else {
+        node.kind = PublicNode::Kind::Action;
+        node.player = static_cast<uint8_t>(game.getCurrentPlayer());
+        const auto actions = game.getActions();
+        for (const auto action : actions) {
+            GameType next = game;
+            next.transition(action);
+            node.children.push_back(build(next, round, history + GameType::actionToStr(action), action));
+        }
+    }
+    m_tree[id] = std::move(node);
+    return id;
+}
+
+template <typename GameType>
+auto PublicTree<GameType>::firstBoards(uint64_t samples, uint64_t seed) -> std::vector<Board>
+{
+    hand_indexer_t indexer;
+    const uint8_t cardsPerRound[]{FirstDealCards};
+    if (!hand_indexer_init(1, cardsPerRound, &indexer)) {
+        throw std::runtime_error("Failed to initialise the board indexer");
+    }
+
+    std::vector<Board> boards;
+    if (samples > 0) {
+        typename GameType::Engine engine(seed);
+        std::vector<int64_t> slotOfClass(hand_indexer_size(&indexer, 0), -1);
+        for (uint64_t i = 0; i < samples; ++i) {
+            auto deck = GameType::baseDeck;
+            Random::partialShuffle(std::span<uint8_t>(deck), FirstDealCards, engine);
+            Board board;
+            std::copy_n(deck.begin(), FirstDealCards, board.cards.begin());
+            int64_t& slot = slotOfClass[hand_index_last(&indexer, board.cards.data())];
+            if (slot < 0) {
+                slot = static_cast<int64_t>(boards.size());
+                boards.push_back(board);
+            }
+            boards[slot].weight += 1.0;
+        }
+    } else {
+        std::vector<uint32_t> classSize(hand_indexer_size(&indexer, 0), 0);
+        forEachCombination(GameType::baseDeck, FirstDealCards, [&](std::span<const uint8_t> cards) {
+            ++classSize[hand_index_last(&indexer, cards.data())];
+        });
+        boards.resize(classSize.size());
+        for (hand_index_t index = 0; index < classSize.size(); ++index) {
+            hand_unindex(&indexer, 0, index, boards[index].cards.data());
+            boards[index].weight = classSize[index];
+        }
+    }
+    hand_indexer_free(&indexer);
+    return boards;
+}
+
+template <typename GameType>
+auto PublicTree<GameType>::classCoverage(std::span<const Board> boards) const -> Range
+{
+    Range coverage(HandCount, 0.0);
+    for (const Board& board : boards) {
+        uint64_t mask = 0;
+        for (const uint8_t card : board.cards) {
+            mask |= uint64_t{1} << card;
+        }
+        for (uint32_t h = 0; h < HandCount; ++h) {
+            coverage[h] += live(h, mask) ? board.weight : 0.0;
+        }
+    }
+    Range byClass(HandCount, 0.0);
+    for (uint32_t h = 0; h < HandCount; ++h) {
+        for (const auto& image : m_suitImages) {
+            byClass[h] += coverage[image[h]];
+        }
+    }
+    return byClass;
+}
+
+template <typename GameType>
+void PublicTree<GameType>::resolveFirstDeal(const Range& total, const Range& classCoverage, Range& value) const
+{
+    // a board's suit permutations are worth as much to the permuted hands, so summing over the 24 permutations spreads
+    // each board over its class. Dividing by the board weight each hand's class saw turns the sum into a mean over the
+    // boards, which is exact when enumerating and keeps card removal exact when sampling, and scaling by the chance of
+    // those boards given both players' hands makes it the hand's value.
+    const double boardScale = choose(50, FirstDealCards) / choose(48, FirstDealCards);
+    value.assign(HandCount, 0.0);
+    for (uint32_t h = 0; h < HandCount; ++h) {
+        if (classCoverage[h] > 0) {
+            double sum = 0;
+            for (const auto& image : m_suitImages) {
+                sum += total[image[h]];
+            }
+            value[h] = sum / classCoverage[h] * boardScale;
+        }
+    }
+}
+
+template <typename GameType>
+void PublicTree<GameType>::rankHands(std::span<const uint8_t, BoardCards> board, uint64_t mask, std::vector<int>& strength,
+                                     std::vector<uint16_t>& byStrength) const
+{
+    // the evaluator numbers cards from 1, the board is walked once and every hand continues from it
+    std::array<int, BoardCards> cards{};
+    for (size_t i = 0; i < BoardCards; ++i) {
+        cards[i] = board[i] + 1;
+    }
+    const int boardState = Utility::LookupState(53, cards.data(), BoardCards);
+    strength.resize(HandCount);
+    byStrength.clear();
+    for (uint32_t h = 0; h < HandCount; ++h) {
+        if (live(h, mask)) {
+            const int hole[]{m_hands[h].low + 1, m_hands[h].high + 1};
+            strength[h] = Utility::LookupState(boardState, hole, 2);
+            byStrength.push_back(static_cast<uint16_t>(h));
+        }
+    }
+    std::ranges::sort(byStrength, {}, [&strength](uint16_t h) { return strength[h]; });
+}
+
+template <typename GameType>
+void PublicTree<GameType>::foldValues(const PublicNode& node, uint64_t mask, const Range& opp, int seat, Range& out) const
+{
+    // each hand earns the fold payoff on every opponent hand that shares no card with it
+    std::array<double, 52> cardMass{};
+    double total = 0;
+    for (uint32_t h = 0; h < HandCount; ++h) {
+        total += opp[h];
+        cardMass[m_hands[h].low] += opp[h];
+        cardMass[m_hands[h].high] += opp[h];
+    }
+    for (uint32_t h = 0; h < HandCount; ++h) {
+        if (live(h, mask)) {
+            const Hand& hand = m_hands[h];
+            out[h] = node.fold[seat] * (total - cardMass[hand.low] - cardMass[hand.high] + opp[h]);
+        }
+    }
+}
+
+template <typename GameType>
+void PublicTree<GameType>::showdown(const PublicNode& node, std::span<const uint16_t> byStrength, std::span<const int> strength,
+                                    const Range& opp, int seat, Range& out) const
+{
+    const double win = node.win[seat];
+    const double lose = node.lose[seat];
+    const double tie = node.tie[seat];
+
+    // a hand's payoff is win on weaker opponent hands, lose on stronger ones and tie on the rest, so
+    // out = (win - tie) * weaker + (lose - tie) * stronger + tie * all, each mass leaving out hands sharing a card
+    std::array<double, 52> cardMass{};
+    double total = 0;
+    const auto sweep = [&](auto first, auto last, double payoff) {
+        cardMass.fill(0.0);
+        total = 0;
+        for (auto group = first; group != last;) {
+            auto end = group;
+            while (end != last && strength[*end] == strength[*group]) {
+                ++end;
+            }
+            for (auto it = group; it != end; ++it) {
+                const Hand& hand = m_hands[*it];
+                out[*it] += payoff * (total - cardMass[hand.low] - cardMass[hand.high]);
+            }
+            for (auto it = group; it != end; ++it) {
+                const Hand& hand = m_hands[*it];
+                total += opp[*it];
+                cardMass[hand.low] += opp[*it];
+                cardMass[hand.high] += opp[*it];
+            }
+            group = end;
+        }
+    };
+    sweep(byStrength.begin(), byStrength.end(), win - tie);
+    sweep(byStrength.rbegin(), byStrength.rend(), lose - tie);
+    // after the sweeps total and cardMass hold every live hand
+    for (const uint16_t h : byStrength) {
+        const Hand& hand = m_hands[h];
+        out[h] += tie * (total - cardMass[hand.low] - cardMass[hand.high] + opp[h]);
+    }
+}
+
+template <typename GameType>
+template <typename Visit>
+void PublicTree<GameType>::forEachCombination(std::span<const uint8_t> cards, uint8_t k, Visit&& visit)
+{
+    const size_t n = cards.size();
+    if (k == 0 || k > n) {
+        return;
+    }
+    std::array<size_t, BoardCards> at{};
+    std::array<uint8_t, BoardCards> chosen{};
+    for (size_t i = 0; i < k; ++i) {
+        at[i] = i;
+    }
+    while (true) {
+        for (size_t i = 0; i < k; ++i) {
+            chosen[i] = cards[at[i]];
+        }
+        visit(std::span<const uint8_t>(chosen.data(), k));
+        size_t i = k;
+        while (i > 0 && at[i - 1] == n - k + i - 1) {
+            --i;
+        }
+        if (i == 0) {
+            return;
+        }
+        ++at[i - 1];
+        for (size_t j = i; j < k; ++j) {
+            at[j] = at[j - 1] + 1;
+        }
+    }
+}
+
+template <typename GameType>
+constexpr double PublicTree<GameType>::choose(uint32_t n, uint32_t k)
+{
+    double result = 1;
+    for (uint32_t i = 0; i < k; ++i) {
+        result = result * (n - i) / (i + 1);
+    }
+    return result;
+}
+
+} // namespace CFR
+
+#endif //PUBLICTREE_HPP
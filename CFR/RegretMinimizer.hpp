@@ -5,6 +5,11 @@
 #ifndef INC_2PLAYERCFR_REGRETMINIMIZER_HPP
 #define INC_2PLAYERCFR_REGRETMINIMIZER_HPP
 
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <span>
+#include <stdexcept>
 #include <thread>
 #include <random>
 #include "../Game/GameImpl/Preflop/Game.hpp"
@@ -12,11 +17,17 @@
 #include "Node.hpp"
 #include "../Game/Utility/Utility.hpp"
 #include "CustomExceptions.h"
+#include "../Storage/AccessTrace.hpp"
 #include "../Storage/MapNodeStorage.hpp"
+#include "AsyncTraversal.hpp"
+#include "Metrics.hpp"
+#include "PhaseProfiler.hpp"
+#include "SamplingPolicy.hpp"
 
 namespace CFR {
 
-template<typename GameType, typename StorageType = MapNodeStorage>
+/// @tparam Sampling traversal policy of Train, TrainBatched and TrainAsync, see SamplingPolicy.hpp
+template<typename GameType, typename StorageType = MapNodeStorage, typename Sampling = ExternalSampling>
 class RegretMinimizer {
  public:
   /// @brief constructor takes a seed or one is generated
@@ -34,18 +45,58 @@ class RegretMinimizer {
   /// @brief calls cfr algorithm for full game tree (or sampled based on version) traversal the specified number of times
   void Train(uint32_t iterations);
 
+  /// @brief same as Train but deals batchSize hands at once and walks them in lock step
+  /// @details Every deal is advanced to its next decision node, then the info sets of all of them are fetched with one
+  /// getNodes request, so storage sees one batch per tree level instead of one random lookup per node
+  void TrainBatched(uint32_t iterations, uint32_t batchSize = 64);
+
+  /// @brief same as Train but keeps inFlight deals going at once, each as a coroutine
+  /// @details A deal whose next node is not resident (tryGetNode) suspends while an I/O thread reads it through loadNode,
+  /// and the thread carries on with the other deals, so disk reads overlap traversal instead of stalling it
+  void TrainAsync(uint32_t iterations, uint32_t inFlight = 32);
+
+  /// @brief Pool that serves TrainAsync reads, shared between minimizers; one is created on first use if none is set
+  void setIoPool(std::shared_ptr<IoThreadPool> pool) { m_ioPool = std::move(pool); }
+
   /// @brief Set cancellation flag to interrupt training
   void setCancelled(bool cancelled) { m_cancelledTraining = cancelled; }
   
   /// @brief Check if training should be cancelled
   bool isCancelled() const { return m_cancelledTraining; }
 
+  /// @brief Publish this minimizer's counters to a registry block after every iteration
+  void setMetrics(std::shared_ptr<WorkerMetrics> metrics) { m_metrics = std::move(metrics); }
+
+  /// @brief Record every node lookup, and the put of each node created, to an access trace for replay benchmarks
+  void setTrace(std::shared_ptr<AccessTraceWriter> trace) { m_trace = std::move(trace); }
+
+  [[nodiscard]] uint64_t getNodesTouched() const { return nodesTouched; }
+
+  /// @brief Cycles per training phase and storage latencies so far, empty unless built with CFR_ENABLE_PROFILING
+  [[nodiscard]] PhaseProfile getProfile() const {
+#ifdef CFR_ENABLE_PROFILING
+    return m_profiler.snapshot();
+#else
+    return {};
+#endif
+  }
+
+  /// @brief Random engine state, for checkpoints
+  [[nodiscard]] const typename GameType::Engine &getEngine() const { return rng; }
+
+  /// @brief Continue from a saved engine state, every deal in progress is redealt from it
+  void setEngine(const typename GameType::Engine &engine);
+
+  /// @brief Prefetch the info sets of a decision node's children before walking them
+  /// @details Off by default, it pays for an extra game copy per action and only wins once the node table is far larger than the CPU caches
+  void setPrefetch(bool enabled) { m_prefetch = enabled; }
+
   [[nodiscard]]
   auto getNodeInformation(const std::string& index) noexcept -> std::vector<std::vector<float>>;
 
   void flushStorageCache();
 
-  /// @brief recursively traverse game tree (depth-first) sampling only one chance outcome at each chance node and all actions
+  /// @brief traverse game tree (depth-first) sampling only one chance outcome at each chance node and all actions
   /// @param updatePlayer player whose getStrategy is updated and utilities are retrieved in terms of
   /// @param probCounterFactual probability of reaching the next node given all players actions and chance except for the updateCurrentPlayer's actions
   /// @param probUpdatePlayer probability of reaching next node given only the updateCurrentPlayer's actions
@@ -54,11 +105,75 @@ class RegretMinimizer {
   auto ChanceCFR(const GameType &game, int updatePlayer, float probCounterFactual, float probUpdatePlayer) -> float;
 
   /// @brief same as ChanceCFR except at each action node sample one action for non update player
+  /// @details Under OutcomeSampling or AverageStrategySampling the update player's actions are sampled as well
   auto ExternalSamplingCFR(const GameType &game, int updatePlayer, float probCounterFactual, float probUpdatePlayer) -> float;
 
 
  private:
-  std::mt19937 rng;
+  enum class Stage : uint8_t { Enter, AwaitNode, Enumerate, PassThrough, Sampled };
+
+  /// @brief one level of the explicit traversal stack, kept between iterations so its buffers are reused
+  struct Frame {
+    explicit Frame(const GameType &game) : game(game) {}
+
+    GameType game;
+    std::shared_ptr<Node> node;
+    std::vector<float> strategy;
+    std::vector<float> counterfactualValues;
+    float probCounterFactual{};
+    float probUpdatePlayer{};
+    /// @brief probability the update player's own actions so far were sampled, 1 unless Sampling samples them
+    float probSample{};
+    /// @brief per action sampling probability at an update player node, 0 for an action average strategy sampling skipped
+    std::vector<float> sampleProbs;
+    /// @brief running node value, sum of strategy weighted counterfactual values
+    float value{};
+    uint8_t nextAction{};
+    bool updating{};
+    Stage stage{Stage::Enter};
+  };
+
+  /// @brief resumable depth first traversal of one deal
+  struct Traversal {
+    std::deque<Frame> frames;
+    size_t depth = 0;
+    /// @brief value of the subtree that was just finished, the root value once the traversal is done
+    float result = 0.f;
+    int updatePlayer = 0;
+  };
+
+  void start(Traversal &traversal, const GameType &root, int updatePlayer, float probCounterFactual, float probUpdatePlayer);
+
+  /// @brief run a traversal until it finishes or, when Batched, stops at a decision node still waiting for its node
+  /// @tparam SampleOpponent sample one action for the non update player instead of enumerating them all
+  /// @return true once the traversal is done, its value is then in traversal.result
+  template<bool SampleOpponent, bool Batched>
+  bool advance(Traversal &traversal);
+
+  /// @brief walk deals on one batch slot until the run's iterations are all claimed
+  TraversalTask asyncSlot(size_t slot, AsyncNodeReads &reads, uint32_t &claimed, uint32_t iterations);
+
+  /// @brief grow the per-deal batch state to hold at least deals
+  void reserveBatch(uint32_t deals);
+
+  /// @brief give a waiting decision frame its node, creating and storing one if there is none yet
+  void attachNode(Frame &frame, const std::string &infoSet, std::shared_ptr<Node> node);
+
+  /// @brief copy the game at depth into the frame above it and apply action
+  void descend(Traversal &traversal, size_t depth, typename GameType::Action action, float probCounterFactual, float probUpdatePlayer, float probSample);
+
+  /// @brief regret and average strategy updates of an update player node from its counterfactual values and value
+  void updateNode(Frame &frame);
+
+  auto frameAt(Traversal &traversal, size_t depth) -> Frame &;
+
+  /// @brief count finished iterations and copy the running totals to m_metrics, if set
+  void publishMetrics(uint32_t iterations);
+
+  /// @brief work out the info set behind each action of a decision node and ask storage to prefetch it
+  void prefetchChildren(const GameType &game);
+
+  typename GameType::Engine rng;
 
   [[no_unique_address]] Utility util;
 
@@ -66,37 +181,67 @@ class RegretMinimizer {
 
   GameType Game;
 
+  /// @brief scratch copy used to compute child info sets for prefetching
+  GameType m_lookahead;
+
+  bool m_prefetch = false;
+
   uint64_t nodesTouched{};
 
+  /// running totals, published to m_metrics with plain stores since this thread is their only writer
+  uint64_t m_iterationsTrained{};
+  uint64_t m_nodesCreated{};
+  uint64_t m_regretUpdates{};
+  double m_regretMagnitude{};
+  std::shared_ptr<WorkerMetrics> m_metrics;
+
+  std::shared_ptr<AccessTraceWriter> m_trace;
+
+#ifdef CFR_ENABLE_PROFILING
+  PhaseProfiler m_profiler;
+#endif
+
   std::atomic<bool> m_cancelledTraining{false};
 
+  Traversal m_traversal;
+
+  std::shared_ptr<IoThreadPool> m_ioPool;
+
+  /// batched and asynchronous training state, sized to the largest batch seen and reused
+  std::vector<GameType> m_batchDeals;
+  std::vector<Traversal> m_batchTraversals;
+  std::vector<size_t> m_batchPending;
+  std::vector<std::string> m_batchKeys;
+  std::vector<std::shared_ptr<Node>> m_batchNodes;
+
 };
 
 
 ///Implementation of templates above
-template<typename GameType, typename StorageType>
-RegretMinimizer<GameType, StorageType>::RegretMinimizer(const uint32_t seed) 
-    : rng(seed), m_storage(std::make_shared<StorageType>()), Game(rng) {}
+template<typename GameType, typename StorageType, typename Sampling>
+RegretMinimizer<GameType, StorageType, Sampling>::RegretMinimizer(const uint32_t seed) 
+    : rng(seed), m_storage(std::make_shared<StorageType>()), Game(rng), m_lookahead(Game) {}
 
-template<typename GameType, typename StorageType>
-RegretMinimizer<GameType, StorageType>::RegretMinimizer(uint32_t seed, std::shared_ptr<StorageType> storage)
-    : rng(seed), m_storage(std::move(storage)), Game(rng) {}
+template<typename GameType, typename StorageType, typename Sampling>
+RegretMinimizer<GameType, StorageType, Sampling>::RegretMinimizer(uint32_t seed, std::shared_ptr<StorageType> storage)
+    : rng(seed), m_storage(std::move(storage)), Game(rng), m_lookahead(Game) {}
 
 
-template<typename GameType, typename StorageType>
-  RegretMinimizer<GameType,StorageType>::~RegretMinimizer() {
+template<typename GameType, typename StorageType, typename Sampling>
+  RegretMinimizer<GameType, StorageType, Sampling>::~RegretMinimizer() {
     flushStorageCache();
   }
 
-  template<typename GameType, typename StorageType>
-  void RegretMinimizer<GameType,StorageType>::flushStorageCache() {
+  template<typename GameType, typename StorageType, typename Sampling>
+  void RegretMinimizer<GameType, StorageType, Sampling>::flushStorageCache() {
     if (m_storage) {
       m_storage->flushCache();
     }
   }
 
-template<typename GameType, typename StorageType>
-void RegretMinimizer<GameType, StorageType>::Train(uint32_t iterations) {
+template<typename GameType, typename StorageType, typename Sampling>
+void RegretMinimizer<GameType, StorageType, Sampling>::Train(uint32_t iterations) {
+  CFR_PROFILE_PHASE(m_profiler, Phase::Total);
   std::array<float,GameType::PlayerNum> value;
   for (uint32_t i = 0; i < iterations; ++i) {
     for (uint32_t p = 0; p < GameType::PlayerNum; ++p) {
@@ -104,142 +249,439 @@ void RegretMinimizer<GameType, StorageType>::Train(uint32_t iterations) {
       value[p] = ExternalSamplingCFR(Game, p, 1.0, 1.0);
     }
     Game.reInitialize();
+    publishMetrics(1);
   }
 }
-template<typename GameType, typename StorageType>
-auto RegretMinimizer<GameType, StorageType>::ChanceCFR(const GameType &game, int updatePlayer, float probCounterFactual, float probUpdatePlayer) -> float {
-  ++nodesTouched;
+template<typename GameType, typename StorageType, typename Sampling>
+void RegretMinimizer<GameType, StorageType, Sampling>::TrainBatched(uint32_t iterations, uint32_t batchSize) {
+  if (batchSize == 0) {
+    throw std::invalid_argument("Batch size must be at least one deal");
+  }
+  reserveBatch(batchSize);
+  CFR_PROFILE_PHASE(m_profiler, Phase::Total);
 
-  std::string type = game.getType();
+  for (uint32_t done = 0; done < iterations && !m_cancelledTraining;) {
+    const uint32_t deals = std::min(batchSize, iterations - done);
+    for (uint32_t p = 0; p < GameType::PlayerNum; ++p) {
+      m_batchPending.clear();
+      for (uint32_t d = 0; d < deals; ++d) {
+        start(m_batchTraversals[d], m_batchDeals[d], static_cast<int>(p), 1.0, 1.0);
+        m_batchPending.push_back(d);
+      }
 
-  if ("terminal" == type) {
-    return game.getUtility(updatePlayer);
+      while (!m_batchPending.empty()) {
+        // advance every unfinished deal to its next decision node
+        size_t waiting = 0;
+        for (const size_t d : m_batchPending) {
+          if (!advance<true, true>(m_batchTraversals[d])) {
+            m_batchPending[waiting++] = d;
+          }
+        }
+        m_batchPending.resize(waiting);
+        if (waiting == 0) {
+          break;
+        }
+
+        {
+          CFR_PROFILE_PHASE(m_profiler, Phase::InfoSet);
+          for (size_t k = 0; k < waiting; ++k) {
+            const Traversal &traversal = m_batchTraversals[m_batchPending[k]];
+            const GameType &game = traversal.frames[traversal.depth].game;
+            m_batchKeys[k].assign(game.getInfoSet(game.getCurrentPlayer()));
+            m_batchNodes[k] = nullptr;
+          }
+        }
+        {
+          CFR_PROFILE_STORAGE(m_profiler, storageGets);
+          m_storage->getNodes(std::span<const std::string>(m_batchKeys.data(), waiting), std::span<std::shared_ptr<Node>>(m_batchNodes.data(), waiting));
+        }
+
+        for (size_t k = 0; k < waiting; ++k) {
+          if (m_batchNodes[k] == nullptr) {
+            // an earlier deal in this pass may have just created it
+            CFR_PROFILE_STORAGE(m_profiler, storageGets);
+            m_batchNodes[k] = m_storage->getNode(m_batchKeys[k]);
+          }
+          Traversal &traversal = m_batchTraversals[m_batchPending[k]];
+          attachNode(traversal.frames[traversal.depth], m_batchKeys[k], std::move(m_batchNodes[k]));
+        }
+      }
+    }
+    for (uint32_t d = 0; d < deals; ++d) {
+      m_batchDeals[d].reInitialize();
+    }
+    publishMetrics(deals);
+    done += deals;
   }
-  if ("chance" == type) {
-    /// get actions and their size
-    std::vector<typename GameType::Action> const actions = game.getActions();
+}
 
-    /// sample one chance outcome at each chance node
-    GameType copiedGame(game);
-    copiedGame.transition(GameType::Action::None);
-    float nodeValue;
-    nodeValue = ChanceCFR(copiedGame, updatePlayer, probCounterFactual, probUpdatePlayer);
-    return nodeValue;
+template<typename GameType, typename StorageType, typename Sampling>
+void RegretMinimizer<GameType, StorageType, Sampling>::setEngine(const typename GameType::Engine &engine) {
+  rng = engine;
+  Game.reInitialize();
+  for (GameType &deal : m_batchDeals) {
+    deal.reInitialize();
   }
-  if ("action" == type) { //Decision Node
-    /// get actions and their size
-    std::vector<typename GameType::Action> const actions = game.getActions();
-    const auto actionNum = static_cast<int>(actions.size());
-    float nodeValue = 0.f;
+}
 
-    std::string infoSet = game.getInfoSet(game.getCurrentPlayer());
-    auto node = m_storage->getNode(infoSet);
-    if (node == nullptr) {
-      node = std::make_shared<Node>(actionNum);
-      m_storage->putNode(infoSet, node);
-    }
+template<typename GameType, typename StorageType, typename Sampling>
+void RegretMinimizer<GameType, StorageType, Sampling>::TrainAsync(uint32_t iterations, uint32_t inFlight) {
+  if (inFlight == 0) {
+    throw std::invalid_argument("Async training needs at least one deal in flight");
+  }
+  reserveBatch(inFlight);
+  CFR_PROFILE_PHASE(m_profiler, Phase::Total);
+  if (!m_ioPool) {
+    m_ioPool = std::make_shared<IoThreadPool>();
+  }
 
-    const std::vector<float> currentStrategy = node->getStrategy();
-
-    /// get counterfactual value and node value by recursively getting utilities and probability we reach them
-    std::vector<float> counterfactualValue(actionNum);
-    for (int i = 0; i < actionNum; ++i) {
-      GameType gamePlusOneAction(game);
-      gamePlusOneAction.transition(actions[i]);
-      if (updatePlayer == game.getCurrentPlayer()) {
-        counterfactualValue[i] = ChanceCFR(gamePlusOneAction, updatePlayer, probCounterFactual, probUpdatePlayer * currentStrategy[i]);
-      } else {
-        counterfactualValue[i] = ChanceCFR(gamePlusOneAction, updatePlayer, probCounterFactual * currentStrategy[i], probUpdatePlayer);
-      }
-      nodeValue += currentStrategy[i] * counterfactualValue[i];
+  AsyncNodeReads reads(*m_storage, *m_ioPool);
+  uint32_t claimed = 0;
+  std::vector<TraversalTask> slots;
+  slots.reserve(inFlight);
+  for (uint32_t slot = 0; slot < inFlight; ++slot) {
+    slots.push_back(asyncSlot(slot, reads, claimed, iterations));
+    slots.back().resume();
+  }
+  // every suspended slot is waiting on a read, so once none are outstanding every slot has finished
+  while (reads.outstanding() > 0) {
+    reads.resumeNext();
+  }
+  for (const TraversalTask &slot : slots) {
+    if (slot.error()) {
+      std::rethrow_exception(slot.error());
     }
+  }
+}
 
-    /// do regret calculation and matching based on the returned nodeValue only for update player
-    if (updatePlayer == game.getCurrentPlayer()) {
-      for (int i = 0; i < actions.size(); ++i) {
-        const float actionRegret = counterfactualValue[i] - nodeValue;
-        node->updateRegretSum(i, actionRegret, probCounterFactual);
+template<typename GameType, typename StorageType, typename Sampling>
+TraversalTask RegretMinimizer<GameType, StorageType, Sampling>::asyncSlot(size_t slot, AsyncNodeReads &reads, uint32_t &claimed, uint32_t iterations) {
+  GameType &deal = m_batchDeals[slot];
+  Traversal &traversal = m_batchTraversals[slot];
+  std::string &infoSet = m_batchKeys[slot];
+
+  while (claimed < iterations && !m_cancelledTraining) {
+    ++claimed;
+    for (uint32_t p = 0; p < GameType::PlayerNum; ++p) {
+      start(traversal, deal, static_cast<int>(p), 1.0, 1.0);
+      while (!advance<true, true>(traversal)) {
+        Frame &frame = traversal.frames[traversal.depth];
+        {
+          CFR_PROFILE_PHASE(m_profiler, Phase::InfoSet);
+          infoSet.assign(frame.game.getInfoSet(frame.game.getCurrentPlayer()));
+        }
+        std::optional<std::shared_ptr<Node>> node = [&] {
+          CFR_PROFILE_STORAGE(m_profiler, storageGets);
+          return m_storage->tryGetNode(infoSet);
+        }();
+        if (!node) {
+          std::shared_ptr<Node> loaded = co_await reads.read(infoSet);
+          // another deal may have created the node while this one waited, the resident copy wins
+          CFR_PROFILE_STORAGE(m_profiler, storageGets);
+          node = m_storage->tryGetNode(infoSet);
+          if (!node || *node == nullptr) {
+            node = std::move(loaded);
+          }
+        }
+        attachNode(frame, infoSet, std::move(*node));
       }
-      /// update average getStrategy across all training iterations
-      node->updateStrategySum(currentStrategy, probUpdatePlayer);
-      node->calcUpdatedStrategy();
     }
-    return nodeValue;
+    deal.reInitialize();
+    publishMetrics(1);
   }
-  throw GameStageViolation("did not match a game type in ChanceSamplingCFR");
 }
 
-template<typename GameType, typename StorageType>
-auto RegretMinimizer<GameType, StorageType>::ExternalSamplingCFR(const GameType &game, int updatePlayer, float probCounterFactual, float probUpdatePlayer) -> float {
-  ++nodesTouched;
-
-  std::string type = game.getType();
+template<typename GameType, typename StorageType, typename Sampling>
+void RegretMinimizer<GameType, StorageType, Sampling>::publishMetrics(uint32_t iterations) {
+  m_iterationsTrained += iterations;
+  if (m_metrics) {
+    m_metrics->iterations.store(m_iterationsTrained, std::memory_order_relaxed);
+    m_metrics->nodesTouched.store(nodesTouched, std::memory_order_relaxed);
+    m_metrics->nodesCreated.store(m_nodesCreated, std::memory_order_relaxed);
+    m_metrics->regretUpdates.store(m_regretUpdates, std::memory_order_relaxed);
+    m_metrics->regretMagnitude.store(m_regretMagnitude, std::memory_order_relaxed);
+  }
+}
 
-  if ("terminal" == type) {
-    return game.getUtility(updatePlayer);
+template<typename GameType, typename StorageType, typename Sampling>
+void RegretMinimizer<GameType, StorageType, Sampling>::reserveBatch(uint32_t deals) {
+  while (m_batchDeals.size() < deals) {
+    m_batchDeals.emplace_back(rng);
+  }
+  if (m_batchTraversals.size() < deals) {
+    m_batchTraversals.resize(deals);
+    m_batchKeys.resize(deals);
+    m_batchNodes.resize(deals);
   }
+}
+
+template<typename GameType, typename StorageType, typename Sampling>
+auto RegretMinimizer<GameType, StorageType, Sampling>::ChanceCFR(const GameType &game, int updatePlayer, float probCounterFactual, float probUpdatePlayer) -> float {
+  start(m_traversal, game, updatePlayer, probCounterFactual, probUpdatePlayer);
+  advance<false, false>(m_traversal);
+  return m_traversal.result;
+}
 
-  //actions available at this game state / node
-  const auto actions = game.getActions();
-  const auto actionNum = static_cast<uint8_t >(actions.size());
+template<typename GameType, typename StorageType, typename Sampling>
+auto RegretMinimizer<GameType, StorageType, Sampling>::ExternalSamplingCFR(const GameType &game, int updatePlayer, float probCounterFactual, float probUpdatePlayer) -> float {
+  start(m_traversal, game, updatePlayer, probCounterFactual, probUpdatePlayer);
+  advance<true, false>(m_traversal);
+  return m_traversal.result;
+}
 
-  if ("chance" == type) {
-    //sample one chance outcome at each chance node
-    GameType copiedGame(game);
-    copiedGame.transition(GameType::Action::None);
-    float nodeValue = ExternalSamplingCFR(copiedGame, updatePlayer, probCounterFactual, probUpdatePlayer);
-    return nodeValue;
+template<typename GameType, typename StorageType, typename Sampling>
+auto RegretMinimizer<GameType, StorageType, Sampling>::frameAt(Traversal &traversal, size_t depth) -> Frame & {
+  // a deque never moves existing frames, so references to shallower frames stay valid while the stack grows
+  while (traversal.frames.size() <= depth) {
+    traversal.frames.emplace_back(Game);
   }
+  return traversal.frames[depth];
+}
+
+template<typename GameType, typename StorageType, typename Sampling>
+void RegretMinimizer<GameType, StorageType, Sampling>::start(Traversal &traversal, const GameType &root, int updatePlayer, float probCounterFactual, float probUpdatePlayer) {
+  Frame &rootFrame = frameAt(traversal, 0);
+  rootFrame.game = root;
+  rootFrame.stage = Stage::Enter;
+  rootFrame.probCounterFactual = probCounterFactual;
+  rootFrame.probUpdatePlayer = probUpdatePlayer;
+  rootFrame.probSample = 1.f;
+  traversal.depth = 0;
+  traversal.result = 0.f;
+  traversal.updatePlayer = updatePlayer;
+}
 
-  if ("action" == type) { //Decision Node
-    float nodeValue = 0.f;
+template<typename GameType, typename StorageType, typename Sampling>
+void RegretMinimizer<GameType, StorageType, Sampling>::descend(Traversal &traversal, size_t depth, typename GameType::Action action, float probCounterFactual, float probUpdatePlayer, float probSample) {
+  CFR_PROFILE_PHASE(m_profiler, Phase::Transition);
+  Frame &child = frameAt(traversal, depth + 1);
+  // copy assignment reuses the child's string and vector buffers from earlier iterations
+  child.game = traversal.frames[depth].game;
+  child.game.transition(action);
+  child.stage = Stage::Enter;
+  child.probCounterFactual = probCounterFactual;
+  child.probUpdatePlayer = probUpdatePlayer;
+  child.probSample = probSample;
+}
 
-    std::string infoSet = game.getInfoSet(game.getCurrentPlayer());
-    auto node = m_storage->getNode(infoSet);
-    if (node == nullptr) {
-      node = std::make_shared<Node>(actionNum);
+template<typename GameType, typename StorageType, typename Sampling>
+void RegretMinimizer<GameType, StorageType, Sampling>::updateNode(Frame &frame) {
+  CFR_PROFILE_PHASE(m_profiler, Phase::Regret);
+  // a checkpoint being written copies the node first if it still needs the old value
+  m_storage->beforeUpdate(frame.node);
+  // dividing by the sampling probability of the update player's own path keeps sampled estimates unbiased, it is 1 under external sampling
+  const float regretWeight = frame.probCounterFactual / frame.probSample;
+  for (size_t i = 0; i < frame.counterfactualValues.size(); ++i) {
+    const float actionRegret = frame.counterfactualValues[i] - frame.value;
+    frame.node->updateRegretSum(static_cast<int>(i), actionRegret, regretWeight);
+    m_regretMagnitude += std::abs(actionRegret);
+  }
+  m_regretUpdates += frame.counterfactualValues.size();
+  /// update average getStrategy across all training iterations
+  frame.node->updateStrategySum(frame.strategy, frame.probUpdatePlayer / frame.probSample);
+  frame.node->calcUpdatedStrategy();
+}
+
+template<typename GameType, typename StorageType, typename Sampling>
+void RegretMinimizer<GameType, StorageType, Sampling>::attachNode(Frame &frame, const std::string &infoSet, std::shared_ptr<Node> node) {
+  // every training mode funnels its lookup through here, so the trace holds one get per decision node visited
+  if (m_trace) {
+    m_trace->get(infoSet);
+  }
+  if (node == nullptr) {
+    const auto actions = static_cast<uint8_t>(frame.game.getActions().size());
+    node = std::make_shared<Node>(actions);
+    {
+      CFR_PROFILE_STORAGE(m_profiler, storagePuts);
       m_storage->putNode(infoSet, node);
     }
+    if (m_trace) {
+      m_trace->put(infoSet, actions);
+    }
+    ++m_nodesCreated;
+  }
+  frame.node = std::move(node);
+}
+
+template<typename GameType, typename StorageType, typename Sampling>
+void RegretMinimizer<GameType, StorageType, Sampling>::prefetchChildren(const GameType &game) {
+  // children are walked one subtree at a time, by the time the traversal reaches the later ones their entries are warm
+  for (const auto action : game.getActions()) {
+    m_lookahead = game;
+    m_lookahead.transition(action);
+    if ("action" == m_lookahead.getType()) {
+      m_storage->prefetch(m_lookahead.getInfoSet(m_lookahead.getCurrentPlayer()));
+    }
+  }
+}
+
+template<typename GameType, typename StorageType, typename Sampling>
+template<bool SampleOpponent, bool Batched>
+bool RegretMinimizer<GameType, StorageType, Sampling>::advance(Traversal &traversal) {
+  constexpr bool SampleOutcome = SampleOpponent && Sampling::Scheme == TraversalScheme::Outcome;
+  constexpr bool SampleAverage = SampleOpponent && Sampling::Scheme == TraversalScheme::AverageStrategy;
+  size_t &depth = traversal.depth;
+  float &result = traversal.result;
+  while (true) {
+    Frame &frame = traversal.frames[depth];
+    switch (frame.stage) {
+      case Stage::Enter: {
+        ++nodesTouched;
+        const std::string &type = frame.game.getType();
+
+        if ("terminal" == type) {
+          CFR_PROFILE_PHASE(m_profiler, Phase::Showdown);
+          result = frame.game.getUtility(traversal.updatePlayer);
+          break;
+        }
+        if ("chance" == type) {
+          //sample one chance outcome at each chance node
+          frame.stage = Stage::PassThrough;
+          descend(traversal, depth++, GameType::Action::None, frame.probCounterFactual, frame.probUpdatePlayer, frame.probSample);
+          continue;
+        }
+        if ("action" != type) {
+          throw GameStageViolation("did not match a game type in CFR traversal");
+        }
+
+        //Decision Node, batched traversals hand the lookup back to the caller
+        frame.updating = traversal.updatePlayer == frame.game.getCurrentPlayer();
+        frame.stage = Stage::AwaitNode;
+        if constexpr (Batched) {
+          return false;
+        } else {
+          const std::string &infoSet = [&]() -> const std::string & {
+            CFR_PROFILE_PHASE(m_profiler, Phase::InfoSet);
+            return frame.game.getInfoSet(frame.game.getCurrentPlayer());
+          }();
+          attachNode(frame, infoSet, [&] {
+            CFR_PROFILE_STORAGE(m_profiler, storageGets);
+            return m_storage->getNode(infoSet);
+          }());
+          continue;
+        }
+      }
 
-    const std::vector<float> currentStrategy = node->getStrategy();
-    std::vector<float> counterfactualValue(actionNum);
-    if (updatePlayer == game.getCurrentPlayer()) {
-      for (int i = 0; i < actionNum; ++i) {
-        GameType gamePlusOneAction(game); // copy current gamestate
-        gamePlusOneAction.transition(actions[i]); // go one level deeper with action i
-        counterfactualValue[i] = ExternalSamplingCFR(gamePlusOneAction, updatePlayer, probCounterFactual, probUpdatePlayer * currentStrategy[i]);
-        nodeValue += currentStrategy[i] * counterfactualValue[i];
+      case Stage::AwaitNode: {
+        const auto &actions = frame.game.getActions();
+        {
+          CFR_PROFILE_PHASE(m_profiler, Phase::Regret);
+          const std::vector<float> &nodeStrategy = frame.node->getStrategy();
+          frame.strategy.assign(nodeStrategy.begin(), nodeStrategy.end());
+        }
+
+        if (SampleOpponent && !frame.updating) {
+          //sample single player action for non update player
+          const size_t sampledAction = Random::sampleCategorical(std::span<const float>(frame.strategy), rng);
+          frame.stage = Stage::PassThrough;
+          descend(traversal, depth++, actions[sampledAction], frame.probCounterFactual, frame.probUpdatePlayer, frame.probSample);
+          continue;
+        }
+        if constexpr (SampleOutcome) {
+          //sample single update player action, mixing in uniform exploration so every action keeps being tried
+          const float explore = Sampling::Exploration / static_cast<float>(actions.size());
+          frame.sampleProbs.resize(actions.size());
+          for (size_t i = 0; i < actions.size(); ++i) {
+            frame.sampleProbs[i] = explore + (1.f - Sampling::Exploration) * frame.strategy[i];
+          }
+          const size_t sampledAction = Random::sampleCategorical(std::span<const float>(frame.sampleProbs), rng);
+          frame.nextAction = static_cast<uint8_t>(sampledAction);
+          frame.stage = Stage::Sampled;
+          descend(traversal, depth++, actions[sampledAction], frame.probCounterFactual,
+                  frame.probUpdatePlayer * frame.strategy[sampledAction], frame.probSample * frame.sampleProbs[sampledAction]);
+          continue;
+        }
+        if constexpr (SampleAverage) {
+          //walk each update player action independently, favouring those the average strategy plays
+          const std::vector<float> &strategySum = frame.node->getStrategySum();
+          float total = 0.f;
+          for (size_t i = 0; i < actions.size(); ++i) {
+            total += strategySum[i];
+          }
+          frame.sampleProbs.resize(actions.size());
+          for (size_t i = 0; i < actions.size(); ++i) {
+            const float prob = std::min(1.f, std::max(Sampling::Exploration, (Sampling::Bonus + Sampling::Threshold * strategySum[i]) / (Sampling::Bonus + total)));
+            frame.sampleProbs[i] = Random::uniformFloat(rng) < prob ? prob : 0.f;
+          }
+        }
+        frame.stage = Stage::Enumerate;
+        frame.nextAction = 0;
+        frame.value = 0.f;
+        frame.counterfactualValues.resize(actions.size());
+        if (m_prefetch) {
+          prefetchChildren(frame.game);
+        }
+        continue;
       }
 
-      for (int i = 0; i < actionNum; ++i) {
-        const float regret = counterfactualValue[i] - nodeValue;
-        node->updateRegretSum(i, regret, probCounterFactual);
+      case Stage::Enumerate: {
+        /// get counterfactual value and node value from each child and the probability we reach them
+        if (frame.nextAction > 0) {
+          const size_t i = frame.nextAction - 1;
+          const float actionValue = SampleAverage && frame.updating ? result / frame.sampleProbs[i] : result;
+          frame.counterfactualValues[i] = actionValue;
+          frame.value += frame.strategy[i] * actionValue;
+        }
+        const auto &actions = frame.game.getActions();
+        if constexpr (SampleAverage) {
+          // actions this visit skipped estimate a counterfactual value of zero
+          while (frame.updating && frame.nextAction < actions.size() && frame.sampleProbs[frame.nextAction] == 0.f) {
+            frame.counterfactualValues[frame.nextAction++] = 0.f;
+          }
+        }
+        if (frame.nextAction < actions.size()) {
+          const size_t i = frame.nextAction++;
+          if (frame.updating) {
+            const float probSample = SampleAverage ? frame.probSample * frame.sampleProbs[i] : frame.probSample;
+            descend(traversal, depth++, actions[i], frame.probCounterFactual, frame.probUpdatePlayer * frame.strategy[i], probSample);
+          } else {
+            descend(traversal, depth++, actions[i], frame.probCounterFactual * frame.strategy[i], frame.probUpdatePlayer, frame.probSample);
+          }
+          continue;
+        }
+
+        /// do regret calculation and matching based on the node value only for update player
+        if (frame.updating) {
+          updateNode(frame);
+        }
+        result = frame.value;
+        break;
       }
-      node->updateStrategySum(currentStrategy, probUpdatePlayer);
 
-      node->calcUpdatedStrategy();
+      case Stage::Sampled: {
+        // only the sampled action has an estimate, the others count as zero
+        const size_t sampledAction = frame.nextAction;
+        const float actionValue = result / frame.sampleProbs[sampledAction];
+        frame.counterfactualValues.assign(frame.game.getActions().size(), 0.f);
+        frame.counterfactualValues[sampledAction] = actionValue;
+        frame.value = frame.strategy[sampledAction] * actionValue;
+        updateNode(frame);
+        result = frame.value;
+        break;
+      }
 
+      case Stage::PassThrough:
+        // chance and sampled opponent nodes return their only child's value unchanged
+        break;
+    }
 
-    } else { //sample single player action for non update player
-      GameType gamePlusOneAction(game);
-      std::discrete_distribution actionSpread(currentStrategy.begin(),currentStrategy.end());
-      auto sampledAction = actionSpread(rng);
-      gamePlusOneAction.transition(actions[sampledAction]);
-      nodeValue = ExternalSamplingCFR(gamePlusOneAction, updatePlayer, probCounterFactual, probUpdatePlayer);
+    frame.node.reset();
+    if (depth == 0) {
+      return true;
     }
-    return nodeValue;
+    --depth;
   }
-  throw GameStageViolation("did not match a game type in ExternalSamplingCFR");
 }
-template <typename GameType, typename StorageType>
-auto RegretMinimizer<GameType, StorageType>::getNodeInformation(const std::string& index) noexcept -> std::vector<std::vector<float>>{
+
+template<typename GameType, typename StorageType, typename Sampling>
+auto RegretMinimizer<GameType, StorageType, Sampling>::getNodeInformation(const std::string& index) noexcept -> std::vector<std::vector<float>>{
   std::vector<std::vector<float>> res;
   auto node = m_storage->getNode(index);
   if (node) {
     res.push_back(node->getRegretSum());
     res.push_back(node->getStrategy());
-    node->calcAverageStrategy();
-    res.push_back(node->getAverageStrategy());
+    // computed on the side, the node may be shared with a training thread
+    res.push_back(node->averageStrategyOf());
   }
   return res;
 }
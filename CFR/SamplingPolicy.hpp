@@ -0,0 +1,44 @@
+#ifndef SAMPLINGPOLICY_HPP
+#define SAMPLINGPOLICY_HPP
+
+#include <cstdint>
+
+namespace CFR {
+
+/// @brief Which of the update player's actions a sampled traversal walks
+enum class TraversalScheme : uint8_t {
+    /// @brief Every action of the update player, one action of the opponent and one chance outcome
+    External,
+    /// @brief One action of the update player too, a single trajectory per deal
+    Outcome,
+    /// @brief Each action of the update player independently, the more likely the more average strategy it holds
+    AverageStrategy,
+};
+
+/// @brief External sampling MCCFR, what RegretMinimizer::Train has always done
+struct ExternalSampling {
+    static constexpr TraversalScheme Scheme = TraversalScheme::External;
+};
+
+/// @brief Outcome sampling MCCFR (Lanctot et al. 2009)
+/// @details The update player draws its action from Exploration / |A| + (1 - Exploration) * strategy and the value it
+/// gets back is divided by that probability, so the regret estimates stay unbiased while one deal costs one path.
+struct OutcomeSampling {
+    static constexpr TraversalScheme Scheme = TraversalScheme::Outcome;
+    static constexpr float Exploration = 0.6f;
+};
+
+/// @brief Average strategy sampling MCCFR (Gibson et al. 2012)
+/// @details Each update player action is walked with probability max(Exploration, (Bonus + Threshold * s(a)) / (Bonus
+/// + sum of s)), s being the node's strategy sum, and its value divided by that probability. Early on the bonus walks
+/// nearly everything, later the actions the average strategy has given up on are mostly skipped.
+struct AverageStrategySampling {
+    static constexpr TraversalScheme Scheme = TraversalScheme::AverageStrategy;
+    static constexpr float Exploration = 0.05f;
+    static constexpr float Threshold = 1000.f;
+    static constexpr float Bonus = 1e6f;
+};
+
+} // namespace CFR
+
+#endif //SAMPLINGPOLICY_HPP
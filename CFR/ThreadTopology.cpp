@@ -0,0 +1,149 @@
+#include "ThreadTopology.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <thread>
+#include <tuple>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace CFR {
+namespace {
+
+const std::string SysCpu = "/sys/devices/system/cpu";
+const std::string SysNode = "/sys/devices/system/node";
+
+std::optional<uint32_t> readId(const std::string& path) {
+    std::ifstream file(path);
+    long value = -1;
+    if (!(file >> value) || value < 0) {
+        return std::nullopt;
+    }
+    return static_cast<uint32_t>(value);
+}
+
+std::string readLine(const std::string& path) {
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);
+    return line;
+}
+
+} // namespace
+
+CpuTopology::CpuTopology(std::vector<LogicalCpu> cpus) : m_cpus(std::move(cpus)) {
+    std::ranges::sort(m_cpus, {}, &LogicalCpu::id);
+}
+
+CpuTopology CpuTopology::detect() {
+    std::vector<LogicalCpu> cpus;
+    for (const uint32_t id : parseCpuList(readLine(SysCpu + "/online"))) {
+        const std::string topology = SysCpu + "/cpu" + std::to_string(id) + "/topology/";
+        LogicalCpu cpu;
+        cpu.id = id;
+        cpu.core = readId(topology + "core_id").value_or(id);
+        cpu.package = readId(topology + "physical_package_id").value_or(0);
+        cpus.push_back(cpu);
+    }
+
+    if (cpus.empty()) {
+        const uint32_t count = std::max(1u, std::thread::hardware_concurrency());
+        for (uint32_t id = 0; id < count; ++id) {
+            cpus.push_back({id, id, 0, 0});
+        }
+        return CpuTopology(std::move(cpus));
+    }
+
+    // NUMA nodes list their CPUs, machines without NUMA support have no node directory and stay on node 0
+    for (const uint32_t node : parseCpuList(readLine(SysNode + "/online"))) {
+        for (const uint32_t id : parseCpuList(readLine(SysNode + "/node" + std::to_string(node) + "/cpulist"))) {
+            const auto it = std::ranges::find(cpus, id, &LogicalCpu::id);
+            if (it != cpus.end()) {
+                it->numaNode = node;
+            }
+        }
+    }
+    return CpuTopology(std::move(cpus));
+}
+
+std::vector<uint32_t> CpuTopology::placementOrder() const {
+    // Rank each CPU among the SMT siblings of its core, in id order
+    std::map<std::pair<uint32_t, uint32_t>, uint32_t> siblingsSeen;
+    std::vector<std::pair<uint32_t, const LogicalCpu*>> ranked;
+    ranked.reserve(m_cpus.size());
+    for (const LogicalCpu& cpu : m_cpus) {
+        ranked.emplace_back(siblingsSeen[{cpu.package, cpu.core}]++, &cpu);
+    }
+
+    std::ranges::sort(ranked, [](const auto& a, const auto& b) {
+        return std::tie(a.first, a.second->numaNode, a.second->package, a.second->core, a.second->id) <
+               std::tie(b.first, b.second->numaNode, b.second->package, b.second->core, b.second->id);
+    });
+
+    std::vector<uint32_t> order;
+    order.reserve(ranked.size());
+    for (const auto& [rank, cpu] : ranked) {
+        order.push_back(cpu->id);
+    }
+    return order;
+}
+
+uint32_t CpuTopology::numaNodes() const {
+    uint32_t highest = 0;
+    for (const LogicalCpu& cpu : m_cpus) {
+        highest = std::max(highest, cpu.numaNode);
+    }
+    return highest + 1;
+}
+
+std::vector<uint32_t> CpuTopology::parseCpuList(const std::string& list) {
+    std::vector<uint32_t> ids;
+    std::stringstream stream(list);
+    std::string part;
+    while (std::getline(stream, part, ',')) {
+        if (part.empty()) {
+            continue;
+        }
+        try {
+            const size_t dash = part.find('-');
+            const auto first = static_cast<uint32_t>(std::stoul(part.substr(0, dash)));
+            const auto last = dash == std::string::npos ? first : static_cast<uint32_t>(std::stoul(part.substr(dash + 1)));
+            for (uint32_t id = first; id <= last; ++id) {
+                ids.push_back(id);
+            }
+        } catch (const std::exception&) {
+            return {};
+        }
+    }
+    return ids;
+}
+
+bool pinCurrentThread(uint32_t cpu) {
+#ifdef __linux__
+    if (cpu >= CPU_SETSIZE) {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+uint64_t threadSeed(uint64_t masterSeed, uint32_t threadIndex) {
+    uint64_t z = masterSeed + (static_cast<uint64_t>(threadIndex) + 1) * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+} // namespace CFR
@@ -0,0 +1,52 @@
+#ifndef THREADTOPOLOGY_HPP
+#define THREADTOPOLOGY_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace CFR {
+
+/// @brief One logical CPU as the kernel reports it
+struct LogicalCpu {
+    uint32_t id = 0;
+    /// @brief Physical core, shared by SMT siblings within a package
+    uint32_t core = 0;
+    uint32_t package = 0;
+    uint32_t numaNode = 0;
+};
+
+/// @brief Logical CPU layout used to place trainer threads
+class CpuTopology {
+public:
+    explicit CpuTopology(std::vector<LogicalCpu> cpus);
+
+    /// @brief Read the layout from /sys, one core per logical CPU on one node when that is unavailable
+    [[nodiscard]] static CpuTopology detect();
+
+    /// @brief Logical CPU ids in the order threads should be placed on them
+    /// @details The first SMT sibling of every core comes before any second sibling so threads get whole cores while
+    /// they last. Within each sibling rank CPUs are grouped by NUMA node, then package and core, so a run that does not
+    /// fill the machine stays on as few nodes as possible.
+    [[nodiscard]] std::vector<uint32_t> placementOrder() const;
+
+    [[nodiscard]] const std::vector<LogicalCpu>& cpus() const { return m_cpus; }
+    [[nodiscard]] uint32_t numaNodes() const;
+
+    /// @brief Parse a kernel cpu list such as "0-3,8-11"
+    [[nodiscard]] static std::vector<uint32_t> parseCpuList(const std::string& list);
+
+private:
+    std::vector<LogicalCpu> m_cpus;
+};
+
+/// @brief Pin the calling thread to one logical CPU
+/// @return false if the platform does not support pinning or the kernel refused it
+bool pinCurrentThread(uint32_t cpu);
+
+/// @brief Seed for worker threadIndex derived from one master seed (SplitMix64), so a run can be reproduced from the master
+[[nodiscard]] uint64_t threadSeed(uint64_t masterSeed, uint32_t threadIndex);
+
+} // namespace CFR
+
+#endif //THREADTOPOLOGY_HPP
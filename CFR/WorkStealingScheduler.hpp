@@ -0,0 +1,161 @@
+#ifndef WORKSTEALINGSCHEDULER_HPP
+#define WORKSTEALINGSCHEDULER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace CFR {
+
+/// @brief Hands out training iterations to worker threads from per-worker deques of iteration ranges
+/// @details Each worker starts with an equal contiguous share of the run. Owners take grains from the front of their
+/// own deque, idle workers steal the back half of another worker's remaining range. Grains shrink as the run drains so
+/// the last iterations are spread over every worker instead of sitting in one large batch.
+class WorkStealingScheduler {
+public:
+    /// @brief Half open range [begin, end) of iteration indices
+    struct Range {
+        uint64_t begin;
+        uint64_t end;
+
+        [[nodiscard]] uint64_t size() const { return end - begin; }
+    };
+
+    /// @param numWorkers Number of worker deques
+    /// @param maxGrain Largest number of iterations handed out at once
+    explicit WorkStealingScheduler(uint32_t numWorkers, uint32_t maxGrain = 1024)
+        : m_maxGrain(maxGrain) {
+        if (numWorkers == 0 || maxGrain == 0) {
+            throw std::invalid_argument("Scheduler needs at least one worker and a grain of at least one iteration");
+        }
+        m_queues.reserve(numWorkers);
+        for (uint32_t i = 0; i < numWorkers; ++i) {
+            m_queues.push_back(std::make_unique<WorkerQueue>());
+        }
+    }
+
+    /// @brief Start a run of exactly totalIterations, split evenly with the remainder going to the first workers
+    void reset(uint64_t totalIterations) {
+        const uint64_t workers = m_queues.size();
+        uint64_t begin = 0;
+        for (uint64_t i = 0; i < workers; ++i) {
+            const uint64_t share = totalIterations / workers + (i < totalIterations % workers ? 1 : 0);
+            std::lock_guard lock(m_queues[i]->mutex);
+            m_queues[i]->ranges.clear();
+            if (share > 0) {
+                m_queues[i]->ranges.push_back({begin, begin + share});
+            }
+            begin += share;
+        }
+        m_remaining.store(totalIterations, std::memory_order_release);
+        m_steals.store(0, std::memory_order_relaxed);
+    }
+
+    /// @brief Claim the next grain for a worker, stealing if its own deque is empty
+    /// @return Claimed range, empty once every iteration of the run has been handed out
+    Range next(uint32_t worker) {
+        while (m_remaining.load(std::memory_order_acquire) > 0) {
+            if (const Range range = popFront(worker); range.size() > 0) {
+                return range;
+            }
+            if (!steal(worker)) {
+                // the last ranges are in flight between a victim and its thief, let that finish before retrying
+                std::this_thread::yield();
+            }
+        }
+        return {0, 0};
+    }
+
+    /// @brief Drop all unclaimed iterations, workers see an empty range on their next call
+    void cancel() {
+        for (auto& queue : m_queues) {
+            std::lock_guard lock(queue->mutex);
+            uint64_t dropped = 0;
+            for (const Range& range : queue->ranges) {
+                dropped += range.size();
+            }
+            queue->ranges.clear();
+            m_remaining.fetch_sub(dropped, std::memory_order_acq_rel);
+        }
+    }
+
+    /// @brief Iterations not yet handed out
+    [[nodiscard]] uint64_t remaining() const { return m_remaining.load(std::memory_order_acquire); }
+
+    /// @brief Successful steals since the last reset
+    [[nodiscard]] uint64_t steals() const { return m_steals.load(std::memory_order_relaxed); }
+
+    [[nodiscard]] uint32_t numWorkers() const { return static_cast<uint32_t>(m_queues.size()); }
+
+private:
+    struct alignas(64) WorkerQueue {
+        std::mutex mutex;
+        std::deque<Range> ranges;
+    };
+
+    /// @brief Grain size shrinks with the work left so each worker gets several grains from what remains
+    [[nodiscard]] uint64_t grain() const {
+        const uint64_t left = m_remaining.load(std::memory_order_relaxed);
+        return std::clamp<uint64_t>(left / (4 * m_queues.size()), 1, m_maxGrain);
+    }
+
+    Range popFront(uint32_t worker) {
+        WorkerQueue& queue = *m_queues[worker];
+        std::lock_guard lock(queue.mutex);
+        if (queue.ranges.empty()) {
+            return {0, 0};
+        }
+        Range& front = queue.ranges.front();
+        const Range taken{front.begin, front.begin + std::min(grain(), front.size())};
+        front.begin = taken.end;
+        if (front.size() == 0) {
+            queue.ranges.pop_front();
+        }
+        m_remaining.fetch_sub(taken.size(), std::memory_order_acq_rel);
+        return taken;
+    }
+
+    /// @brief Move the back half of the first non-empty victim's last range into the thief's deque
+    bool steal(uint32_t thief) {
+        const auto workers = static_cast<uint32_t>(m_queues.size());
+        for (uint32_t offset = 1; offset < workers; ++offset) {
+            WorkerQueue& victim = *m_queues[(thief + offset) % workers];
+            Range stolen{0, 0};
+            {
+                std::lock_guard lock(victim.mutex);
+                if (victim.ranges.empty()) {
+                    continue;
+                }
+                Range& back = victim.ranges.back();
+                const uint64_t half = (back.size() + 1) / 2;
+                stolen = {back.end - half, back.end};
+                back.end = stolen.begin;
+                if (back.size() == 0) {
+                    victim.ranges.pop_back();
+                }
+            }
+            {
+                std::lock_guard lock(m_queues[thief]->mutex);
+                m_queues[thief]->ranges.push_back(stolen);
+            }
+            m_steals.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+    uint64_t m_maxGrain;
+    std::atomic<uint64_t> m_remaining{0};
+    std::atomic<uint64_t> m_steals{0};
+};
+
+} // namespace CFR
+
+#endif //WORKSTEALINGSCHEDULER_HPP
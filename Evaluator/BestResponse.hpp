@@ -0,0 +1,384 @@
+#ifndef BEST_RESPONSE_HPP
+#define BEST_RESPONSE_HPP
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../CFR/PublicTree.hpp"
+#include "../Game/Utility/HandAbstraction/hand_index.h"
+#include "../Storage/NodeStorage.hpp"
+
+/// @brief How far a strategy is from an equilibrium, utilities are in milli big blinds per hand
+struct BestResponseResult {
+    /// @brief What a best response earns in each seat against the strategy playing the other seat
+    std::array<double, 2> bestResponseMbb{};
+    /// @brief Mean of the two best response values, 0 exactly at an equilibrium
+    double exploitabilityMbb = 0;
+    /// @brief First public deals walked, canonical boards when exact and one per isomorphism class drawn when sampled
+    uint64_t boards = 0;
+    /// @brief False when the first public deal was sampled, the values are then estimates
+    bool exact = true;
+    double seconds = 0;
+};
+
+/// @brief How a BestResponse splits and deals its boards
+struct BestResponseOptions {
+    uint32_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    /// @brief Walk this many random first public deals (the Preflop board, the Texas flop) instead of all of them, 0 is exact
+    uint64_t boardSamples = 0;
+    /// @brief Seed of the board sample
+    uint64_t seed = 0;
+    /// @brief Respond to the average strategy CFR converges to, false for the current regret matching strategy
+    bool averageStrategy = true;
+};
+
+/// @brief Best response to a strategy held in any NodeStorage, and with it the strategy's exploitability
+/// @details The PublicTree is walked once per seat with a vector holding the opponent's reach for every one of the 1326
+/// hole card pairs, so one walk answers every private hand. Showdowns sort the hands by strength and sweep them, with
+/// per card sums removing the hands that share a card. The first public deal is split across the worker threads and
+/// only one board of each suit isomorphism class is walked, since the info set indices are suit canonical.
+/// Preflop takes minutes on a many core machine. Texas is exact too but walks every turn and river of each flop, so it
+/// is normally sampled over flops. The strategy is read concurrently from every worker, see Evaluator.
+template <typename GameType>
+class BestResponse
+{
+public:
+    explicit BestResponse(BestResponseOptions options = {});
+
+    /// @brief Best response values of both seats against strategy
+    BestResponseResult compute(CFR::NodeStorage& strategy) const;
+
+private:
+    using Tree = CFR::PublicTree<GameType>;
+    using PublicNode = typename Tree::PublicNode;
+    using Board = typename Tree::Board;
+    using Range = typename Tree::Range;
+
+    static constexpr uint32_t HandCount = Tree::HandCount;
+    static constexpr size_t Rounds = Tree::Rounds;
+    static constexpr uint8_t BoardCards = Tree::BoardCards;
+
+    /// @brief Board dealt so far with every hand's indexer state and info set index for each round
+    struct Deal {
+        std::array<uint8_t, BoardCards> board{};
+        uint8_t boardSize = 0;
+        uint64_t mask = 0;
+        std::array<std::vector<hand_indexer_state_t>, Rounds> states;
+        std::array<std::vector<hand_index_t>, Rounds> indices;
+        /// @brief Hand values once the board is complete, and the live hands sorted by them
+        std::vector<int> strength;
+        std::vector<uint16_t> byStrength;
+    };
+
+    struct Walker {
+        Walker(CFR::NodeStorage& strategy, Deal deal) : strategy(strategy), deal(std::move(deal)) {}
+
+        CFR::NodeStorage& strategy;
+        Deal deal;
+        std::string key;
+        /// @brief Values of the chance nodes closing the first round, set for the final walk from the root
+        const std::vector<std::array<Range, 2>>* firstDeals = nullptr;
+    };
+
+    [[nodiscard]] Deal makeDeal() const;
+    [[nodiscard]] bool live(uint32_t hand, const Deal& deal) const { return m_tree.live(hand, deal.mask); }
+
+    void dealCards(Deal& deal, uint8_t round, std::span<const uint8_t> cards) const;
+
+    /// @brief Strategy of the acting player at node for every hand with reach, hand major
+    void fillPolicy(Walker& walker, const PublicNode& node, const Range& reach, std::vector<float>& policy) const;
+
+    /// @brief Both players' reach at each chance node closing the first round
+    void collectReach(Walker& walker, uint32_t id, const std::array<Range, 2>& reach, std::vector<std::array<Range, 2>>& out) const;
+
+    /// @brief Value to seat responder of each of its hands below node id, weighted by the opponent reach opp
+    void walk(Walker& walker, uint32_t id, const Range& opp, int responder, Range& out) const;
+
+    BestResponseOptions m_options;
+    Tree m_tree;
+};
+
+template <typename GameType>
+BestResponse<GameType>::BestResponse(BestResponseOptions options) : m_options(options)
+{
+    if (m_options.numThreads == 0) {
+        throw std::invalid_argument("BestResponse needs at least one thread");
+    }
+}
+
+template <typename GameType>
+BestResponseResult BestResponse<GameType>::compute(CFR::NodeStorage& strategy) const
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    const std::vector<uint32_t>& firstDeals = m_tree.firstDeals();
+    std::vector<std::array<Range, 2>> reach(firstDeals.size());
+    {
+        Walker walker{strategy, makeDeal()};
+        collectReach(walker, m_tree.root(), {Range(HandCount, 1.0), Range(HandCount, 1.0)}, reach);
+    }
+
+    // every worker sums its boards' values for each first deal and seat
+    const std::vector<Board> boards = Tree::firstBoards(m_options.boardSamples, m_options.seed);
+    const auto workers = static_cast<uint32_t>(std::min<uint64_t>(m_options.numThreads, std::max<uint64_t>(boards.size(), 1)));
+    std::vector<std::vector<std::array<Range, 2>>> partials(workers);
+    std::atomic<size_t> next{0};
+    {
+        std::vector<std::jthread> threads;
+        threads.reserve(workers);
+        for (uint32_t w = 0; w < workers; ++w) {
+            threads.emplace_back([&, w] {
+                std::vector<std::array<Range, 2>>& values = partials[w];
+                values.assign(firstDeals.size(), {Range(HandCount, 0.0), Range(HandCount, 0.0)});
+                Walker walker{strategy, makeDeal()};
+                Range opp(HandCount);
+                Range out(HandCount);
+                for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < boards.size();) {
+                    const Board& board = boards[i];
+                    dealCards(walker.deal, 1, board.cards);
+                    for (size_t slot = 0; slot < firstDeals.size(); ++slot) {
+                        for (int responder = 0; responder < 2; ++responder) {
+                            const Range& before = reach[slot][1 - responder];
+                            for (uint32_t h = 0; h < HandCount; ++h) {
+                                opp[h] = live(h, walker.deal) ? before[h] : 0.0;
+                            }
+                            walk(walker, m_tree.node(firstDeals[slot]).children[0], opp, responder, out);
+                            Range& sum = values[slot][responder];
+                            for (uint32_t h = 0; h < HandCount; ++h) {
+                                sum[h] += board.weight * out[h];
+                            }
+                        }
+                    }
+                    walker.deal.boardSize = 0;
+                    walker.deal.mask = 0;
+                }
+            });
+        }
+    }
+
+    const Range classCoverage = m_tree.classCoverage(boards);
+    std::vector<std::array<Range, 2>> resolved(firstDeals.size());
+    for (size_t slot = 0; slot < firstDeals.size(); ++slot) {
+        for (int responder = 0; responder < 2; ++responder) {
+            Range total(HandCount, 0.0);
+            for (const auto& values : partials) {
+                for (uint32_t h = 0; h < HandCount; ++h) {
+                    total[h] += values[slot][responder][h];
+                }
+            }
+            m_tree.resolveFirstDeal(total, classCoverage, resolved[slot][responder]);
+        }
+    }
+
+    BestResponseResult result;
+    Walker walker{strategy, makeDeal()};
+    walker.firstDeals = &resolved;
+    Range out(HandCount);
+    for (int responder = 0; responder < 2; ++responder) {
+        walk(walker, m_tree.root(), Range(HandCount, 1.0), responder, out);
+        // each hand faces the 1225 hands that share no card with it
+        result.bestResponseMbb[responder] = std::accumulate(out.begin(), out.end(), 0.0) / (HandCount * Tree::choose(50, 2));
+    }
+    result.exploitabilityMbb = (result.bestResponseMbb[0] + result.bestResponseMbb[1]) / 2.0;
+    result.boards = boards.size();
+    result.exact = m_options.boardSamples == 0;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+template <typename GameType>
+auto BestResponse<GameType>::makeDeal() const -> Deal
+{
+    Deal deal;
+    deal.states[0] = m_tree.holeStates();
+    deal.indices[0] = m_tree.holeIndices();
+    for (size_t round = 1; round < Rounds; ++round) {
+        deal.states[round].resize(HandCount);
+        deal.indices[round].resize(HandCount);
+    }
+    deal.strength.resize(HandCount);
+    deal.byStrength.reserve(HandCount);
+    return deal;
+}
+
+template <typename GameType>
+void BestResponse<GameType>::dealCards(Deal& deal, uint8_t round, std::span<const uint8_t> cards) const
+{
+    for (const uint8_t card : cards) {
+        deal.board[deal.boardSize++] = card;
+        deal.mask |= uint64_t{1} << card;
+    }
+    const hand_indexer_t& indexer = GameType::Cards::indexer();
+    for (uint32_t h = 0; h < HandCount; ++h) {
+        if (live(h, deal)) {
+            deal.states[round][h] = deal.states[round - 1][h];
+            deal.indices[round][h] = hand_index_next_round(&indexer, cards.data(), &deal.states[round][h]);
+        }
+    }
+    if (deal.boardSize == BoardCards) {
+        m_tree.rankHands(deal.board, deal.mask, deal.strength, deal.byStrength);
+    }
+}
+
+template <typename GameType>
+void BestResponse<GameType>::fillPolicy(Walker& walker, const PublicNode& node, const Range& reach, std::vector<float>& policy) const
+{
+    const size_t actions = node.children.size();
+    policy.assign(HandCount * actions, 0.0f);
+    const std::vector<hand_index_t>& indices = walker.deal.indices[node.round];
+    for (uint32_t h = 0; h < HandCount; ++h) {
+        if (reach[h] <= 0) {
+            continue;
+        }
+        char digits[20];
+        const auto end = std::to_chars(digits, digits + sizeof(digits), indices[h]).ptr;
+        walker.key.assign(digits, end);
+        walker.key += node.history;
+
+        float* row = policy.data() + h * actions;
+        const auto stored = walker.strategy.getNode(walker.key);
+        // an info set the strategy never reached is played uniformly, as a fresh node would be
+        if (stored == nullptr) {
+            std::fill_n(row, actions, 1.0f / static_cast<float>(actions));
+            continue;
+        }
+        const std::vector<float>& source = m_options.averageStrategy ? stored->getStrategySum() : stored->getStrategy();
+        if (source.size() != actions) {
+            throw std::logic_error("Info set " + walker.key + " has " + std::to_string(source.size()) +
+                                   " actions, the game has " + std::to_string(actions));
+        }
+        const float sum = std::accumulate(source.begin(), source.end(), 0.0f);
+        for (size_t a = 0; a < actions; ++a) {
+            row[a] = sum > 0 ? source[a] / sum : 1.0f / static_cast<float>(actions);
+        }
+    }
+}
+
+template <typename GameType>
+void BestResponse<GameType>::collectReach(Walker& walker, uint32_t id, const std::array<Range, 2>& reach,
+                                          std::vector<std::array<Range, 2>>& out) const
+{
+    const PublicNode& node = m_tree.node(id);
+    if (PublicNode::Kind::Chance == node.kind) {
+        out[node.firstDeal] = reach;
+        return;
+    }
+    if (PublicNode::Kind::Action != node.kind) {
+        return;
+    }
+    std::vector<float> policy;
+    fillPolicy(walker, node, reach[node.player], policy);
+    const size_t actions = node.children.size();
+    for (size_t a = 0; a < actions; ++a) {
+        std::array<Range, 2> child = reach;
+        for (uint32_t h = 0; h < HandCount; ++h) {
+            child[node.player][h] *= policy[h * actions + a];
+        }
+        collectReach(walker, node.children[a], child, out);
+    }
+}
+
+template <typename GameType>
+void BestResponse<GameType>::walk(Walker& walker, uint32_t id, const Range& opp, int responder, Range& out) const
+{
+    const PublicNode& node = m_tree.node(id);
+    Deal& deal = walker.deal;
+    out.assign(HandCount, 0.0);
+    // nothing below is reached by the opponent
+    if (std::ranges::none_of(opp, [](double r) { return r > 0; })) {
+        return;
+    }
+
+    switch (node.kind) {
+    case PublicNode::Kind::Fold:
+        m_tree.foldValues(node, deal.mask, opp, responder, out);
+        return;
+    case PublicNode::Kind::Showdown:
+        if (deal.boardSize != BoardCards) {
+            throw std::logic_error("showdown before the board is complete");
+        }
+        m_tree.showdown(node, deal.byStrength, deal.strength, opp, responder, out);
+        return;
+    case PublicNode::Kind::Chance: {
+        if (node.firstDeal >= 0) {
+            if (walker.firstDeals == nullptr) {
+                throw std::logic_error("first deal values are not resolved yet");
+            }
+            out = (*walker.firstDeals)[node.firstDeal][responder];
+            return;
+        }
+        const auto round = static_cast<uint8_t>(node.round + 1);
+        const uint8_t dealt = GameType::cardsPerRound[round];
+        std::vector<uint8_t> remaining;
+        for (uint8_t card = 0; card < 52; ++card) {
+            if ((deal.mask & (uint64_t{1} << card)) == 0) {
+                remaining.push_back(card);
+            }
+        }
+        // every card the two players do not hold is equally likely
+        const double scale = 1.0 / Tree::choose(52 - 4 - deal.boardSize, dealt);
+        const uint8_t boardSize = deal.boardSize;
+        const uint64_t mask = deal.mask;
+        Range childOpp(HandCount);
+        Range childOut(HandCount);
+        Tree::forEachCombination(remaining, dealt, [&](std::span<const uint8_t> cards) {
+            dealCards(deal, round, cards);
+            for (uint32_t h = 0; h < HandCount; ++h) {
+                childOpp[h] = live(h, deal) ? opp[h] : 0.0;
+            }
+            walk(walker, node.children[0], childOpp, responder, childOut);
+            for (uint32_t h = 0; h < HandCount; ++h) {
+                out[h] += childOut[h];
+            }
+            deal.boardSize = boardSize;
+            deal.mask = mask;
+        });
+        for (double& value : out) {
+            value *= scale;
+        }
+        return;
+    }
+    case PublicNode::Kind::Action:
+        break;
+    }
+
+    const size_t actions = node.children.size();
+    Range childOut(HandCount);
+    if (node.player == responder) {
+        // the responder picks its best action for each hand
+        std::ranges::fill(out, -std::numeric_limits<double>::infinity());
+        for (const uint32_t child : node.children) {
+            walk(walker, child, opp, responder, childOut);
+            for (uint32_t h = 0; h < HandCount; ++h) {
+                out[h] = std::max(out[h], childOut[h]);
+            }
+        }
+        return;
+    }
+
+    std::vector<float> policy;
+    fillPolicy(walker, node, opp, policy);
+    Range childOpp(HandCount);
+    for (size_t a = 0; a < actions; ++a) {
+        for (uint32_t h = 0; h < HandCount; ++h) {
+            childOpp[h] = opp[h] * policy[h * actions + a];
+        }
+        walk(walker, node.children[a], childOpp, responder, childOut);
+        for (uint32_t h = 0; h < HandCount; ++h) {
+            out[h] += childOut[h];
+        }
+    }
+}
+
+#endif //BEST_RESPONSE_HPP
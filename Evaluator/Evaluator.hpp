@@ -4,82 +4,194 @@
 
 #ifndef EVALUATOR_HPP
 #define EVALUATOR_HPP
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
 #include <random>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
+#include "../Game/Utility/Random.hpp"
 #include "../Storage/NodeStorage.hpp"
+
+/// @brief Win rate of the first strategy against the second, utilities are in milli big blinds
+struct EvaluationResult {
+    uint64_t hands = 0;
+    double meanMbb = 0;
+    /// @brief Standard error of meanMbb, taken over mirrored pairs when those are used
+    double standardErrorMbb = 0;
+    double seconds = 0;
+    double handsPerSecond = 0;
+
+    /// @brief Half width of the confidence interval around meanMbb, 1.96 standard errors for 95%
+    [[nodiscard]] double confidenceMbb(double z = 1.96) const { return z * standardErrorMbb; }
+};
+
+/// @brief How an Evaluator splits and deals its hands
+struct EvaluatorOptions {
+    uint32_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    /// @brief Each worker's deal and action streams are derived from this, so a result can be reproduced
+    uint64_t seed = (static_cast<uint64_t>(std::random_device()()) << 32) | std::random_device()();
+    /// @brief Play every deal twice with the seats swapped and the same action draws, which cancels most card luck
+    bool mirrored = true;
+};
+
+/// @brief Plays two strategies against each other on every worker thread at once
+/// @details Strategies are read concurrently from every worker, so their storage must allow concurrent getNode calls
+/// (a MapNodeStorage that is not being modified, the sharded caches or a hybrid storage over one).
 template <typename GameType>
 class Evaluator
 {
 public:
-    Evaluator();
+    using Engine = typename GameType::Engine;
+
+    explicit Evaluator(EvaluatorOptions options = {});
+
+    /// @brief Play hands hands, rounded up to whole mirrored pairs
+    EvaluationResult evaluate(CFR::NodeStorage& strat1, CFR::NodeStorage& strat2, uint64_t hands);
+
+    /// @brief evaluate and print both win rates in bb/game
     void Evaluate(CFR::NodeStorage& strat1, CFR::NodeStorage& strat2, uint32_t iterations);
-    std::pair<float,float> playGame(GameType& game, CFR::NodeStorage& stratPlayer0, CFR::NodeStorage& stratPlayer1);
+
+    /// @brief Play one dealt game to the end, sampling actions from the current strategy of whoever is to act
+    /// @return utility of each seat
+    static std::pair<float,float> playGame(GameType& game, CFR::NodeStorage& stratPlayer0, CFR::NodeStorage& stratPlayer1, Engine& engine);
+
 private:
-    std::mt19937 generator;
-    std::array<float,2> utilitySums{};
-};
-template <typename GameType>
-Evaluator<GameType>::Evaluator() : generator(std::random_device()())
-{
+    /// @brief Sums over one worker's share of the sampling units, a mirrored pair or a single hand
+    struct Tally {
+        uint64_t units = 0;
+        uint64_t hands = 0;
+        double sum = 0;
+        double sumSquares = 0;
+    };
 
-}
+    Tally playShare(CFR::NodeStorage& strat1, CFR::NodeStorage& strat2, uint64_t units, uint32_t worker) const;
 
+    EvaluatorOptions m_options;
+};
 
 template <typename GameType>
-void Evaluator<GameType>::Evaluate(CFR::NodeStorage& strat1, CFR::NodeStorage& strat2, uint32_t iterations)
+Evaluator<GameType>::Evaluator(EvaluatorOptions options) : m_options(options)
 {
-    for (uint32_t i = 0; i < iterations; ++i)
-    {
-        generator();
-        GameType game(generator);
-        if (i % 2 == 0) {
-            auto utility = playGame(game,strat1,strat2);
-            utilitySums[0] += utility.first;
-            utilitySums[1] += utility.second;
-        } else {
-            auto utility = playGame(game,strat2,strat1);
-            utilitySums[0] += utility.second;
-            utilitySums[1] += utility.first;
-        }
+    if (m_options.numThreads == 0) {
+        throw std::invalid_argument("Evaluator needs at least one thread");
     }
-    std::cout << "Strat 1: "<< utilitySums[0]/(float)(1000*iterations) << "bb/game Strat 2: "<< utilitySums[1]/(float)(1000*iterations) <<"bb/game" <<std::endl;
 }
 
 template <typename GameType>
-std::pair<float,float> Evaluator<GameType>::playGame(GameType& game,CFR::NodeStorage& stratPlayer0,CFR::NodeStorage& stratPlayer1)
+EvaluationResult Evaluator<GameType>::evaluate(CFR::NodeStorage& strat1, CFR::NodeStorage& strat2, uint64_t hands)
 {
-    if ("chance" == game.getType())
+    const uint64_t units = m_options.mirrored ? (hands + 1) / 2 : hands;
+    const uint32_t workers = static_cast<uint32_t>(std::min<uint64_t>(m_options.numThreads, std::max<uint64_t>(units, 1)));
+    std::vector<Tally> tallies(workers);
+
+    const auto start = std::chrono::steady_clock::now();
     {
-        game.transition(GameType::Action::None);
-        return playGame(game,stratPlayer0,stratPlayer1);
+        std::vector<std::jthread> threads;
+        threads.reserve(workers);
+        for (uint32_t w = 0; w < workers; ++w) {
+            const uint64_t share = units / workers + (w < units % workers ? 1 : 0);
+            threads.emplace_back([&, w, share] { tallies[w] = playShare(strat1, strat2, share, w); });
+        }
     }
-    if ("terminal" == game.getType())
-    {
-        return {game.getUtility(0), game.getUtility(1)};
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    Tally total;
+    for (const Tally& tally : tallies) {
+        total.units += tally.units;
+        total.hands += tally.hands;
+        total.sum += tally.sum;
+        total.sumSquares += tally.sumSquares;
     }
 
-    //player action if we don't exit above
-    CFR::NodeStorage* strategy;
-    if (game.getCurrentPlayer() == 0) {
-        strategy = &stratPlayer0;
-    } else {
-        strategy = &stratPlayer1;
+    EvaluationResult result;
+    result.hands = total.hands;
+    result.seconds = seconds;
+    result.handsPerSecond = seconds > 0 ? static_cast<double>(total.hands) / seconds : 0;
+    if (total.units > 0) {
+        const auto n = static_cast<double>(total.units);
+        result.meanMbb = total.sum / n;
+        if (total.units > 1) {
+            const double variance = std::max(0.0, (total.sumSquares - n * result.meanMbb * result.meanMbb) / (n - 1));
+            result.standardErrorMbb = std::sqrt(variance / n);
+        }
     }
-    auto node = strategy->getNode(game.getInfoSet(game.getCurrentPlayer()));
-    std::vector<float> currentStrategy;
-    if (node == nullptr)
-    {
-        node = std::make_shared<CFR::Node>(game.getActions().size());
-        currentStrategy = node->getStrategy();
-    } else
-    {
-        currentStrategy = node->getStrategy();
+    return result;
+}
+
+template <typename GameType>
+auto Evaluator<GameType>::playShare(CFR::NodeStorage& strat1, CFR::NodeStorage& strat2, uint64_t units, uint32_t worker) const -> Tally
+{
+    // independent deal and action streams per worker
+    uint64_t stream = m_options.seed + static_cast<uint64_t>(worker) * 0x9E3779B97F4A7C15ull;
+    Engine dealEngine(Random::splitMix64(stream));
+    Engine actionEngine(Random::splitMix64(stream));
+
+    Tally tally;
+    GameType dealt(dealEngine);
+    GameType game = dealt;
+    for (uint64_t i = 0; i < units; ++i) {
+        double value;
+        if (m_options.mirrored) {
+            // same cards and the same action draws with the seats swapped
+            const Engine actionsAtDeal = actionEngine;
+            game = dealt;
+            const float seat0 = playGame(game, strat1, strat2, actionEngine).first;
+            game = dealt;
+            Engine mirror = actionsAtDeal;
+            const float seat1 = playGame(game, strat2, strat1, mirror).second;
+            value = (static_cast<double>(seat0) + seat1) / 2.0;
+            tally.hands += 2;
+        } else {
+            game = dealt;
+            value = (i % 2 == 0) ? playGame(game, strat1, strat2, actionEngine).first
+                                 : playGame(game, strat2, strat1, actionEngine).second;
+            tally.hands += 1;
+        }
+        tally.units += 1;
+        tally.sum += value;
+        tally.sumSquares += value * value;
+        dealt.reInitialize();
     }
+    return tally;
+}
 
-    std::discrete_distribution<int> actionSpread(currentStrategy.begin(),currentStrategy.end());
-    int actionChoice = actionSpread(generator);
-    game.transition(game.getActions()[actionChoice]);
-    return playGame(game,stratPlayer0,stratPlayer1);
+template <typename GameType>
+void Evaluator<GameType>::Evaluate(CFR::NodeStorage& strat1, CFR::NodeStorage& strat2, uint32_t iterations)
+{
+    const EvaluationResult result = evaluate(strat1, strat2, iterations);
+    std::cout << "Strat 1: " << result.meanMbb / 1000.0 << " +- " << result.confidenceMbb() / 1000.0
+              << "bb/game Strat 2: " << -result.meanMbb / 1000.0 << "bb/game (" << result.hands << " hands, "
+              << result.handsPerSecond << " hands/s)" << std::endl;
+}
+
+template <typename GameType>
+std::pair<float,float> Evaluator<GameType>::playGame(GameType& game, CFR::NodeStorage& stratPlayer0, CFR::NodeStorage& stratPlayer1, Engine& engine)
+{
+    while (true) {
+        const std::string& type = game.getType();
+        if ("terminal" == type) {
+            return {game.getUtility(0), game.getUtility(1)};
+        }
+        if ("chance" == type) {
+            game.transition(GameType::Action::None);
+            continue;
+        }
+
+        //player action if we don't exit above
+        CFR::NodeStorage& strategy = game.getCurrentPlayer() == 0 ? stratPlayer0 : stratPlayer1;
+        const auto& actions = game.getActions();
+        const auto node = strategy.getNode(game.getInfoSet(game.getCurrentPlayer()));
+        // an info set the strategy never reached is played uniformly, as a fresh node would be
+        const size_t actionChoice = node == nullptr
+            ? Random::uniformBelow(engine, static_cast<uint32_t>(actions.size()))
+            : Random::sampleCategorical(std::span<const float>(node->getStrategy()), engine);
+        game.transition(actions[actionChoice]);
+    }
 }
 
 #endif //EVALUATOR_HPP
@@ -105,12 +105,12 @@ void ActionStateNoBet::exit(Game &game, Game::Action action) {
 void ActionStateBet::enter(Game &game, Game::Action action) {
   using enum Preflop::GameBase::Action;
   if (Raise1 == action) {
-    game.setActions(std::vector<Game::Action>{Fold, Call, Reraise2});
+    game.setActions({Fold, Call, Reraise2});
   } else if (Reraise2 == action) {
     if (game.raiseNum >= Game::maxRaises) {
-      game.setActions(std::vector<Game::Action>{Fold, Call});
+      game.setActions({Fold, Call});
     } else {
-      game.setActions(std::vector<Game::Action>{Fold, Call, Reraise2});
+      game.setActions({Fold, Call, Reraise2});
     }
   }
 }
@@ -22,8 +22,11 @@ class Game : public GameBase {
   friend class PreflopTests_Game1_Test;
 
  public:
+  /// @brief hand indexer the info set card indices come from
+  using Cards = PreCards;
+
   ///Constructor
-  explicit Game(std::mt19937 &engine); // try another rng? boost or xorshift
+  explicit Game(Engine &engine);
 
   ///Modifier
   void transition(Action action);
@@ -34,10 +37,17 @@ class Game : public GameBase {
 
   /// Getters
   [[nodiscard]] inline GameState *getCurrentState() const noexcept{ return currentState; }
-  [[nodiscard]] std::vector<Action> getActions() const noexcept;
+  [[nodiscard]] const std::vector<Action>& getActions() const noexcept;
   [[nodiscard]] float getUtility(int payoffPlayer) const;
-  [[nodiscard]] std::string getInfoSet(int player) const noexcept;
-  [[nodiscard]] std::string getType() const noexcept;
+  /// @brief payoff of payoffPlayer at this terminal if winner (3 for a tie) took the pot
+  [[nodiscard]] float getPayoff(int payoffPlayer, int winner) const;
+
+  /// utils
+  /// @brief info set token of an action
+  static std::string actionToStr(Action action);
+
+  [[nodiscard]] const std::string& getInfoSet(int player) const noexcept;
+  [[nodiscard]] const std::string& getType() const noexcept;
   [[nodiscard]] int getCurrentPlayer() const noexcept;
   [[nodiscard]] float getAverageUtility() const noexcept;
   [[nodiscard]] int getPlayableCards(int index) const noexcept;
@@ -47,7 +57,8 @@ class Game : public GameBase {
   /// Setters
   void setType(std::string type);
   void setState(GameState &newState, Action action);
-  void setActions(std::vector <Action> actionVec);
+  /// @brief assigns in place so a game reused across iterations keeps its action buffer
+  void setActions(std::initializer_list<Action> actions);
 
   /// Modifiers
   void addMoney();
@@ -57,8 +68,6 @@ class Game : public GameBase {
   void updateInfoSet(Action action);
   void updateCurrentPlayer();
 
-  /// utils
-  static std::string actionToStr(Action action);
 
   /// Constants
   ///@brief how many unique deals are possible
@@ -78,8 +87,8 @@ class Game : public GameBase {
   /// @brief number of raises + reraises played this round
   uint8_t raiseNum{};
 
-  ///@brief rng engine, mersienne twister
-  std::mt19937 &RNG;
+  ///@brief rng engine, shared with the owning minimizer
+  Engine *RNG;
 
   int winner = -1;
 
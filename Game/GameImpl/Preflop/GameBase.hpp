@@ -7,6 +7,8 @@
 #include <cstdint>
 #include <array>
 
+#include "../../Utility/Random.hpp"
+
 namespace Preflop {
 class GameBase {
 protected:
@@ -16,9 +18,14 @@ protected:
 
   [[nodiscard]] int getCurrentPlayer() const { return currentPlayer; }
   /// constants
+  /// @brief random engine used for dealing, chance and opponent sampling
+  using Engine = Random::DefaultEngine;
+
   static constexpr uint8_t PlayerNum = 2;
   static constexpr uint8_t DeckCardNum = 52;
   static constexpr uint8_t maxRaises = 1;
+  /// @brief cards dealt each round, the hole cards then the whole board at once
+  static constexpr std::array<uint8_t, 2> cardsPerRound{2, 5};
 
   static constexpr std::array<uint8_t,DeckCardNum> rangeDeck = [] {
     std::array<uint8_t, DeckCardNum> deck{};
@@ -3,6 +3,7 @@
 //
 
 #include "PreCards.hpp"
+#include "../GameBase.hpp"
 
 namespace Preflop {
 hand_indexer_t PreCards::flopIndexer;
@@ -32,10 +33,14 @@ void PreCards::initIndices(std::span<uint8_t, 9> cards) {
 
 }
 
+const hand_indexer_t& PreCards::indexer() {
+  indexerInit();
+  return flopIndexer;
+}
+
 void PreCards::indexerInit() {
   if (!init) {
-    constexpr uint8_t cardsperround[]{2, 5};
-    hand_indexer_init(2, cardsperround, &flopIndexer);
+    hand_indexer_init(GameBase::cardsPerRound.size(), GameBase::cardsPerRound.data(), &flopIndexer);
     init = true;
   }
 }
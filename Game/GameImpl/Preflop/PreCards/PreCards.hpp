@@ -20,6 +20,8 @@ class PreCards {
 
   std::array<uint64_t, 4> playerIndices{};
   static hand_indexer_t flopIndexer;
+  /// @brief flopIndexer, initialised on first use
+  static const hand_indexer_t& indexer();
  private:
 
   static inline bool init = false;
@@ -101,12 +101,12 @@ namespace Texas {
 
     void ActionStateBet::enter(Game &game, Game::Action action) {
         if (Game::Action::Raise1 == action) {
-            game.setActions(std::vector<Game::Action>{Game::Action::Fold, Game::Action::Call, Game::Action::Reraise2});
+            game.setActions({Game::Action::Fold, Game::Action::Call, Game::Action::Reraise2});
         } else if (Game::Action::Reraise2 == action) {
             if (game.raiseNum >= Game::maxRaises) {
-                game.setActions(std::vector<Game::Action>{Game::Action::Fold, Game::Action::Call});
+                game.setActions({Game::Action::Fold, Game::Action::Call});
             } else {
-                game.setActions(std::vector<Game::Action>{Game::Action::Fold, Game::Action::Call, Game::Action::Reraise2});
+                game.setActions({Game::Action::Fold, Game::Action::Call, Game::Action::Reraise2});
             }
         }
     }
@@ -4,6 +4,7 @@
 
 #include "GameBase.hpp"
 #include "ConcreteGameStates.hpp"
+#include <charconv>
 #include <utility>
 #include <unordered_map>
 #include <stdexcept>
@@ -13,11 +14,12 @@
 #include <format>
 
 namespace Texas {
-Game::Game(std::mt19937 &engine) : RNG(engine)
+Game::Game(Engine &engine) : RNG(&engine)
 {
 
   std::array<uint8_t,DeckCardNum> temp = baseDeck;
-  std::ranges::shuffle(temp.begin(),temp.end(),RNG);
+  // only the dealt cards need to be uniformly drawn, the rest of the deck is never looked at
+  Random::partialShuffle(std::span<uint8_t>(temp), 2*PlayerNum+5, *RNG);
   std::copy(temp.begin(),temp.begin()+2*PlayerNum+5, playableCards.begin());
 
   addMoney();
@@ -36,7 +38,7 @@ void Game::setState(GameState &newState, Action action) {
 }
 
 void Game::transition(Action action) {
-  auto Actions = getActions();
+  const auto& Actions = getActions();
   assert(std::find(Actions.begin(),Actions.end(),action)!=Actions.end());
   currentState->transition(*this, action);
 }
@@ -52,16 +54,20 @@ void Game::addMoney(float amount) {
   utilities[2] += amount;
 }
 
-std::vector<GameBase::Action> Game::getActions() const noexcept{
+const std::vector<GameBase::Action>& Game::getActions() const noexcept{
   return availActions;
 }
 
-void Game::setActions(std::vector<GameBase::Action> actionVec) {
-  availActions = std::move(actionVec);
+void Game::setActions(std::initializer_list<GameBase::Action> actions) {
+  availActions.assign(actions);
 }
 
 float Game::getUtility(int payoffPlayer) const {
   assert(-1 != winner);
+  return getPayoff(payoffPlayer, winner);
+}
+
+float Game::getPayoff(int payoffPlayer, int winner) const {
   if (3 == winner) {
     return utilities[2] / 2.f + utilities[payoffPlayer];
   } else if (payoffPlayer == winner) {
@@ -84,11 +90,14 @@ void Game::updateInfoSet() {
     while (i < infoSet[j].length() && std::isdigit(infoSet[j][i])) {
       ++i;
     }
-    infoSet[j] = infoSet[j] = std::format("{}{}", cards.playerIndices[currentRound + (4 * j)], infoSet[j].substr(i));
+    // swap the card index prefix in place, the info set string keeps its capacity
+    char digits[20];
+    const auto end = std::to_chars(digits, digits + sizeof(digits), cards.playerIndices[currentRound + (4 * j)]).ptr;
+    infoSet[j].replace(0, i, digits, end - digits);
   }
 }
 
-std::string Game::getInfoSet(int player) const noexcept {
+const std::string& Game::getInfoSet(int player) const noexcept {
   return infoSet[player];
 }
 
@@ -122,21 +131,22 @@ void Game::setType(std::string type1) {
   type = std::move(type1);
 }
 
-std::string Game::getType() const noexcept{
+const std::string& Game::getType() const noexcept{
   return type;
 }
 
 void Game::reInitialize() {
-  RNG();
   currentPlayer = 0;
   raiseNum = 0;
   for (int i = 0; i < PlayerNum; ++i) {
     infoSet[i] = "";
-    utilities[i] = 0;
   }
+  // blinds and pot as a fresh deal has them, the previous hand's pot must not carry over
+  addMoney();
 
   std::array<uint8_t,DeckCardNum> temp = baseDeck;
-  std::ranges::shuffle(temp.begin(),temp.end(),RNG);
+  // only the dealt cards need to be uniformly drawn, the rest of the deck is never looked at
+  Random::partialShuffle(std::span<uint8_t>(temp), 2*PlayerNum+5, *RNG);
   std::copy(temp.begin(),temp.begin()+2*PlayerNum+5, playableCards.begin());
 
   cards.initIndices(std::span<uint8_t, 9>(temp.begin(), 9));
@@ -7,16 +7,24 @@
 #include <cstdint>
 #include <array>
 
+#include "../../Utility/Random.hpp"
+
 namespace Texas {
 class GameBase {
  public:
   /// constants
+  /// @brief random engine used for dealing, chance and opponent sampling
+  using Engine = Random::DefaultEngine;
+
   static constexpr uint8_t PlayerNum = 2;
 
   static constexpr uint8_t DeckCardNum = 52;
 
   static constexpr uint8_t maxRaises = 2;
 
+  /// @brief cards dealt each round, the hole cards then flop, turn and river
+  static constexpr std::array<uint8_t, 4> cardsPerRound{2, 3, 1, 1};
+
   static constexpr std::array<uint8_t,DeckCardNum> rangeDeck = [] {
     std::array<uint8_t, DeckCardNum> deck{};
 
@@ -3,6 +3,7 @@
 //
 
 #include "TexasCards.hpp"
+#include "../GameBase.hpp"
 
 
 namespace Texas {
@@ -38,10 +39,14 @@ void TexasCards::initIndices(std::span<uint8_t, 9> cards) {
   playerIndices[7] = hand_index_next_round(&riverIndexer, cardsriver, &hand2indeces);
 }
 
+const hand_indexer_t& TexasCards::indexer() {
+  indexerInit();
+  return riverIndexer;
+}
+
 void TexasCards::indexerInit() {
   if (!init) {
-    constexpr uint8_t cardsperround[]{2, 3, 1, 1};
-    hand_indexer_init(4, cardsperround, &riverIndexer);
+    hand_indexer_init(GameBase::cardsPerRound.size(), GameBase::cardsPerRound.data(), &riverIndexer);
     init = true;
   }
 }
@@ -23,6 +23,8 @@ public:
 
     std::array<uint64_t,8> playerIndices{};
     static hand_indexer_t riverIndexer;
+    /// @brief riverIndexer, initialised on first use
+    static const hand_indexer_t& indexer();
 private:
 
     static inline bool init = false;
@@ -0,0 +1,215 @@
+#ifndef RANDOM_HPP
+#define RANDOM_HPP
+
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <random>
+#include <span>
+
+/// @brief Small random engines and allocation free sampling for dealing cards and sampling actions
+namespace Random {
+
+/// @brief A uniform random bit generator producing full 32 or 64 bit words that can be seeded from one integer
+template<typename E>
+concept Engine = std::uniform_random_bit_generator<E> && std::constructible_from<E, uint64_t> &&
+                 E::min() == 0 &&
+                 (E::max() == std::numeric_limits<uint32_t>::max() || E::max() == std::numeric_limits<uint64_t>::max());
+
+/// @brief SplitMix64 step, used to expand a single seed into engine state
+constexpr uint64_t splitMix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+/// @brief xoshiro256++ (Blackman and Vigna), 32 bytes of state
+class Xoshiro256pp {
+public:
+    using result_type = uint64_t;
+
+    explicit Xoshiro256pp(uint64_t seed = 0) { this->seed(seed); }
+
+    void seed(uint64_t seed) {
+        for (uint64_t& word : m_state) {
+            word = splitMix64(seed);
+        }
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        const uint64_t result = std::rotl(m_state[0] + m_state[3], 23) + m_state[0];
+        const uint64_t t = m_state[1] << 17;
+        m_state[2] ^= m_state[0];
+        m_state[3] ^= m_state[1];
+        m_state[1] ^= m_state[2];
+        m_state[0] ^= m_state[3];
+        m_state[2] ^= t;
+        m_state[3] = std::rotl(m_state[3], 45);
+        return result;
+    }
+
+    bool operator==(const Xoshiro256pp&) const = default;
+
+    /// @brief State as space separated words, the same round trip std engines offer for checkpoints
+    friend std::ostream& operator<<(std::ostream& out, const Xoshiro256pp& engine) {
+        return out << engine.m_state[0] << ' ' << engine.m_state[1] << ' ' << engine.m_state[2] << ' ' << engine.m_state[3];
+    }
+    friend std::istream& operator>>(std::istream& in, Xoshiro256pp& engine) {
+        return in >> engine.m_state[0] >> engine.m_state[1] >> engine.m_state[2] >> engine.m_state[3];
+    }
+
+private:
+    uint64_t m_state[4]{};
+};
+
+/// @brief PCG32 (XSH RR output of a 64 bit LCG), 16 bytes of state
+class Pcg32 {
+public:
+    using result_type = uint32_t;
+
+    explicit Pcg32(uint64_t seed = 0) { this->seed(seed); }
+
+    void seed(uint64_t seed) {
+        m_increment = (splitMix64(seed) << 1) | 1;
+        m_state = 0;
+        (*this)();
+        m_state += splitMix64(seed);
+        (*this)();
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        const uint64_t old = m_state;
+        m_state = old * 6364136223846793005ull + m_increment;
+        const auto xorShifted = static_cast<uint32_t>(((old >> 18) ^ old) >> 27);
+        return std::rotr(xorShifted, static_cast<int>(old >> 59));
+    }
+
+    bool operator==(const Pcg32&) const = default;
+
+    friend std::ostream& operator<<(std::ostream& out, const Pcg32& engine) {
+        return out << engine.m_state << ' ' << engine.m_increment;
+    }
+    friend std::istream& operator>>(std::istream& in, Pcg32& engine) {
+        return in >> engine.m_state >> engine.m_increment;
+    }
+
+private:
+    uint64_t m_state{};
+    uint64_t m_increment{};
+};
+
+/// @brief wyrand (Wang Yi), 8 bytes of state, one multiply per draw
+class WyRand {
+public:
+    using result_type = uint64_t;
+
+    explicit WyRand(uint64_t seed = 0) : m_state(seed) {}
+
+    void seed(uint64_t seed) { m_state = seed; }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        m_state += 0xA0761D6478BD642Full;
+        const __uint128_t product = static_cast<__uint128_t>(m_state) * (m_state ^ 0xE7037ED1A0B428DBull);
+        return static_cast<uint64_t>(product >> 64) ^ static_cast<uint64_t>(product);
+    }
+
+    bool operator==(const WyRand&) const = default;
+
+    friend std::ostream& operator<<(std::ostream& out, const WyRand& engine) { return out << engine.m_state; }
+    friend std::istream& operator>>(std::istream& in, WyRand& engine) { return in >> engine.m_state; }
+
+private:
+    uint64_t m_state;
+};
+
+/// @brief Engine used by the games and regret minimizers
+using DefaultEngine = Xoshiro256pp;
+
+/// @brief Uniform integer in [0, bound) by Lemire's multiply and reject method, bound must be non zero
+template<Engine E>
+uint32_t uniformBelow(E& engine, uint32_t bound) {
+    auto draw = [&engine]() -> uint32_t {
+        // the high half of a 64 bit word is the better half for xoshiro and wyrand
+        if constexpr (E::max() == std::numeric_limits<uint64_t>::max()) {
+            return static_cast<uint32_t>(engine() >> 32);
+        } else {
+            return static_cast<uint32_t>(engine());
+        }
+    };
+    uint64_t product = static_cast<uint64_t>(draw()) * bound;
+    auto low = static_cast<uint32_t>(product);
+    if (low < bound) {
+        const uint32_t threshold = -bound % bound;
+        while (low < threshold) {
+            product = static_cast<uint64_t>(draw()) * bound;
+            low = static_cast<uint32_t>(product);
+        }
+    }
+    return static_cast<uint32_t>(product >> 32);
+}
+
+/// @brief Uniform float in [0, 1)
+template<Engine E>
+float uniformFloat(E& engine) {
+    if constexpr (E::max() == std::numeric_limits<uint64_t>::max()) {
+        return static_cast<float>(engine() >> 40) * 0x1.0p-24f;
+    } else {
+        return static_cast<float>(engine() >> 8) * 0x1.0p-24f;
+    }
+}
+
+/// @brief Fisher-Yates over only the first count positions, each is a uniform draw from the cards not yet placed
+/// @details The tail of the range is left in an unspecified order, dealing 9 cards costs 9 draws rather than 51.
+template<typename T, Engine E>
+void partialShuffle(std::span<T> items, size_t count, E& engine) {
+    const size_t size = items.size();
+    for (size_t i = 0; i < count && i + 1 < size; ++i) {
+        const size_t j = i + uniformBelow(engine, static_cast<uint32_t>(size - i));
+        std::swap(items[i], items[j]);
+    }
+}
+
+/// @brief Sample an index with probability proportional to its weight without building a distribution
+/// @details Weights need not sum to one. When every weight is zero the choice is uniform, as with std::discrete_distribution.
+template<Engine E>
+size_t sampleCategorical(std::span<const float> weights, E& engine) {
+    float total = 0.f;
+    for (const float weight : weights) {
+        total += weight;
+    }
+    if (!(total > 0.f)) {
+        return uniformBelow(engine, static_cast<uint32_t>(weights.size()));
+    }
+
+    const float target = uniformFloat(engine) * total;
+    float cumulative = 0.f;
+    size_t last = 0;
+    for (size_t i = 0; i < weights.size(); ++i) {
+        if (weights[i] > 0.f) {
+            cumulative += weights[i];
+            last = i;
+            if (target < cumulative) {
+                return i;
+            }
+        }
+    }
+    // rounding can leave target just past the summed weights, fall back to the last action with weight
+    return last;
+}
+
+} // namespace Random
+
+#endif //RANDOM_HPP
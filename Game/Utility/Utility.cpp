@@ -68,6 +68,14 @@ int Utility::LookupHandValue(int* pCards)
     p = Utility::HR[p + *pCards++];
     return Utility::HR[p + *pCards];
 }
+
+int Utility::LookupState(int state, const int* pCards, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        state = Utility::HR[state + pCards[i]];
+    }
+    return state;
+}
 /*
 int Utility::LookupSingleHands() {
     //printf("Looking up individual hands...\n\n");
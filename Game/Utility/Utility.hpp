@@ -17,6 +17,10 @@ public:
 
     static int LookupHandValue(int* pCards);
 
+    /// @brief Continue a lookup table walk from state over count cards, 53 starts an empty hand
+    /// @details Seven cards end at the hand's value. A shared board can be walked once and each hand continued from it.
+    static int LookupState(int state, const int* pCards, int count);
+
     static int getWinner(int *p0Cards, int *p1Cards);
 
     static void EnumerateAll7CardHands();
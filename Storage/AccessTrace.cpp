@@ -0,0 +1,190 @@
+#include "AccessTrace.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+namespace CFR {
+namespace {
+
+/// @brief Buffered bytes written out at a time
+constexpr size_t FlushBytes = 1 << 20;
+constexpr size_t HeaderBytes = 16;
+
+void appendVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+bool readVarint(const std::string& in, size_t& at, uint64_t& value) {
+    value = 0;
+    for (uint32_t shift = 0; shift < 64 && at < in.size(); shift += 7) {
+        const auto byte = static_cast<uint8_t>(in[at++]);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+AccessTraceWriter::AccessTraceWriter(const std::filesystem::path& path) : m_out(path, std::ios::binary | std::ios::trunc) {
+    if (!m_out) {
+        throw std::runtime_error("Failed to create access trace " + path.string());
+    }
+    m_buffer.append(Tag);
+    m_buffer.append(reinterpret_cast<const char*>(&Version), sizeof(Version));
+    m_buffer.append(sizeof(uint32_t), '\0');
+}
+
+AccessTraceWriter::~AccessTraceWriter() {
+    flush();
+}
+
+void AccessTraceWriter::record(const std::string& infoSet, AccessOp op, uint8_t actions) {
+    const auto [entry, added] = m_ids.try_emplace(infoSet, static_cast<uint32_t>(m_ids.size()));
+    appendVarint(m_buffer, (static_cast<uint64_t>(entry->second) + 1) << 1 | static_cast<uint64_t>(op));
+    if (added) {
+        appendVarint(m_buffer, infoSet.size());
+        m_buffer.append(infoSet);
+    }
+    if (op == AccessOp::Put) {
+        m_buffer.push_back(static_cast<char>(actions));
+    }
+    ++m_records;
+    if (m_buffer.size() >= FlushBytes) {
+        flush();
+    }
+}
+
+void AccessTraceWriter::flush() {
+    m_out.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+    m_out.flush();
+    m_buffer.clear();
+}
+
+AccessTrace AccessTrace::load(const std::filesystem::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Failed to open access trace " + path.string());
+    }
+    const std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    uint32_t version = 0;
+    if (data.size() >= HeaderBytes) {
+        std::memcpy(&version, data.data() + AccessTraceWriter::Tag.size(), sizeof(version));
+    }
+    if (data.size() < HeaderBytes || std::string_view(data).substr(0, AccessTraceWriter::Tag.size()) != AccessTraceWriter::Tag ||
+        version != AccessTraceWriter::Version) {
+        throw std::runtime_error(path.string() + " is not an access trace");
+    }
+
+    auto keys = std::make_shared<std::vector<std::string>>();
+    AccessTrace trace;
+    for (size_t at = HeaderBytes; at < data.size();) {
+        uint64_t value = 0;
+        if (!readVarint(data, at, value) || value < 2) {
+            throw std::runtime_error("Access trace " + path.string() + " is corrupt");
+        }
+        Record record{static_cast<uint32_t>((value >> 1) - 1), static_cast<AccessOp>(value & 1), 0};
+        if (record.key == keys->size()) {
+            uint64_t length = 0;
+            if (!readVarint(data, at, length) || data.size() - at < length) {
+                throw std::runtime_error("Access trace " + path.string() + " is truncated");
+            }
+            keys->emplace_back(data, at, length);
+            at += length;
+        } else if (record.key > keys->size()) {
+            throw std::runtime_error("Access trace " + path.string() + " is corrupt");
+        }
+        if (record.op == AccessOp::Put) {
+            if (at == data.size()) {
+                throw std::runtime_error("Access trace " + path.string() + " is truncated");
+            }
+            record.actions = static_cast<uint8_t>(data[at++]);
+        }
+        trace.m_records.push_back(record);
+    }
+    trace.m_keys = std::move(keys);
+    return trace;
+}
+
+std::vector<AccessTrace> AccessTrace::split(uint32_t parts) const {
+    if (parts == 0) {
+        throw std::invalid_argument("A trace splits into at least one part");
+    }
+    std::vector<AccessTrace> slices(parts);
+    const size_t total = m_records.size();
+    for (uint32_t p = 0; p < parts; ++p) {
+        const size_t begin = total * p / parts;
+        const size_t end = total * (p + 1) / parts;
+        slices[p].m_keys = m_keys;
+        slices[p].m_records.assign(m_records.begin() + static_cast<std::ptrdiff_t>(begin), m_records.begin() + static_cast<std::ptrdiff_t>(end));
+    }
+    return slices;
+}
+
+ReplayResult replayTraces(NodeStorage& storage, std::span<const AccessTrace> traces) {
+    LatencyHistogram getLatency;
+    LatencyHistogram putLatency;
+    std::atomic<uint64_t> gets{0};
+    std::atomic<uint64_t> puts{0};
+    std::atomic<uint64_t> hits{0};
+
+    const auto replay = [&](const AccessTrace& trace) {
+        uint64_t traceGets = 0;
+        uint64_t tracePuts = 0;
+        uint64_t traceHits = 0;
+        for (const AccessTrace::Record& record : trace.records()) {
+            const std::string& infoSet = trace.key(record.key);
+            const auto start = std::chrono::steady_clock::now();
+            if (record.op == AccessOp::Put) {
+                storage.putNode(infoSet, std::make_shared<Node>(record.actions));
+                putLatency.record(std::chrono::steady_clock::now() - start);
+                ++tracePuts;
+                continue;
+            }
+            std::optional<std::shared_ptr<Node>> node = storage.tryGetNode(infoSet);
+            if (node && *node != nullptr) {
+                ++traceHits;
+            } else if (!node) {
+                if (const std::shared_ptr<Node> loaded = storage.loadNode(infoSet)) {
+                    storage.admitNode(infoSet, loaded);
+                }
+            }
+            getLatency.record(std::chrono::steady_clock::now() - start);
+            ++traceGets;
+        }
+        gets += traceGets;
+        puts += tracePuts;
+        hits += traceHits;
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+    if (traces.size() == 1) {
+        replay(traces.front());
+    } else {
+        std::vector<std::jthread> threads;
+        threads.reserve(traces.size());
+        for (const AccessTrace& trace : traces) {
+            threads.emplace_back([&replay, &trace] { replay(trace); });
+        }
+    }
+
+    ReplayResult result;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.gets = gets;
+    result.puts = puts;
+    result.hits = hits;
+    result.getLatency = getLatency.snapshot();
+    result.putLatency = putLatency.snapshot();
+    return result;
+}
+
+} // namespace CFR
@@ -0,0 +1,109 @@
+#ifndef ACCESSTRACE_HPP
+#define ACCESSTRACE_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "LatencyHistogram.hpp"
+#include "NodeStorage.hpp"
+
+namespace CFR {
+
+/// @brief Storage operation recorded in an access trace
+enum class AccessOp : uint8_t {
+    /// @brief Node lookup, a hit when the storage answers from memory
+    Get = 0,
+    /// @brief A new node stored for an info set seen for the first time
+    Put = 1,
+};
+
+/// @brief Records the storage accesses of one training thread to a compact binary trace
+///
+/// File layout: tag "CFRTRACE", uint32 version, uint32 reserved, then one record per access. A record is the varint
+/// (key id + 1) << 1 | op, followed for a key not seen before by its varint length and bytes and, for a put, by the
+/// node's action count in one byte. Ids are handed out in order of first use, so a repeated key costs two or three
+/// bytes. Not thread safe, give each thread its own writer.
+class AccessTraceWriter {
+public:
+    static constexpr std::string_view Tag = "CFRTRACE";
+    static constexpr uint32_t Version = 1;
+
+    /// @throws std::runtime_error if the file cannot be created
+    explicit AccessTraceWriter(const std::filesystem::path& path);
+    /// @details Writes whatever is still buffered
+    ~AccessTraceWriter();
+
+    AccessTraceWriter(const AccessTraceWriter&) = delete;
+    AccessTraceWriter& operator=(const AccessTraceWriter&) = delete;
+
+    void get(const std::string& infoSet) { record(infoSet, AccessOp::Get, 0); }
+    void put(const std::string& infoSet, uint8_t actions) { record(infoSet, AccessOp::Put, actions); }
+
+    void flush();
+
+    [[nodiscard]] uint64_t records() const { return m_records; }
+
+private:
+    void record(const std::string& infoSet, AccessOp op, uint8_t actions);
+
+    std::ofstream m_out;
+    std::string m_buffer;
+    /// @brief Every key written so far, the trace refers to them by id
+    std::unordered_map<std::string, uint32_t> m_ids;
+    uint64_t m_records = 0;
+};
+
+/// @brief An access trace read back into memory
+class AccessTrace {
+public:
+    struct Record {
+        uint32_t key;
+        AccessOp op;
+        /// @brief Action count of the node a put stores
+        uint8_t actions;
+    };
+
+    /// @throws std::runtime_error if the file is missing, truncated or not an access trace
+    static AccessTrace load(const std::filesystem::path& path);
+
+    /// @brief Contiguous slices of this trace sharing its keys, one per replay thread
+    [[nodiscard]] std::vector<AccessTrace> split(uint32_t parts) const;
+
+    [[nodiscard]] const std::string& key(uint32_t id) const { return (*m_keys)[id]; }
+    [[nodiscard]] size_t uniqueKeys() const { return m_keys->size(); }
+    [[nodiscard]] std::span<const Record> records() const { return m_records; }
+
+private:
+    std::shared_ptr<const std::vector<std::string>> m_keys;
+    std::vector<Record> m_records;
+};
+
+/// @brief What replaying traces against a storage measured
+struct ReplayResult {
+    uint64_t gets = 0;
+    uint64_t puts = 0;
+    /// @brief Gets the storage answered without a blocking read, the node being resident
+    uint64_t hits = 0;
+    double seconds = 0;
+    LatencyHistogram::Snapshot getLatency;
+    LatencyHistogram::Snapshot putLatency;
+
+    [[nodiscard]] double opsPerSecond() const { return seconds > 0 ? static_cast<double>(gets + puts) / seconds : 0; }
+    [[nodiscard]] double hitRate() const { return gets > 0 ? static_cast<double>(hits) / static_cast<double>(gets) : 0; }
+};
+
+/// @brief Drive storage with recorded accesses, one thread per trace
+/// @details A get asks tryGetNode and counts a hit when it answers with a node. Otherwise it reads through loadNode and
+/// admits what it found, as asynchronous training does. A put stores a fresh node of the recorded size. With more than
+/// one trace the storage must allow concurrent use, as the sharded cache and hybrid storage do.
+ReplayResult replayTraces(NodeStorage& storage, std::span<const AccessTrace> traces);
+
+} // namespace CFR
+
+#endif //ACCESSTRACE_HPP
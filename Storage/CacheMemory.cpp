@@ -0,0 +1,116 @@
+#include "CacheMemory.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <unistd.h>
+
+namespace CFR {
+namespace {
+
+/// @brief Read a single integer from a cgroup or proc file, nullopt if missing or "max"
+std::optional<size_t> readBytes(const std::string& path) {
+    std::ifstream file(path);
+    std::string token;
+    if (!(file >> token) || token == "max") {
+        return std::nullopt;
+    }
+    try {
+        return static_cast<size_t>(std::stoull(token));
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
+/// @brief Free bytes left under the tightest cgroup v2 limit on the path from our cgroup to the root
+std::optional<size_t> cgroupV2Headroom() {
+    std::ifstream self("/proc/self/cgroup");
+    std::string line;
+    std::string cgroupPath;
+    while (std::getline(self, line)) {
+        if (line.rfind("0::", 0) == 0) {
+            cgroupPath = line.substr(3);
+            break;
+        }
+    }
+
+    std::optional<size_t> headroom;
+    // Inside a cgroup namespace the path is "/" and the limit lives at the mount root
+    while (true) {
+        const std::string dir = "/sys/fs/cgroup" + (cgroupPath == "/" ? std::string() : cgroupPath);
+        const auto limit = readBytes(dir + "/memory.max");
+        if (limit) {
+            const size_t used = readBytes(dir + "/memory.current").value_or(0);
+            const size_t free = *limit > used ? *limit - used : 0;
+            headroom = headroom ? std::min(*headroom, free) : free;
+        }
+        if (cgroupPath.empty() || cgroupPath == "/") {
+            break;
+        }
+        const size_t slash = cgroupPath.find_last_of('/');
+        cgroupPath = slash == 0 || slash == std::string::npos ? "/" : cgroupPath.substr(0, slash);
+    }
+    return headroom;
+}
+
+/// @brief Free bytes left under the cgroup v1 memory controller limit
+std::optional<size_t> cgroupV1Headroom() {
+    const auto limit = readBytes("/sys/fs/cgroup/memory/memory.limit_in_bytes");
+    // v1 reports "unlimited" as a page-aligned LONG_MAX
+    if (!limit || *limit >= (std::numeric_limits<size_t>::max() >> 2)) {
+        return std::nullopt;
+    }
+    const size_t used = readBytes("/sys/fs/cgroup/memory/memory.usage_in_bytes").value_or(0);
+    return *limit > used ? *limit - used : 0;
+}
+
+/// @brief MemAvailable from /proc/meminfo, or total physical memory where that file does not exist
+size_t systemAvailable() {
+    std::ifstream meminfo("/proc/meminfo");
+    std::string line;
+    while (std::getline(meminfo, line)) {
+        // "MemAvailable:   12345678 kB"
+        if (line.rfind("MemAvailable:", 0) == 0) {
+            return std::stoull(line.substr(line.find(':') + 1)) * 1024;
+        }
+    }
+    const long pages = sysconf(_SC_PHYS_PAGES);
+    const long pageSize = sysconf(_SC_PAGESIZE);
+    return pages > 0 && pageSize > 0 ? static_cast<size_t>(pages) * static_cast<size_t>(pageSize) : 0;
+}
+
+} // namespace
+
+size_t CacheMemory::heapBytes(const std::string& str) {
+    // an empty string reports the small string buffer size (15 in libstdc++, 22 in libc++)
+    static const size_t inlineCapacity = std::string().capacity();
+    return str.size() <= inlineCapacity ? 0 : str.size() + 1 + AllocationOverhead;
+}
+
+size_t CacheMemory::heapBytes(const Node& node) {
+    // make_shared places the node next to its control block (two counters and a vtable pointer)
+    constexpr size_t controlBlock = 2 * sizeof(long) + sizeof(void*);
+    constexpr size_t vectorBuffers = 4;
+    return controlBlock + AllocationOverhead + node.memoryFootprint() + vectorBuffers * AllocationOverhead;
+}
+
+size_t CacheMemory::availableMemoryBytes() {
+    size_t available = systemAvailable();
+    if (const auto v2 = cgroupV2Headroom()) {
+        available = std::min(available, *v2);
+    } else if (const auto v1 = cgroupV1Headroom()) {
+        available = std::min(available, *v1);
+    }
+    return available;
+}
+
+size_t CacheMemory::autoBudget(double fraction) {
+    fraction = std::clamp(fraction, 0.0, 1.0);
+    const auto budget = static_cast<size_t>(fraction * static_cast<double>(availableMemoryBytes()));
+    // Never hand back a zero budget, the caches reject it
+    constexpr size_t minimumBudget = 64ull * 1024 * 1024;
+    return std::max(budget, minimumBudget);
+}
+
+} // namespace CFR
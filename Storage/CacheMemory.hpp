@@ -0,0 +1,54 @@
+#ifndef CACHEMEMORY_HPP
+#define CACHEMEMORY_HPP
+
+#include <cstddef>
+#include <string>
+
+#include "../CFR/Node.hpp"
+
+namespace CFR {
+
+/// @brief Bytes used against the configured budget of a node cache
+struct CacheMemoryStats {
+    size_t usedBytes = 0;
+    size_t budgetBytes = 0;
+    size_t entries = 0;
+
+    /// @brief Fraction of the budget in use, 0 when there is no budget
+    [[nodiscard]] double utilization() const {
+        return budgetBytes > 0 ? static_cast<double>(usedBytes) / static_cast<double>(budgetBytes) : 0.0;
+    }
+
+    CacheMemoryStats& operator+=(const CacheMemoryStats& other) {
+        usedBytes += other.usedBytes;
+        budgetBytes += other.budgetBytes;
+        entries += other.entries;
+        return *this;
+    }
+};
+
+/// @brief Helpers for budgeting caches in bytes rather than node counts
+namespace CacheMemory {
+    /// @brief Rough per-allocation cost of the general purpose allocator (chunk header plus rounding)
+    constexpr size_t AllocationOverhead = 16;
+
+    /// @brief Fraction of available memory used when a cache is auto-sized
+    constexpr double DefaultBudgetFraction = 0.5;
+
+    /// @brief Heap bytes owned by a copy of a string, zero when it fits the small string buffer
+    [[nodiscard]] size_t heapBytes(const std::string& str);
+
+    /// @brief Heap bytes owned by a node created through std::make_shared, including the control block and vector buffers
+    [[nodiscard]] size_t heapBytes(const Node& node);
+
+    /// @brief Memory this process may still use, the smaller of MemAvailable and the cgroup (v2 or v1) headroom
+    [[nodiscard]] size_t availableMemoryBytes();
+
+    /// @brief Cache budget targeting a fraction of the currently available memory
+    /// @param fraction Share of available memory to give the cache, clamped to (0, 1]
+    [[nodiscard]] size_t autoBudget(double fraction = DefaultBudgetFraction);
+}
+
+} // namespace CFR
+
+#endif //CACHEMEMORY_HPP
@@ -0,0 +1,352 @@
+#include "FrozenStrategy.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace CFR {
+namespace {
+
+struct Header {
+    char tag[8];
+    uint32_t slotBytes;
+    uint32_t maxActions;
+    uint64_t nodes;
+    uint64_t slots;
+    uint64_t buckets;
+    uint64_t displacementOffset;
+    uint64_t slotOffset;
+    uint32_t probabilityBytes;
+    uint32_t reserved;
+};
+static_assert(sizeof(Header) == 64);
+
+constexpr uint64_t SlotAlignment = 64;
+/// @brief Average keys per bucket and share of slots filled, the usual CHD trade of build time against size
+constexpr uint64_t KeysPerBucket = 4;
+constexpr double LoadFactor = 0.85;
+constexpr uint32_t MaxDisplacement = 1u << 24;
+/// @brief Fingerprint and action count, the probabilities follow
+constexpr uint32_t SlotPrefixBytes = 9;
+
+/// @brief FNV-1a with a seeded basis and a murmur style finaliser, fixed so the file reads the same on every build
+uint64_t hashKey(std::string_view key, uint64_t seed) {
+    uint64_t hash = 0xCBF29CE484222325ull ^ (seed * 0x9E3779B97F4A7C15ull);
+    for (const char c : key) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001B3ull;
+    }
+    hash = (hash ^ (hash >> 33)) * 0xFF51AFD7ED558CCDull;
+    hash = (hash ^ (hash >> 33)) * 0xC4CEB9FE1A85EC53ull;
+    return hash ^ (hash >> 33);
+}
+
+uint64_t slotIndex(uint64_t hash, uint32_t displacement, uint64_t slots) {
+    uint64_t z = hash + (static_cast<uint64_t>(displacement) + 1) * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return (z ^ (z >> 31)) % slots;
+}
+
+uint64_t alignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+uint32_t scaleOf(uint32_t probabilityBytes) {
+    return probabilityBytes == 1 ? 255u : 65535u;
+}
+
+/// @brief 16 bit probabilities skip a pad byte to stay aligned
+uint32_t probabilityOffset(uint32_t probabilityBytes) {
+    return probabilityBytes == 1 ? SlotPrefixBytes : SlotPrefixBytes + 1;
+}
+
+/// @brief Probabilities in 1/scale steps, largest remainders rounded up so the steps sum to exactly scale
+/// @details Steps stay in the node's action order, the order the game lists the actions in
+void quantise(const std::vector<float>& probabilities, uint32_t scale, uint32_t* out) {
+    const size_t n = probabilities.size();
+    std::vector<std::pair<double, size_t>> remainders(n);
+    uint32_t assigned = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const double scaled = std::clamp(static_cast<double>(probabilities[i]), 0.0, 1.0) * scale;
+        out[i] = static_cast<uint32_t>(std::floor(scaled));
+        assigned += out[i];
+        remainders[i] = {scaled - std::floor(scaled), i};
+    }
+    std::ranges::stable_sort(remainders, std::greater<>{}, [](const auto& remainder) { return remainder.first; });
+    for (size_t i = 0; assigned < scale && i < n; ++i, ++assigned) {
+        ++out[remainders[i].second];
+    }
+}
+
+struct Entry {
+    uint64_t hash;
+    uint64_t fingerprint;
+    uint32_t bucket;
+    uint32_t actions;
+    size_t probabilities;
+};
+
+} // namespace
+
+FrozenExportReport FrozenStrategy::write(const NodeStorage& source, const std::filesystem::path& path, FrozenExportOptions options) {
+    const uint32_t probabilityBytes = options.precision == ProbabilityPrecision::Bits8 ? 1 : 2;
+    const uint32_t scale = scaleOf(probabilityBytes);
+    FrozenExportReport report;
+    double totalError = 0;
+
+    // only hashes and quantised probabilities are kept, the keys are not needed once hashed
+    std::vector<Entry> entries;
+    std::vector<uint32_t> probabilities;
+    uint32_t maxActions = 1;
+    source.forEachNode([&](const std::string& infoSet, const std::shared_ptr<Node>& node) {
+        const std::vector<float> average = node->averageStrategyOf();
+        if (average.size() > MaxActions) {
+            throw std::invalid_argument("Info set " + infoSet + " has more actions than a frozen slot holds");
+        }
+        entries.push_back({hashKey(infoSet, 0), hashKey(infoSet, 1), 0, static_cast<uint32_t>(average.size()), probabilities.size()});
+        probabilities.resize(probabilities.size() + average.size());
+        uint32_t* quantised = probabilities.data() + entries.back().probabilities;
+        quantise(average, scale, quantised);
+        maxActions = std::max(maxActions, static_cast<uint32_t>(average.size()));
+
+        double error = 0;
+        for (size_t a = 0; a < average.size(); ++a) {
+            error += std::abs(static_cast<double>(quantised[a]) / scale - average[a]);
+        }
+        report.maxL1Error = std::max(report.maxL1Error, error);
+        totalError += error;
+    });
+
+    const uint64_t nodes = entries.size();
+    const uint64_t buckets = std::max<uint64_t>(1, (nodes + KeysPerBucket - 1) / KeysPerBucket);
+    const uint64_t slots = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(static_cast<double>(nodes) / LoadFactor)));
+    const uint32_t offset = probabilityOffset(probabilityBytes);
+    const auto slotBytes = std::max<uint32_t>(16, std::bit_ceil(offset + probabilityBytes * maxActions));
+
+    // place the fullest buckets first while the table is empty, each bucket takes the first displacement that sends
+    // all of its keys to free slots
+    for (Entry& entry : entries) {
+        entry.bucket = static_cast<uint32_t>(entry.hash % buckets);
+    }
+    std::ranges::sort(entries, {}, [](const Entry& entry) { return std::pair(entry.bucket, entry.hash); });
+    for (size_t i = 1; i < entries.size(); ++i) {
+        if (entries[i].hash == entries[i - 1].hash) {
+            throw std::runtime_error("Two info sets share a 64 bit hash, the strategy cannot be frozen");
+        }
+    }
+    std::vector<std::pair<size_t, size_t>> bucketRanges;
+    for (size_t begin = 0; begin < entries.size();) {
+        size_t end = begin;
+        while (end < entries.size() && entries[end].bucket == entries[begin].bucket) {
+            ++end;
+        }
+        bucketRanges.emplace_back(begin, end);
+        begin = end;
+    }
+    std::ranges::stable_sort(bucketRanges, std::greater<>{}, [](const auto& range) { return range.second - range.first; });
+
+    std::vector<uint32_t> displacements(buckets, 0);
+    std::vector<bool> taken(slots, false);
+    std::vector<uint64_t> placed;
+    std::vector<std::byte> table(slots * slotBytes, std::byte{0});
+    for (const auto& [begin, end] : bucketRanges) {
+        uint32_t displacement = 0;
+        for (;; ++displacement) {
+            if (displacement == MaxDisplacement) {
+                throw std::runtime_error("Failed to place a bucket of the frozen strategy hash");
+            }
+            placed.clear();
+            bool fits = true;
+            for (size_t i = begin; i < end && fits; ++i) {
+                const uint64_t slot = slotIndex(entries[i].hash, displacement, slots);
+                fits = !taken[slot] && std::ranges::find(placed, slot) == placed.end();
+                placed.push_back(slot);
+            }
+            if (fits) {
+                break;
+            }
+        }
+        displacements[entries[begin].bucket] = displacement;
+        for (size_t i = begin; i < end; ++i) {
+            const Entry& entry = entries[i];
+            const uint64_t slot = placed[i - begin];
+            taken[slot] = true;
+            std::byte* bytes = table.data() + slot * slotBytes;
+            std::memcpy(bytes, &entry.fingerprint, sizeof(entry.fingerprint));
+            bytes[8] = static_cast<std::byte>(entry.actions);
+            for (uint32_t a = 0; a < entry.actions; ++a) {
+                const uint32_t value = probabilities[entry.probabilities + a];
+                if (probabilityBytes == 1) {
+                    bytes[offset + a] = static_cast<std::byte>(value);
+                } else {
+                    const auto wide = static_cast<uint16_t>(value);
+                    std::memcpy(bytes + offset + 2 * a, &wide, sizeof(wide));
+                }
+            }
+        }
+    }
+
+    Header header{};
+    std::memcpy(header.tag, Tag.data(), Tag.size());
+    header.slotBytes = slotBytes;
+    header.maxActions = maxActions;
+    header.nodes = nodes;
+    header.slots = slots;
+    header.buckets = buckets;
+    header.displacementOffset = sizeof(Header);
+    header.slotOffset = alignUp(header.displacementOffset + buckets * sizeof(uint32_t), SlotAlignment);
+    header.probabilityBytes = probabilityBytes;
+
+    std::filesystem::path temporary = path;
+    temporary += ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("Failed to create frozen strategy " + temporary.string());
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(displacements.data()), static_cast<std::streamsize>(buckets * sizeof(uint32_t)));
+        const std::vector<char> padding(header.slotOffset - header.displacementOffset - buckets * sizeof(uint32_t), 0);
+        out.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+        out.write(reinterpret_cast<const char*>(table.data()), static_cast<std::streamsize>(table.size()));
+        out.flush();
+        if (!out) {
+            throw std::runtime_error("Failed to write frozen strategy " + temporary.string());
+        }
+    }
+    std::filesystem::rename(temporary, path);
+
+    report.nodes = nodes;
+    report.fileBytes = header.slotOffset + table.size();
+    report.meanL1Error = nodes > 0 ? totalError / static_cast<double>(nodes) : 0;
+    return report;
+}
+
+FrozenStrategy::FrozenStrategy(const std::filesystem::path& path, bool preload) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open frozen strategy " + path.string());
+    }
+    struct stat info{};
+    if (::fstat(fd, &info) < 0 || static_cast<size_t>(info.st_size) < sizeof(Header)) {
+        ::close(fd);
+        throw std::runtime_error("Frozen strategy " + path.string() + " is truncated");
+    }
+    m_mapBytes = static_cast<size_t>(info.st_size);
+    // shared read only pages come from the page cache, every process mapping the file uses the same memory
+    m_map = ::mmap(nullptr, m_mapBytes, PROT_READ, MAP_SHARED | (preload ? MAP_POPULATE : 0), fd, 0);
+    ::close(fd);
+    if (m_map == MAP_FAILED) {
+        m_map = nullptr;
+        throw std::runtime_error("Failed to map frozen strategy " + path.string());
+    }
+    ::madvise(m_map, m_mapBytes, MADV_RANDOM);
+
+    Header header{};
+    std::memcpy(&header, m_map, sizeof(header));
+    const bool valid = std::string_view(header.tag, sizeof(header.tag)) == Tag && header.buckets > 0 && header.slots > 0 &&
+        (header.probabilityBytes == 1 || header.probabilityBytes == 2) && header.maxActions <= MaxActions &&
+        header.slotBytes >= probabilityOffset(header.probabilityBytes) + header.probabilityBytes * header.maxActions &&
+        header.slotBytes <= SlotAlignment &&
+        header.displacementOffset + header.buckets * sizeof(uint32_t) <= header.slotOffset &&
+        header.slotOffset % SlotAlignment == 0 && header.slotOffset + header.slots * header.slotBytes <= m_mapBytes;
+    if (!valid) {
+        ::munmap(m_map, m_mapBytes);
+        throw std::runtime_error(path.string() + " is not a frozen strategy");
+    }
+    const auto* base = static_cast<const std::byte*>(m_map);
+    m_displacements = reinterpret_cast<const uint32_t*>(base + header.displacementOffset);
+    m_slots = base + header.slotOffset;
+    m_nodes = header.nodes;
+    m_slotCount = header.slots;
+    m_bucketCount = header.buckets;
+    m_slotBytes = header.slotBytes;
+    m_maxActions = header.maxActions;
+    m_probabilityBytes = header.probabilityBytes;
+}
+
+FrozenStrategy::~FrozenStrategy() {
+    if (m_map != nullptr) {
+        ::munmap(m_map, m_mapBytes);
+    }
+}
+
+const std::byte* FrozenStrategy::slotFor(std::string_view infoSet) const noexcept {
+    const uint64_t hash = hashKey(infoSet, 0);
+    const uint32_t displacement = m_displacements[hash % m_bucketCount];
+    return m_slots + slotIndex(hash, displacement, m_slotCount) * m_slotBytes;
+}
+
+uint32_t FrozenStrategy::lookup(std::string_view infoSet, std::span<float> out) const noexcept {
+    const std::byte* slot = slotFor(infoSet);
+    uint64_t fingerprint;
+    std::memcpy(&fingerprint, slot, sizeof(fingerprint));
+    const auto actions = static_cast<uint32_t>(slot[8]);
+    if (actions == 0 || fingerprint != hashKey(infoSet, 1) || actions > out.size()) {
+        return 0;
+    }
+    const std::byte* quantised = slot + probabilityOffset(m_probabilityBytes);
+    if (m_probabilityBytes == 1) {
+        for (uint32_t a = 0; a < actions; ++a) {
+            out[a] = static_cast<float>(quantised[a]) / 255.f;
+        }
+    } else {
+        uint16_t wide[MaxActions];
+        std::memcpy(wide, quantised, actions * sizeof(uint16_t));
+        for (uint32_t a = 0; a < actions; ++a) {
+            out[a] = static_cast<float>(wide[a]) / 65535.f;
+        }
+    }
+    return actions;
+}
+
+std::shared_ptr<Node> FrozenStrategy::getNode(const std::string& infoSet) {
+    float probabilities[MaxActions];
+    const uint32_t actions = lookup(infoSet, probabilities);
+    if (actions == 0) {
+        return nullptr;
+    }
+    const std::vector<float> strategy(probabilities, probabilities + actions);
+    auto node = std::make_shared<Node>(static_cast<uint8_t>(actions));
+    // regret matching over these regrets gives the strategy back, so every reader sees the frozen probabilities
+    node->setRegretSum(strategy);
+    node->calcUpdatedStrategy();
+    node->setStrategySum(strategy);
+    node->setAverageStrategy(strategy);
+    return node;
+}
+
+bool FrozenStrategy::hasNode(const std::string& infoSet) const {
+    float probabilities[MaxActions];
+    return lookup(infoSet, probabilities) > 0;
+}
+
+void FrozenStrategy::prefetch(const std::string& infoSet) const {
+    __builtin_prefetch(slotFor(infoSet));
+}
+
+void FrozenStrategy::putNode(const std::string& infoSet, std::shared_ptr<Node> node) {
+    (void)infoSet;
+    (void)node;
+    throw std::logic_error("A frozen strategy is read only");
+}
+
+void FrozenStrategy::removeNode(const std::string& infoSet) {
+    (void)infoSet;
+    throw std::logic_error("A frozen strategy is read only");
+}
+
+void FrozenStrategy::clear() {
+    throw std::logic_error("A frozen strategy is read only");
+}
+
+} // namespace CFR
@@ -0,0 +1,108 @@
+#ifndef FROZENSTRATEGY_HPP
+#define FROZENSTRATEGY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string_view>
+
+#include "NodeStorage.hpp"
+
+namespace CFR {
+
+/// @brief Width of each stored probability
+enum class ProbabilityPrecision : uint8_t {
+    /// @brief 1/65535 steps, indistinguishable from the float strategy in play
+    Bits16,
+    /// @brief 1/255 steps, half the slot size so more of the strategy stays cache resident
+    Bits8,
+};
+
+struct FrozenExportOptions {
+    ProbabilityPrecision precision = ProbabilityPrecision::Bits16;
+};
+
+/// @brief What an export wrote and how far quantisation moved the strategies
+struct FrozenExportReport {
+    uint64_t nodes = 0;
+    uint64_t fileBytes = 0;
+    /// @brief Largest and mean L1 distance between a node's float average strategy and its stored probabilities
+    double maxL1Error = 0;
+    double meanL1Error = 0;
+};
+
+/// @brief Immutable average strategy file, memory mapped read only so every process serving it shares one copy
+///
+/// File layout, integers in host byte order:
+///   64 byte header: tag "CFRFROZ1", uint32 slot bytes, uint32 max actions, uint64 node count, slot count, bucket
+///   count, displacement offset and slot offset, uint32 probability bytes
+///   uint32 displacement per bucket, then the slot table at a 64 byte aligned offset
+///   slot: uint64 key fingerprint, uint8 action count, then per action in the node's action order either a uint8
+///   probability or, after a pad byte, a uint16 probability
+/// Keys are placed by hash and displace perfect hashing (CHD): a key's bucket holds a displacement which, mixed into
+/// the key's hash, names a slot no other key uses. Slots are a power of two no larger than 64 bytes, so a lookup reads
+/// one displacement and one cache line. Keys themselves are not stored. A key that was never exported lands on some
+/// slot and is rejected by the 64 bit fingerprint, a false match is a 2^-64 event.
+/// Probabilities are quantised to 1/255 or 1/65535 steps that sum to exactly 255 or 65535.
+class FrozenStrategy : public NodeStorage {
+public:
+    static constexpr std::string_view Tag = "CFRFROZ1";
+    /// @brief Most actions a slot can hold, the slot would outgrow a cache line beyond this
+    static constexpr uint32_t MaxActions = 27;
+
+    /// @brief Compute every node's average strategy once and write the frozen file
+    /// @details Written through a temporary file renamed into place, so a serving process can map the old file until
+    /// it reopens. Hybrid storage should be flushed first, only spilled deltas are combined with their stored value.
+    /// @throws std::invalid_argument if a node has more than MaxActions actions, std::runtime_error on I/O failure
+    static FrozenExportReport write(const NodeStorage& source, const std::filesystem::path& path, FrozenExportOptions options = {});
+
+    /// @param preload Fault the whole file in now, so the first lookups do not wait on the disk
+    /// @throws std::runtime_error if the file is missing or not a frozen strategy
+    explicit FrozenStrategy(const std::filesystem::path& path, bool preload = false);
+    ~FrozenStrategy() override;
+
+    FrozenStrategy(const FrozenStrategy&) = delete;
+    FrozenStrategy& operator=(const FrozenStrategy&) = delete;
+
+    /// @brief Average strategy of infoSet without allocating, the serving fast path
+    /// @param out Receives one probability per action, needs room for maxActions() values
+    /// @return Number of actions, 0 when the info set was not exported
+    [[nodiscard]] uint32_t lookup(std::string_view infoSet, std::span<float> out) const noexcept;
+
+    [[nodiscard]] uint32_t maxActions() const noexcept { return m_maxActions; }
+    [[nodiscard]] ProbabilityPrecision precision() const noexcept {
+        return m_probabilityBytes == 1 ? ProbabilityPrecision::Bits8 : ProbabilityPrecision::Bits16;
+    }
+
+    // NodeStorage read paths
+    /// @details A new node whose strategy, average strategy and strategy sum all hold the frozen probabilities,
+    /// nullptr for an info set that was not exported
+    std::shared_ptr<Node> getNode(const std::string& infoSet) override;
+    bool hasNode(const std::string& infoSet) const override;
+    void prefetch(const std::string& infoSet) const override;
+    [[nodiscard]] size_t size() const override { return m_nodes; }
+
+    /// @brief The file is read only, these throw std::logic_error
+    void putNode(const std::string& infoSet, std::shared_ptr<Node> node) override;
+    void removeNode(const std::string& infoSet) override;
+    void clear() override;
+
+private:
+    [[nodiscard]] const std::byte* slotFor(std::string_view infoSet) const noexcept;
+
+    void* m_map = nullptr;
+    size_t m_mapBytes = 0;
+    const uint32_t* m_displacements = nullptr;
+    const std::byte* m_slots = nullptr;
+    uint64_t m_nodes = 0;
+    uint64_t m_slotCount = 0;
+    uint64_t m_bucketCount = 0;
+    uint32_t m_slotBytes = 0;
+    uint32_t m_maxActions = 0;
+    uint32_t m_probabilityBytes = 2;
+};
+
+} // namespace CFR
+
+#endif //FROZENSTRATEGY_HPP
@@ -5,10 +5,18 @@
 #ifndef HYBRIDNODESTORAGE_HPP
 #define HYBRIDNODESTORAGE_HPP
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
 #include <iostream>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 #include "NodeStorage.hpp"
 #include "LRUNodeCache.hpp"
 #include "RocksDBNodeStorage.hpp"
+#include "StorageStats.hpp"
 
 namespace CFR {
 /// @brief Hybrid storage combining in-memory cache and RocksDB on disk
@@ -17,9 +25,11 @@ template<typename CacheType >
 class HybridNodeStorage : public NodeStorage {
 public:
     /// @brief Constructor
-    /// @param cacheCapacity Maximum number of nodes to keep in cache (for LRU) or per shard (for Sharded)
+    /// @param cacheBudgetBytes Memory budget for the cache in bytes, by default a share of the RAM available to this process (cgroup aware)
     /// @param dbPath Path to RocksDB database directory
-    explicit HybridNodeStorage(size_t cacheCapacity = 100000, const std::string& dbPath = DEFAULT_DB_PATH);
+    /// @param options Column family layout and record encoding used for nodes spilled to disk
+    explicit HybridNodeStorage(size_t cacheBudgetBytes = CacheMemory::autoBudget(), const std::string& dbPath = DEFAULT_DB_PATH,
+                               RocksDBStorageOptions options = {});
 
     ~HybridNodeStorage() override;
     
@@ -27,16 +37,55 @@ public:
     void flush();
 
     // NodeStorage interface
+    /// @details A miss reads the stored value in every round, WriteOnlyDelta rounds remember it as the node's baseline
     std::shared_ptr<Node> getNode(const std::string& infoSet) override;
+    /// @details Cache hits are served directly, the misses go to the database in one batch
+    void getNodes(std::span<const std::string> infoSets, std::span<std::shared_ptr<Node>> out) override;
+    /// @details For a node the storage does not hold yet, as after getNode found it neither cached nor stored
     void putNode(const std::string& infoSet, std::shared_ptr<Node> node) override;
     bool hasNode(const std::string& infoSet) const override;
     void removeNode(const std::string& infoSet) override;
+    /// @details Answers from the cache, a miss needs a database read through loadNode
+    std::optional<std::shared_ptr<Node>> tryGetNode(const std::string& infoSet) override;
+    /// @details Reads the database only, RocksDB reads are safe from any thread
+    std::shared_ptr<Node> loadNode(const std::string& infoSet) override { return m_storage->getNode(infoSet); }
+    void admitNode(const std::string& infoSet, const std::shared_ptr<Node>& node) override;
+    /// @details Prefetches the cache entry only, a key that has to come from disk is read when it is looked up
+    void prefetch(const std::string& infoSet) const override { m_cache->prefetch(infoSet); }
+    /// @details Nodes found in the database at open plus nodes created since. A miss reads the database in every round,
+    /// so putNode only ever sees new keys and resident nodes are not counted twice. The opening count is RocksDB's key
+    /// estimate, exact once compaction has settled
     size_t size() const override;
     void clear() override;
+    /// @details Cached nodes, which hold their whole value, then the database nodes that are not cached. Not safe while
+    /// the storage is being trained
+    void forEachNode(const std::function<void(const std::string&, const std::shared_ptr<Node>&)>& visit) const override;
+    /// @details Pins a RocksDB snapshot and the cached nodes, which takes constant time for a ShardedLRUCache. The job
+    /// copies the snapshot into a new database in dir/rocksdb and writes the pinned cache entries over it, while
+    /// evictions keep spilling into the live database
+    std::function<void()> captureSnapshot(const std::filesystem::path& dir) override;
+    /// @details Drops the cache without spilling and reopens the database from a copy of the checkpoint. Stop the
+    /// stats reporter first, it samples the database being replaced
+    void restoreSnapshot(const std::filesystem::path& dir) override;
+
+    /// @brief Read a node from the cache or the database regardless of spill policy, for evaluation and export
+    std::shared_ptr<Node> readNode(const std::string& infoSet);
 
     /// @brief Get cache hit rate
     double getCacheHitRate() const;
 
+    /// @brief Get cache bytes used versus budget
+    [[nodiscard]] CacheMemoryStats getMemoryStats() const;
+
+    /// @brief Snapshot of cache, disk and latency statistics
+    [[nodiscard]] StorageStats getStats() const;
+
+    /// @brief Append getStats() as a JSON line to a file every interval until stopped or destroyed
+    void startStatsReporter(const std::string& path, std::chrono::milliseconds interval = std::chrono::seconds(10));
+
+    /// @brief Stop the periodic writer after a final sample
+    void stopStatsReporter();
+
     /// @brief Get cache statistics
     void printStats() const;
 
@@ -44,24 +93,57 @@ public:
     void flushCache();
 
 private:
+    /// @brief Sums a WriteOnlyDelta node held when it was read from the database, which its spill must not add again
+    struct Baseline {
+        std::vector<float> regretSum;
+        std::vector<float> strategySum;
+    };
+
+    struct BaselineShard {
+        std::mutex mutex;
+        std::unordered_map<std::string, Baseline> baselines;
+    };
+
+    static constexpr size_t NUM_BASELINE_SHARDS = 32;
+
     void onCacheEviction(const std::string& key, std::shared_ptr<Node> node);
+    /// @brief Write a node back, WriteOnlyDelta rounds merge what it gained over its baseline
+    /// @param keepCached The node stays cached, so its baseline moves up to the value just written instead of being dropped
+    void spill(const std::string& infoSet, const std::shared_ptr<Node>& node, bool keepCached);
+    /// @brief Cache a node read from the database, remembering its sums as the baseline in WriteOnlyDelta rounds
+    /// @details A node read while a checkpoint is written is left out of it, the pinned database already holds it
+    void promote(const std::string& infoSet, const std::shared_ptr<Node>& node);
+    [[nodiscard]] BaselineShard& baselineShard(const std::string& infoSet);
+    void clearBaselines();
+    [[nodiscard]] std::unique_ptr<CacheType> makeCache(size_t cacheBudgetBytes);
 
     std::unique_ptr<CacheType> m_cache;
     std::unique_ptr<RocksDBNodeStorage> m_storage;
+
+    std::array<BaselineShard, NUM_BASELINE_SHARDS> m_baselines;
+    uint64_t m_nodesAtOpen = 0;
+    std::atomic<int64_t> m_nodesCreated{0};
+    LatencyHistogram m_spillLatency;
+    LatencyHistogram m_flushLatency;
+    std::unique_ptr<StatsReporter> m_statsReporter;
 };
 
 // Template implementation
 template<typename CacheType>
-HybridNodeStorage<CacheType>::HybridNodeStorage(size_t cacheCapacity, const std::string& dbPath) {
+HybridNodeStorage<CacheType>::HybridNodeStorage(size_t cacheBudgetBytes, const std::string& dbPath, RocksDBStorageOptions options) {
     // Create RocksDB storage first
-    m_storage = std::make_unique<RocksDBNodeStorage>(dbPath);
-    
+    m_storage = std::make_unique<RocksDBNodeStorage>(dbPath, std::move(options));
+    m_nodesAtOpen = m_storage->size();
+    m_cache = makeCache(cacheBudgetBytes);
+}
+
+template<typename CacheType>
+std::unique_ptr<CacheType> HybridNodeStorage<CacheType>::makeCache(size_t cacheBudgetBytes) {
     // Create cache with eviction callback
     auto evictionCallback = [this](const std::string& key, std::shared_ptr<Node> node) {
         this->onCacheEviction(key, node);
     };
-    
-    m_cache = std::make_unique<CacheType>(cacheCapacity, evictionCallback);
+    return std::make_unique<CacheType>(cacheBudgetBytes, evictionCallback);
 }
 
 template<typename CacheType>
@@ -71,23 +153,118 @@ std::shared_ptr<Node> HybridNodeStorage<CacheType>::getNode(const std::string& i
     if (node) {
         return node;
     }
-    
+
     // If not in cache, check persistent storage
     node = m_storage->getNode(infoSet);
     if (node) {
-        // Promote to cache
-        m_cache->putNode(infoSet, node);
+        promote(infoSet, node);
     }
     
     return node;
 }
 
 template<typename CacheType>
-void HybridNodeStorage<CacheType>::putNode(const std::string& infoSet, std::shared_ptr<Node> node) {
-    // Always put in cache first
+std::optional<std::shared_ptr<Node>> HybridNodeStorage<CacheType>::tryGetNode(const std::string& infoSet) {
+    if (auto node = m_cache->getNode(infoSet)) {
+        return node;
+    }
+    return std::nullopt;
+}
+
+template<typename CacheType>
+void HybridNodeStorage<CacheType>::admitNode(const std::string& infoSet, const std::shared_ptr<Node>& node) {
+    // Another traversal may have created or loaded the node while the read was in flight, keep that copy
+    if (node && !m_cache->hasNode(infoSet)) {
+        promote(infoSet, node);
+    }
+}
+
+template<typename CacheType>
+void HybridNodeStorage<CacheType>::getNodes(std::span<const std::string> infoSets, std::span<std::shared_ptr<Node>> out) {
+    std::vector<size_t> missIndices;
+    std::vector<std::string> missKeys;
+    for (size_t i = 0; i < infoSets.size(); ++i) {
+        out[i] = m_cache->getNode(infoSets[i]);
+        if (!out[i]) {
+            missIndices.push_back(i);
+            missKeys.push_back(infoSets[i]);
+        }
+    }
+    if (missKeys.empty()) {
+        return;
+    }
+
+    std::vector<std::shared_ptr<Node>> stored(missKeys.size());
+    m_storage->getNodes(missKeys, stored);
+    for (size_t j = 0; j < missKeys.size(); ++j) {
+        if (stored[j]) {
+            promote(missKeys[j], stored[j]);
+            out[missIndices[j]] = std::move(stored[j]);
+        }
+    }
+}
+
+template<typename CacheType>
+void HybridNodeStorage<CacheType>::promote(const std::string& infoSet, const std::shared_ptr<Node>& node) {
+    if (m_storage->spillPolicy(infoSet) == SpillPolicy::WriteOnlyDelta) {
+        BaselineShard& shard = baselineShard(infoSet);
+        std::lock_guard lock(shard.mutex);
+        shard.baselines[infoSet] = Baseline{node->getRegretSum(), node->getStrategySum()};
+    }
+    if (m_capture.active()) {
+        m_capture.exclude(*node);
+    }
     m_cache->putNode(infoSet, node);
 }
 
+template<typename CacheType>
+typename HybridNodeStorage<CacheType>::BaselineShard& HybridNodeStorage<CacheType>::baselineShard(const std::string& infoSet) {
+    return m_baselines[std::hash<std::string>{}(infoSet) % NUM_BASELINE_SHARDS];
+}
+
+template<typename CacheType>
+void HybridNodeStorage<CacheType>::clearBaselines() {
+    for (BaselineShard& shard : m_baselines) {
+        std::lock_guard lock(shard.mutex);
+        shard.baselines.clear();
+    }
+}
+
+template<typename CacheType>
+std::shared_ptr<Node> HybridNodeStorage<CacheType>::readNode(const std::string& infoSet) {
+    // A cached node holds its whole value in every round, the database copy may lag behind it
+    if (auto cached = m_cache->getNode(infoSet)) {
+        return cached;
+    }
+    return m_storage->getNode(infoSet);
+}
+
+template<typename CacheType>
+void HybridNodeStorage<CacheType>::forEachNode(const std::function<void(const std::string&, const std::shared_ptr<Node>&)>& visit) const {
+    std::unordered_set<std::string> cached;
+    m_cache->forEachNode([&](const std::string& infoSet, const std::shared_ptr<Node>& node) {
+        cached.insert(infoSet);
+        visit(infoSet, node);
+    });
+    m_storage->forEachNode([&](const std::string& infoSet, const std::shared_ptr<Node>& node) {
+        if (!cached.contains(infoSet)) {
+            visit(infoSet, node);
+        }
+    });
+}
+
+template<typename CacheType>
+void HybridNodeStorage<CacheType>::putNode(const std::string& infoSet, std::shared_ptr<Node> node) {
+    // Callers put a node after getNode found it in neither the cache nor the database, so a key new to the cache is a
+    // new node. The cache decides that under its own lock, two threads creating the same node count it once
+    if (m_capture.active()) {
+        m_capture.exclude(*node);
+    }
+    if (m_cache->insertOrAssign(infoSet, std::move(node))) {
+        m_nodesCreated.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
 template<typename CacheType>
 bool HybridNodeStorage<CacheType>::hasNode(const std::string& infoSet) const {
     return m_cache->hasNode(infoSet) || m_storage->hasNode(infoSet);
@@ -95,19 +272,26 @@ bool HybridNodeStorage<CacheType>::hasNode(const std::string& infoSet) const {
 
 template<typename CacheType>
 void HybridNodeStorage<CacheType>::removeNode(const std::string& infoSet) {
+    if (hasNode(infoSet)) {
+        m_nodesCreated.fetch_sub(1, std::memory_order_relaxed);
+    }
     m_cache->removeNode(infoSet);
     m_storage->removeNode(infoSet);
 }
 
 template<typename CacheType>
 size_t HybridNodeStorage<CacheType>::size() const {
-    return m_cache->size() + m_storage->size();
+    const int64_t total = static_cast<int64_t>(m_nodesAtOpen) + m_nodesCreated.load(std::memory_order_relaxed);
+    return static_cast<size_t>(std::max<int64_t>(total, 0));
 }
 
 template<typename CacheType>
 void HybridNodeStorage<CacheType>::clear() {
     m_cache->clear();
     m_storage->clear();
+    clearBaselines();
+    m_nodesAtOpen = 0;
+    m_nodesCreated.store(0, std::memory_order_relaxed);
 }
 
 template<typename CacheType>
@@ -115,21 +299,61 @@ double HybridNodeStorage<CacheType>::getCacheHitRate() const {
     return m_cache->getHitRate();
 }
 
+template<typename CacheType>
+CacheMemoryStats HybridNodeStorage<CacheType>::getMemoryStats() const {
+    return m_cache->getMemoryStats();
+}
+
+template<typename CacheType>
+StorageStats HybridNodeStorage<CacheType>::getStats() const {
+    StorageStats stats;
+    stats.nodes = size();
+    stats.cache = m_cache->getCounters();
+    stats.memory = m_cache->getMemoryStats();
+    stats.disk = m_storage->getDiskStats();
+    stats.spillLatency = m_spillLatency.snapshot();
+    stats.flushLatency = m_flushLatency.snapshot();
+    return stats;
+}
+
+template<typename CacheType>
+void HybridNodeStorage<CacheType>::startStatsReporter(const std::string& path, std::chrono::milliseconds interval) {
+    m_statsReporter.reset();
+    m_statsReporter = std::make_unique<StatsReporter>([this] { return getStats(); }, path, interval);
+}
+
+template<typename CacheType>
+void HybridNodeStorage<CacheType>::stopStatsReporter() {
+    m_statsReporter.reset();
+}
+
 template<typename CacheType>
 void HybridNodeStorage<CacheType>::printStats() const {
-    std::cout << "Cache Hit Rate: " << (getCacheHitRate() * 100.0) << "%\n";
-    std::cout << "Cache Size: " << m_cache->size() << " nodes\n";
-    std::cout << "Storage Size: " << m_storage->size() << " nodes\n";
+    constexpr double mebibyte = 1024.0 * 1024.0;
+    const StorageStats stats = getStats();
+    std::cout << "Cache Hit Rate: " << (stats.hitRate() * 100.0) << "%\n";
+    std::cout << "Cache Size: " << stats.memory.entries << " nodes, " << stats.cache.evictions << " evictions\n";
+    std::cout << "Cache Memory: " << stats.memory.usedBytes / mebibyte << " / " << stats.memory.budgetBytes / mebibyte
+              << " MiB (" << (stats.memory.utilization() * 100.0) << "%)\n";
+    std::cout << "Storage Size: " << stats.nodes << " nodes\n";
+    std::cout << "Disk: " << stats.disk.bytesRead / mebibyte << " MiB read, " << stats.disk.bytesWritten / mebibyte
+              << " MiB written, " << stats.disk.pendingCompactionBytes / mebibyte << " MiB pending compaction, "
+              << stats.disk.stallCount << " write stalls\n";
 }
 
 template<typename CacheType>
 HybridNodeStorage<CacheType>::~HybridNodeStorage() {
+    // The reporter samples this object, stop it before anything is torn down
+    m_statsReporter.reset();
     flush();
 }
 
 template<typename CacheType>
 void HybridNodeStorage<CacheType>::flush() {
-    m_cache->flush();
+    LatencyHistogram::ScopedTimer timer(m_flushLatency);
+    m_cache->forEachNode([this](const std::string& infoSet, const std::shared_ptr<Node>& node) {
+        spill(infoSet, node, true);
+    });
 }
 
 template<typename CacheType>
@@ -137,10 +361,103 @@ void HybridNodeStorage<CacheType>::flushCache() {
     flush();
 }
 
+template<typename CacheType>
+std::function<void()> HybridNodeStorage<CacheType>::captureSnapshot(const std::filesystem::path& dir) {
+    // Every node is either cached or in the database, the cache holding the newer value. A sharded cache can be walked
+    // while it is trained, others are pinned here
+    constexpr bool walkLater = requires(CacheType& cache) { cache.forEachShard([](NodeCapture::Entries&) {}); };
+    auto cached = std::make_shared<NodeCapture::Entries>();
+    if constexpr (!walkLater) {
+        m_cache->forEachNode([&cached](const std::string& infoSet, const std::shared_ptr<Node>& node) {
+            cached->emplace_back(infoSet, node);
+        });
+    }
+    m_capture.begin();
+    return [this, cached, stored = m_storage->snapshot(), path = dir / "rocksdb"]() mutable {
+        NodeCapture::Guard guard{m_capture};
+        // released when the job ends rather than with the job object, which can outlive a restore of m_storage
+        const auto pinned = std::move(stored);
+        const auto entries = std::move(cached);
+
+        RocksDBNodeStorage copy(path.string(), m_storage->options());
+        m_storage->forEachNode(pinned.get(), [&copy](const std::string& infoSet, const std::shared_ptr<Node>& node) {
+            copy.putNode(infoSet, node);
+        });
+        const auto overlay = [this, &copy](NodeCapture::Entries& part) {
+            for (const auto& [infoSet, node] : part) {
+                if (std::optional<std::string> record = m_capture.take(*node)) {
+                    copy.putNode(infoSet, NodeSerializer::deserialize(*record));
+                }
+            }
+        };
+        if constexpr (walkLater) {
+            m_cache->forEachShard(overlay);
+        } else {
+            overlay(*entries);
+        }
+        // nodes evicted since the capture began, their spills went to the live database only
+        for (const auto& [infoSet, record] : m_capture.takeDeparted()) {
+            copy.putNode(infoSet, NodeSerializer::deserialize(record));
+        }
+    };
+}
+
+template<typename CacheType>
+void HybridNodeStorage<CacheType>::restoreSnapshot(const std::filesystem::path& dir) {
+    // The old cache's nodes belong to the state being replaced, destroying it does not spill them
+    m_cache = makeCache(m_cache->getMemoryStats().budgetBytes);
+    clearBaselines();
+
+    const std::filesystem::path path = m_storage->path();
+    RocksDBStorageOptions options = m_storage->options();
+    m_storage.reset();
+    std::filesystem::remove_all(path);
+    std::filesystem::copy(dir / "rocksdb", path, std::filesystem::copy_options::recursive);
+    m_storage = std::make_unique<RocksDBNodeStorage>(path.string(), std::move(options));
+    m_nodesAtOpen = m_storage->size();
+    m_nodesCreated = 0;
+}
+
 template<typename CacheType>
 void HybridNodeStorage<CacheType>::onCacheEviction(const std::string& key, std::shared_ptr<Node> node) {
+    LatencyHistogram::ScopedTimer timer(m_spillLatency);
+    if (m_capture.active()) {
+        m_capture.depart(key, *node);
+    }
     // Save evicted node to persistent storage
-    m_storage->putNode(key, node);
+    spill(key, node, false);
+}
+
+template<typename CacheType>
+void HybridNodeStorage<CacheType>::spill(const std::string& infoSet, const std::shared_ptr<Node>& node, bool keepCached) {
+    if (m_storage->spillPolicy(infoSet) == SpillPolicy::ReadThrough) {
+        m_storage->putNode(infoSet, node);
+        return;
+    }
+
+    // Only the gain since the value was read or last spilled is merged, the database already holds the rest
+    std::vector<float> regretSum = node->getRegretSum();
+    std::vector<float> strategySum = node->getStrategySum();
+    {
+        BaselineShard& shard = baselineShard(infoSet);
+        std::lock_guard lock(shard.mutex);
+        const auto it = shard.baselines.find(infoSet);
+        if (it != shard.baselines.end() && it->second.regretSum.size() == regretSum.size()) {
+            for (size_t i = 0; i < regretSum.size(); ++i) {
+                regretSum[i] -= it->second.regretSum[i];
+                strategySum[i] -= it->second.strategySum[i];
+            }
+        }
+        if (keepCached) {
+            shard.baselines[infoSet] = Baseline{node->getRegretSum(), node->getStrategySum()};
+        } else if (it != shard.baselines.end()) {
+            shard.baselines.erase(it);
+        }
+    }
+    Node delta(static_cast<uint8_t>(regretSum.size()));
+    delta.setRegretSum(regretSum);
+    delta.setStrategySum(strategySum);
+    m_storage->mergeNode(infoSet, delta);
 }
 
 } // namespace CFR
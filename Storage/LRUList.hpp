@@ -23,9 +23,9 @@ public:
     m_list.splice(m_list.begin(), m_list, it);
     };
 
-    iterator emplace_front(std::string infoset, std::shared_ptr<CFR::Node>&& node)
+    iterator emplace_front(std::string infoset, std::shared_ptr<CFR::Node>&& node, size_t bytes)
     {
-        m_list.emplace_front(infoset, std::move(node));
+        m_list.emplace_front(std::move(infoset), std::move(node), bytes);
         return m_list.begin();
     }
 
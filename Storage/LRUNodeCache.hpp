@@ -12,15 +12,19 @@
 #include <mutex>
 
 #include "NodeStorage.hpp"
+#include "CacheMemory.hpp"
+#include "StorageStats.hpp"
 
 namespace CFR {
     struct CacheEntry {
         std::string key;
         std::shared_ptr<Node> node;
+        /// @brief bytes charged against the cache budget for this entry
+        size_t bytes{};
 
         CacheEntry() = default;
-        CacheEntry(std::string k, std::shared_ptr<Node> n)
-            : key(std::move(k)), node(std::move(n)) {}
+        CacheEntry(std::string k, std::shared_ptr<Node> n, size_t b)
+            : key(std::move(k)), node(std::move(n)), bytes(b) {}
 };
 template< template<typename mapKey, typename mapValue> typename CacheMap, template<typename CacheListObject> typename CacheList>
 class LRUNodeCache : public NodeStorage {
@@ -28,9 +32,9 @@ public:
     /// @brief Callback function for evicted nodes which probably means send them to disk
     using EvictionCallback = std::function<void(const std::string&, std::shared_ptr<Node>)>;
 
-    /// @param capacity Maximum number of nodes to keep in cache
+    /// @param budgetBytes Maximum bytes of keys, nodes and bookkeeping to keep in cache
     /// @param evictionCallback Optional callback when nodes are evicted
-    explicit LRUNodeCache(size_t capacity, EvictionCallback evictionCallback = nullptr);
+    explicit LRUNodeCache(size_t budgetBytes, EvictionCallback evictionCallback = nullptr);
 
     ~LRUNodeCache() override = default;
 
@@ -38,9 +42,23 @@ public:
     void putNode(const std::string& infoSet, std::shared_ptr<Node> node) override;
     bool hasNode(const std::string& infoSet) const override;
     void removeNode(const std::string& infoSet) override;
+    void prefetch(const std::string& infoSet) const override { prefetchBucket(m_cacheMap, infoSet); }
+    /// @details Holds the map lock for the whole walk, evicted nodes are not visited
+    void forEachNode(const std::function<void(const std::string&, const std::shared_ptr<Node>&)>& visit) const override {
+        std::shared_lock lock(m_mapMutex);
+        for (const auto& [infoSet, entry] : m_cacheMap) {
+            visit(infoSet, entry->node);
+        }
+    }
+
+    /// @brief putNode that tells whether the key was new to the cache
+    bool insertOrAssign(const std::string& infoSet, std::shared_ptr<Node> node);
 
     std::shared_ptr<Node> getNodeSafe(const std::string& infoSet);
-    void putNodeSafe(const std::string& infoSet, std::shared_ptr<Node> node);
+    void prefetchSafe(const std::string& infoSet) const;
+    void putNodeSafe(const std::string& infoSet, std::shared_ptr<Node> node) { insertOrAssignSafe(infoSet, std::move(node)); }
+    /// @brief putNodeSafe that tells whether the key was new to the cache, decided under the same lock as the insert
+    bool insertOrAssignSafe(const std::string& infoSet, std::shared_ptr<Node> node);
     bool hasNodeSafe(const std::string& infoSet) const;
     void removeNodeSafe(const std::string& infoSet);
     void clearSafe();
@@ -53,22 +71,34 @@ public:
     /// @brief Get current cache hit rate
     double getHitRate() const;
 
+    /// @brief Hits, misses and evictions since the last reset
+    [[nodiscard]] CacheCounters getCounters() const;
+
     /// @brief Reset hit/miss statistics
     void resetStats();
 
     /// @brief Flush all cached nodes to disk using eviction callback
     void flush();
 
+    /// @brief Bytes in use versus the configured budget, safe to call while other threads use the cache
+    [[nodiscard]] CacheMemoryStats getMemoryStats() const;
+
+    /// @brief Bytes charged for one entry: both key copies, the list and map nodes, and the node allocation
+    [[nodiscard]] static size_t entryBytes(const std::string& key, const std::shared_ptr<Node>& node);
+
 private:
 
     void evictLRU();
-    size_t m_capacity;
+    void insertEntry(const std::string& infoSet, std::shared_ptr<Node> node);
+    size_t m_budgetBytes;
+    std::atomic<size_t> m_usedBytes{0};
     CacheList<CacheEntry> m_cacheList{};
     CacheMap<std::string, typename CacheList<CacheEntry>::iterator> m_cacheMap{};
     EvictionCallback m_evictionCallback;
 
     std::atomic<uint64_t> m_hits{0};
     std::atomic<uint64_t> m_misses{0};
+    std::atomic<uint64_t> m_evictions{0};
     mutable std::shared_mutex m_mapMutex;
     mutable std::shared_mutex m_listMutex;
 };
@@ -76,13 +106,35 @@ private:
 
 
 template< template<typename mapKey, typename mapValue> typename CacheMap, template<typename CacheListObject> typename CacheList>
-LRUNodeCache<CacheMap,CacheList>::LRUNodeCache(size_t capacity, EvictionCallback evictionCallback)
-    : m_capacity(capacity), m_evictionCallback(std::move(evictionCallback)) {
-    if (m_capacity == 0) {
-        throw std::invalid_argument("Cache capacity must be greater than 0");
+LRUNodeCache<CacheMap,CacheList>::LRUNodeCache(size_t budgetBytes, EvictionCallback evictionCallback)
+    : m_budgetBytes(budgetBytes), m_evictionCallback(std::move(evictionCallback)) {
+    if (m_budgetBytes == 0) {
+        throw std::invalid_argument("Cache budget must be greater than 0 bytes");
     }
 }
 
+template< template<typename mapKey, typename mapValue> typename CacheMap, template<typename CacheListObject> typename CacheList>
+size_t LRUNodeCache<CacheMap,CacheList>::entryBytes(const std::string& key, const std::shared_ptr<Node>& node) {
+    // list node: two links around the entry, map node: next link, key, list iterator and cached hash, plus a bucket slot
+    constexpr size_t listNode = 2 * sizeof(void*) + sizeof(CacheEntry) + CacheMemory::AllocationOverhead;
+    constexpr size_t mapNode = sizeof(void*) + sizeof(std::string) + sizeof(void*) + sizeof(size_t) + CacheMemory::AllocationOverhead;
+    constexpr size_t bucket = sizeof(void*);
+    const size_t nodeBytes = node ? CacheMemory::heapBytes(*node) : 0;
+    return listNode + mapNode + bucket + 2 * CacheMemory::heapBytes(key) + nodeBytes;
+}
+
+template< template<typename mapKey, typename mapValue> typename CacheMap, template<typename CacheListObject> typename CacheList>
+void LRUNodeCache<CacheMap,CacheList>::insertEntry(const std::string& infoSet, std::shared_ptr<Node> node) {
+    const size_t bytes = entryBytes(infoSet, node);
+    while (!m_cacheList.empty() && m_usedBytes.load(std::memory_order_relaxed) + bytes > m_budgetBytes) {
+        evictLRU();
+    }
+    //put node in front of list and its iterator into map
+    auto list_it = m_cacheList.emplace_front(infoSet, std::move(node), bytes);
+    m_cacheMap[infoSet] = list_it;
+    m_usedBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
 template< template<typename mapKey, typename mapValue> typename CacheMap, template<typename CacheListObject> typename CacheList>
 std::shared_ptr<Node> LRUNodeCache<CacheMap,CacheList>::getNode(const std::string& infoSet) {
     auto it = m_cacheMap.find(infoSet);
@@ -101,21 +153,26 @@ std::shared_ptr<Node> LRUNodeCache<CacheMap,CacheList>::getNode(const std::strin
 
 template< template<typename mapKey, typename mapValue> typename CacheMap, template<typename CacheListObject> typename CacheList>
 void LRUNodeCache<CacheMap,CacheList>::putNode(const std::string& infoSet, std::shared_ptr<Node> node) {
+    insertOrAssign(infoSet, std::move(node));
+}
+
+template< template<typename mapKey, typename mapValue> typename CacheMap, template<typename CacheListObject> typename CacheList>
+bool LRUNodeCache<CacheMap,CacheList>::insertOrAssign(const std::string& infoSet, std::shared_ptr<Node> node) {
     auto it = m_cacheMap.find(infoSet);
     if (it != m_cacheMap.end()) {
-        // Update existing entry and move to front
+        // Update existing entry, recharge its bytes and move to front
+        const size_t bytes = entryBytes(infoSet, node);
+        m_usedBytes.fetch_add(bytes, std::memory_order_relaxed);
+        m_usedBytes.fetch_sub(it->second->bytes, std::memory_order_relaxed);
+        it->second->bytes = bytes;
         it->second->node = std::move(node);
         m_cacheList.move_to_front(it->second);
-        return;
+        return false;
     }
 
-    // Add new entry
-    if (m_cacheMap.size() >= m_capacity) {
-        evictLRU();
-    }
-    //put node in front of list and its iterator into map
-    auto list_it = m_cacheList.emplace_front(infoSet, std::move(node));
-    m_cacheMap[infoSet] = list_it;
+    // Add new entry, evicting from the back until it fits the budget
+    insertEntry(infoSet, std::move(node));
+    return true;
 }
 
 template< template<typename mapKey, typename mapValue> typename CacheMap, template<typename CacheListObject> typename CacheList>
@@ -130,6 +187,7 @@ void LRUNodeCache<CacheMap,CacheList>::removeNode(const std::string& infoSet) {
         return;
     }
 
+    m_usedBytes.fetch_sub(it->second->bytes, std::memory_order_relaxed);
     m_cacheList.erase(it->second);
     m_cacheMap.erase(it);
 }
@@ -154,26 +212,33 @@ std::shared_ptr<Node> LRUNodeCache<CacheMap,CacheList>::getNodeSafe(const std::s
 }
 
 template< template<typename mapKey, typename mapValue> typename CacheMap, template<typename CacheListObject> typename CacheList>
-void LRUNodeCache<CacheMap,CacheList>::putNodeSafe(const std::string& infoSet, std::shared_ptr<Node> node) {
+bool LRUNodeCache<CacheMap,CacheList>::insertOrAssignSafe(const std::string& infoSet, std::shared_ptr<Node> node) {
     std::unique_lock uniqueMapLock(m_mapMutex);
     auto it = m_cacheMap.find(infoSet);
     if (it != m_cacheMap.end()) {
-        // Update existing entry and move to front
+        // Update existing entry, recharge its bytes and move to front
+        const size_t bytes = entryBytes(infoSet, node);
+        m_usedBytes.fetch_add(bytes, std::memory_order_relaxed);
+        m_usedBytes.fetch_sub(it->second->bytes, std::memory_order_relaxed);
+        it->second->bytes = bytes;
         it->second->node = std::move(node);
         std::unique_lock listMutex(m_listMutex);
         m_cacheList.move_to_front(it->second);
-        return;
+        return false;
     }
     std::unique_lock listMutex(m_listMutex);
-    // Add new entry
-    if (m_cacheMap.size() >= m_capacity) {
-        evictLRU();
-    }
-    //put node in front of list and its iterator into map
-
-    auto list_it = m_cacheList.emplace_front(infoSet, std::move(node));
+    // Add new entry, evicting from the back until it fits the budget
+    insertEntry(infoSet, std::move(node));
+    return true;
+}
 
-    m_cacheMap[infoSet] = list_it;
+template< template<typename mapKey, typename mapValue> typename CacheMap, template<typename CacheListObject> typename CacheList>
+void LRUNodeCache<CacheMap,CacheList>::prefetchSafe(const std::string& infoSet) const {
+    // skip rather than wait when a writer holds the map, a prefetch is only a hint
+    std::shared_lock lock(m_mapMutex, std::try_to_lock);
+    if (lock.owns_lock()) {
+        prefetchBucket(m_cacheMap, infoSet);
+    }
 }
 
 template< template<typename mapKey, typename mapValue> typename CacheMap, template<typename CacheListObject> typename CacheList>
@@ -191,6 +256,7 @@ void LRUNodeCache<CacheMap,CacheList>::removeNodeSafe(const std::string& infoSet
     }
 
     std::unique_lock listLock(m_listMutex);
+    m_usedBytes.fetch_sub(it->second->bytes, std::memory_order_relaxed);
     m_cacheList.erase(it->second);
     m_cacheMap.erase(it);
 }
@@ -210,6 +276,7 @@ void LRUNodeCache<CacheMap,CacheList>::clear() {
 
     m_cacheList.clear();
     m_cacheMap.clear();
+    m_usedBytes.store(0, std::memory_order_relaxed);
 }
 
 template< template<typename mapKey, typename mapValue> typename CacheMap, template<typename CacheListObject> typename CacheList>
@@ -226,6 +293,7 @@ void LRUNodeCache<CacheMap,CacheList>::clearSafe() {
     std::unique_lock uniqueLock(m_mapMutex);
     m_cacheList.clear();
     m_cacheMap.clear();
+    m_usedBytes.store(0, std::memory_order_relaxed);
 }
 template< template<typename mapKey, typename mapValue> typename CacheMap, template<typename CacheListObject> typename CacheList>
 double LRUNodeCache<CacheMap,CacheList>::getHitRate() const {
@@ -240,6 +308,13 @@ template< template<typename mapKey, typename mapValue> typename CacheMap, templa
 void LRUNodeCache<CacheMap,CacheList>::resetStats() {
     m_hits.store(0, std::memory_order_relaxed);
     m_misses.store(0, std::memory_order_relaxed);
+    m_evictions.store(0, std::memory_order_relaxed);
+}
+
+template< template<typename mapKey, typename mapValue> typename CacheMap, template<typename CacheListObject> typename CacheList>
+CacheCounters LRUNodeCache<CacheMap,CacheList>::getCounters() const {
+    return CacheCounters{m_hits.load(std::memory_order_relaxed), m_misses.load(std::memory_order_relaxed),
+                         m_evictions.load(std::memory_order_relaxed)};
 }
 
 template< template<typename mapKey, typename mapValue> typename CacheMap, template<typename CacheListObject> typename CacheList>
@@ -254,6 +329,8 @@ void LRUNodeCache<CacheMap,CacheList>::evictLRU() {
         m_evictionCallback(lastEntry.key, lastEntry.node);
     }
 
+    m_usedBytes.fetch_sub(lastEntry.bytes, std::memory_order_relaxed);
+    m_evictions.fetch_add(1, std::memory_order_relaxed);
     m_cacheMap.erase(lastEntry.key);
     m_cacheList.pop_back();
 }
@@ -276,6 +353,14 @@ void LRUNodeCache<CacheMap,CacheList>::flushSafe() {
         m_evictionCallback(pair.first, pair.second->node);
     }
 }
+
+template< template<typename mapKey, typename mapValue> typename CacheMap, template<typename CacheListObject> typename CacheList>
+CacheMemoryStats LRUNodeCache<CacheMap,CacheList>::getMemoryStats() const {
+    // stats reporters call this while workers insert and evict, the map is only safe to size under the lock
+    std::shared_lock lock(m_mapMutex);
+    return {m_usedBytes.load(std::memory_order_relaxed), m_budgetBytes, m_cacheMap.size()};
+}
+
 } // namespace CFR
 
 #endif //LRUNODECACHE_HPP
@@ -0,0 +1,106 @@
+#ifndef LATENCYHISTOGRAM_HPP
+#define LATENCYHISTOGRAM_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+
+namespace CFR {
+
+/// @brief Lock-free histogram of durations in power of two nanosecond buckets
+class LatencyHistogram {
+public:
+    /// @brief Bucket 0 holds zero, bucket i holds [2^(i-1), 2^i) ns, the last bucket also takes anything longer
+    static constexpr size_t BucketCount = 48;
+
+    struct Snapshot {
+        uint64_t count = 0;
+        uint64_t sumNanos = 0;
+        uint64_t maxNanos = 0;
+        std::array<uint64_t, BucketCount> buckets{};
+
+        [[nodiscard]] double meanNanos() const {
+            return count > 0 ? static_cast<double>(sumNanos) / static_cast<double>(count) : 0.0;
+        }
+
+        /// @brief Upper bound of the bucket holding the q-th quantile, q in [0, 1]
+        [[nodiscard]] uint64_t percentileNanos(double q) const {
+            if (count == 0) {
+                return 0;
+            }
+            const auto rank = static_cast<uint64_t>(q * static_cast<double>(count - 1)) + 1;
+            uint64_t seen = 0;
+            for (size_t i = 0; i < BucketCount; ++i) {
+                seen += buckets[i];
+                if (seen >= rank) {
+                    return i == 0 ? 0 : std::min<uint64_t>(uint64_t{1} << i, maxNanos);
+                }
+            }
+            return maxNanos;
+        }
+    };
+
+    /// @brief Times the enclosing scope into a histogram
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(LatencyHistogram& histogram)
+            : m_histogram(histogram), m_start(std::chrono::steady_clock::now()) {}
+
+        ~ScopedTimer() {
+            m_histogram.record(std::chrono::steady_clock::now() - m_start);
+        }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        LatencyHistogram& m_histogram;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    void record(uint64_t nanos) noexcept {
+        const size_t bucket = std::min<size_t>(std::bit_width(nanos), BucketCount - 1);
+        m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+        m_sum.fetch_add(nanos, std::memory_order_relaxed);
+        uint64_t previous = m_max.load(std::memory_order_relaxed);
+        while (previous < nanos && !m_max.compare_exchange_weak(previous, nanos, std::memory_order_relaxed)) {}
+    }
+
+    void record(std::chrono::nanoseconds duration) noexcept {
+        record(static_cast<uint64_t>(std::max<int64_t>(duration.count(), 0)));
+    }
+
+    [[nodiscard]] Snapshot snapshot() const {
+        Snapshot result;
+        for (size_t i = 0; i < BucketCount; ++i) {
+            result.buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+        }
+        result.count = m_count.load(std::memory_order_relaxed);
+        result.sumNanos = m_sum.load(std::memory_order_relaxed);
+        result.maxNanos = m_max.load(std::memory_order_relaxed);
+        return result;
+    }
+
+    void reset() noexcept {
+        for (auto& bucket : m_buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        m_count.store(0, std::memory_order_relaxed);
+        m_sum.store(0, std::memory_order_relaxed);
+        m_max.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, BucketCount> m_buckets{};
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<uint64_t> m_sum{0};
+    std::atomic<uint64_t> m_max{0};
+};
+
+} // namespace CFR
+
+#endif //LATENCYHISTOGRAM_HPP
@@ -18,11 +18,17 @@ public:
 
     // NodeStorage interface
     std::shared_ptr<Node> getNode(const std::string& infoSet) override;
+    void prefetch(const std::string& infoSet) const override { prefetchBucket(m_nodeMap, infoSet); }
     void putNode(const std::string& infoSet, std::shared_ptr<Node> node) override;
     bool hasNode(const std::string& infoSet) const override;
     void removeNode(const std::string& infoSet) override;
     size_t size() const override;
     void clear() override;
+    void forEachNode(const std::function<void(const std::string&, const std::shared_ptr<Node>&)>& visit) const override {
+        for (const auto& [infoSet, node] : m_nodeMap) {
+            visit(infoSet, node);
+        }
+    }
     void flushCache(){}
 
 private:
@@ -0,0 +1,122 @@
+#include "NodeCapture.hpp"
+
+#include <thread>
+
+#include "NodeSerializer.hpp"
+
+namespace CFR {
+namespace {
+
+/// Shared by every capture, so a node moved between storages never carries an epoch that looks current
+std::atomic<uint32_t> nextEpoch{2};
+
+} // namespace
+
+NodeCapture::~NodeCapture() {
+    end();
+}
+
+void NodeCapture::begin() {
+    if (!m_state) {
+        m_state = std::make_unique<State>();
+    }
+    end();
+    uint32_t epoch = 0;
+    // 0 is the epoch of a node that has never been captured
+    while (epoch == 0) {
+        epoch = nextEpoch.fetch_add(2, std::memory_order_relaxed);
+    }
+    m_epoch.store(epoch, std::memory_order_relaxed);
+    m_active.store(true, std::memory_order_release);
+}
+
+void NodeCapture::end() {
+    m_active.store(false, std::memory_order_release);
+    if (!m_state) {
+        return;
+    }
+    // the state is kept for the next capture, a preserve() racing with this finds the capture inactive under the lock
+    for (Shard& shard : m_state->shards) {
+        std::lock_guard lock(shard.mutex);
+        shard.preserved.clear();
+    }
+    std::lock_guard lock(m_state->departedMutex);
+    m_state->departed.clear();
+}
+
+bool NodeCapture::claim(Node& node) const {
+    const uint32_t epoch = m_epoch.load(std::memory_order_relaxed);
+    uint32_t seen = node.captureEpoch.load(std::memory_order_acquire);
+    while (true) {
+        if (seen == epoch) {
+            return false;
+        }
+        if (seen == epoch + 1) {
+            std::this_thread::yield();
+            seen = node.captureEpoch.load(std::memory_order_acquire);
+        } else if (node.captureEpoch.compare_exchange_weak(seen, epoch + 1, std::memory_order_acquire)) {
+            return true;
+        }
+    }
+}
+
+void NodeCapture::release(Node& node) const {
+    node.captureEpoch.store(m_epoch.load(std::memory_order_relaxed), std::memory_order_release);
+}
+
+NodeCapture::Shard& NodeCapture::shardFor(const Node& node) const {
+    return m_state->shards[std::hash<const Node*>{}(&node) % State::NUM_SHARDS];
+}
+
+void NodeCapture::preserve(const std::shared_ptr<Node>& node) {
+    if (!active() || !claim(*node)) {
+        return;
+    }
+    std::string record = NodeSerializer::serialize(*node);
+    {
+        Shard& shard = shardFor(*node);
+        std::lock_guard lock(shard.mutex);
+        if (active()) {
+            shard.preserved.insert_or_assign(node.get(), std::make_pair(node, std::move(record)));
+        }
+    }
+    release(*node);
+}
+
+void NodeCapture::exclude(Node& node) {
+    node.captureEpoch.store(m_epoch.load(std::memory_order_relaxed), std::memory_order_release);
+}
+
+std::optional<std::string> NodeCapture::take(Node& node) {
+    if (claim(node)) {
+        std::string record = NodeSerializer::serialize(node);
+        release(node);
+        return record;
+    }
+    Shard& shard = shardFor(node);
+    std::lock_guard lock(shard.mutex);
+    const auto it = shard.preserved.find(&node);
+    if (it == shard.preserved.end()) {
+        return std::nullopt;
+    }
+    std::string record = std::move(it->second.second);
+    shard.preserved.erase(it);
+    return record;
+}
+
+void NodeCapture::depart(const std::string& infoSet, Node& node) {
+    if (!active()) {
+        return;
+    }
+    if (std::optional<std::string> record = take(node)) {
+        std::lock_guard lock(m_state->departedMutex);
+        m_state->departed.emplace_back(infoSet, std::move(*record));
+    }
+}
+
+std::vector<std::pair<std::string, std::string>> NodeCapture::takeDeparted() {
+    std::lock_guard lock(m_state->departedMutex);
+    return std::exchange(m_state->departed, {});
+}
+
+} // namespace CFR
@@ -0,0 +1,93 @@
+#ifndef NODECAPTURE_HPP
+#define NODECAPTURE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../CFR/Node.hpp"
+
+namespace CFR {
+
+/// @brief Copy-on-write view of a storage's nodes as they stood when a checkpoint was taken
+///
+/// begin() is called while nothing touches the nodes and costs no more than a clear. Afterwards the checkpoint writer
+/// copies nodes through take() while training carries on, and a trainer that is about to change a node first calls
+/// preserve(), which keeps the value the node had at begin(). Whichever of the two reaches a node first serializes it,
+/// the other waits at most for that one node. Nodes are claimed through Node::captureEpoch, so untouched nodes cost
+/// nothing and a node is serialized once however often it changes.
+class NodeCapture {
+public:
+    /// @brief Key and node pairs, a capture takes them in parts so no lock is held over a whole storage
+    using Entries = std::vector<std::pair<std::string, std::shared_ptr<Node>>>;
+
+    NodeCapture() = default;
+    ~NodeCapture();
+
+    NodeCapture(const NodeCapture&) = delete;
+    NodeCapture& operator=(const NodeCapture&) = delete;
+
+    /// @brief Start a capture of every node that exists now, call it while the nodes are not being changed
+    void begin();
+
+    /// @brief Finish the capture and drop the values it still holds
+    void end();
+
+    /// @brief Ends the capture when the writer leaves scope, whether or not it finished
+    struct Guard {
+        NodeCapture& capture;
+        ~Guard() { capture.end(); }
+    };
+
+    [[nodiscard]] bool active() const { return m_active.load(std::memory_order_acquire); }
+
+    /// @brief Keep the node's value for the capture before it is changed, a no-op once it has been copied
+    void preserve(const std::shared_ptr<Node>& node);
+
+    /// @brief Leave a node created or loaded after begin() out of the capture
+    void exclude(Node& node);
+
+    /// @brief Serialized value the node had at begin(), nullopt if it was excluded or already taken
+    [[nodiscard]] std::optional<std::string> take(Node& node);
+
+    /// @brief Take the node's value as it leaves the storage, e.g. on eviction, for takeDeparted to hand out
+    void depart(const std::string& infoSet, Node& node);
+
+    /// @brief Key and serialized value of every node that left the storage since begin()
+    [[nodiscard]] std::vector<std::pair<std::string, std::string>> takeDeparted();
+
+private:
+    /// @brief Preserved values, keyed by node address. The node is pinned so its address cannot be reused
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<const Node*, std::pair<std::shared_ptr<Node>, std::string>> preserved;
+    };
+
+    struct State {
+        static constexpr size_t NUM_SHARDS = 32;
+        std::array<Shard, NUM_SHARDS> shards;
+        std::mutex departedMutex;
+        std::vector<std::pair<std::string, std::string>> departed;
+    };
+
+    /// @brief Claim an unclaimed node, waiting while the other side serializes it. False once it was claimed
+    [[nodiscard]] bool claim(Node& node) const;
+    void release(Node& node) const;
+    [[nodiscard]] Shard& shardFor(const Node& node) const;
+
+    std::atomic<bool> m_active{false};
+    /// @brief Even epoch of the running capture, a node holding epoch + 1 is being serialized
+    std::atomic<uint32_t> m_epoch{0};
+    std::unique_ptr<State> m_state;
+};
+
+} // namespace CFR
+
+#endif //NODECAPTURE_HPP
@@ -0,0 +1,15 @@
+#include "NodeMergeOperator.hpp"
+
+#include <string_view>
+
+#include "NodeSerializer.hpp"
+
+namespace CFR {
+
+bool NodeMergeOperator::Merge(const rocksdb::Slice& /*key*/, const rocksdb::Slice* existing_value, const rocksdb::Slice& value,
+                              std::string* new_value, rocksdb::Logger* /*logger*/) const {
+    const std::string_view existing = existing_value ? std::string_view(existing_value->data(), existing_value->size()) : std::string_view();
+    return NodeSerializer::merge(existing, std::string_view(value.data(), value.size()), *new_value);
+}
+
+} // namespace CFR
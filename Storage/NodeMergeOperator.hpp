@@ -0,0 +1,19 @@
+#ifndef NODEMERGEOPERATOR_HPP
+#define NODEMERGEOPERATOR_HPP
+
+#include <rocksdb/merge_operator.h>
+
+namespace CFR {
+
+/// @brief Sums Delta node records onto the stored value inside RocksDB, so updates can be spilled without reading first
+class NodeMergeOperator final : public rocksdb::AssociativeMergeOperator {
+public:
+    bool Merge(const rocksdb::Slice& key, const rocksdb::Slice* existing_value, const rocksdb::Slice& value,
+               std::string* new_value, rocksdb::Logger* logger) const override;
+
+    [[nodiscard]] const char* Name() const override { return "CFR.NodeMergeOperator"; }
+};
+
+} // namespace CFR
+
+#endif //NODEMERGEOPERATOR_HPP
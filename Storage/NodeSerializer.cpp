@@ -4,87 +4,302 @@
 
 #include "NodeSerializer.hpp"
 
+#include <algorithm>
+#include <bit>
+#include <cmath>
 #include <cstring>
 #include <stdexcept>
 
 namespace CFR {
+namespace {
 
-std::string NodeSerializer::serialize(const Node& node) {
+constexpr size_t varintSize(uint32_t value) {
+    size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+char* writeVarint(char* ptr, uint32_t value) {
+    while (value >= 0x80) {
+        *ptr++ = static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    *ptr++ = static_cast<char>(value);
+    return ptr;
+}
+
+/// @return pointer past the varint, nullptr if it runs off the end of the buffer
+const char* readVarint(const char* ptr, const char* end, uint32_t& value) {
+    value = 0;
+    for (int shift = 0; ptr < end && shift < 32; shift += 7) {
+        const auto byte = static_cast<uint8_t>(*ptr++);
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return ptr;
+        }
+    }
+    return nullptr;
+}
+
+uint16_t floatToHalf(float value) {
+    const auto bits = std::bit_cast<uint32_t>(value);
+    const auto sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+    const uint32_t abs = bits & 0x7FFFFFFF;
+
+    if (abs > 0x7F800000) {
+        return sign | 0x7E00; // NaN
+    }
+    if (abs >= 0x477FF000) {
+        return sign | 0x7BFF; // would round past 65504, saturate rather than store an infinity that poisons regret matching
+    }
+    if (abs < 0x38800000) {
+        // subnormal half, units of 2^-24, nearbyint rounds half to even
+        const auto units = static_cast<uint16_t>(std::nearbyint(std::bit_cast<float>(abs) * 16777216.F));
+        return sign | units;
+    }
+    // rebias the exponent from 127 to 15 and round the 13 dropped mantissa bits to nearest even
+    const uint32_t rounded = abs - 0x38000000 + 0x0FFF + ((abs >> 13) & 1);
+    return sign | static_cast<uint16_t>(rounded >> 13);
+}
+
+float halfToFloat(uint16_t half) {
+    const uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+    const uint32_t exponent = (half >> 10) & 0x1F;
+    const uint32_t mantissa = half & 0x3FF;
+
+    if (exponent == 0) {
+        const float magnitude = static_cast<float>(mantissa) / 16777216.F;
+        return sign ? -magnitude : magnitude;
+    }
+    if (exponent == 0x1F) {
+        return std::bit_cast<float>(sign | 0x7F800000 | (mantissa << 13));
+    }
+    return std::bit_cast<float>(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+uint16_t floatToBFloat16(float value) {
+    const auto bits = std::bit_cast<uint32_t>(value);
+    if ((bits & 0x7FFFFFFF) > 0x7F800000) {
+        return static_cast<uint16_t>((bits >> 16) | 0x40); // keep NaN quiet after truncation
+    }
+    return static_cast<uint16_t>((bits + 0x7FFF + ((bits >> 16) & 1)) >> 16);
+}
+
+float bfloat16ToFloat(uint16_t value) {
+    return std::bit_cast<float>(static_cast<uint32_t>(value) << 16);
+}
+
+size_t vectorBytes(uint8_t actionNum, NodeSerializer::Encoding encoding) {
+    switch (encoding) {
+        case NodeSerializer::Encoding::Float32:
+            return actionNum * sizeof(float);
+        case NodeSerializer::Encoding::Float16:
+        case NodeSerializer::Encoding::BFloat16:
+            return actionNum * sizeof(uint16_t);
+        case NodeSerializer::Encoding::Int16Scaled:
+            return sizeof(float) + actionNum * sizeof(int16_t);
+    }
+    throw std::invalid_argument("Unknown node encoding");
+}
+
+char* encodeVector(char* ptr, const std::vector<float>& values, NodeSerializer::Encoding encoding) {
+    const size_t count = values.size();
+    switch (encoding) {
+        case NodeSerializer::Encoding::Float32:
+            std::memcpy(ptr, values.data(), count * sizeof(float));
+            return ptr + count * sizeof(float);
+
+        case NodeSerializer::Encoding::Float16:
+        case NodeSerializer::Encoding::BFloat16:
+            for (const float value : values) {
+                const uint16_t encoded = encoding == NodeSerializer::Encoding::Float16 ? floatToHalf(value) : floatToBFloat16(value);
+                std::memcpy(ptr, &encoded, sizeof(encoded));
+                ptr += sizeof(encoded);
+            }
+            return ptr;
+
+        case NodeSerializer::Encoding::Int16Scaled: {
+            float maxAbs = 0.F;
+            for (const float value : values) {
+                maxAbs = std::max(maxAbs, std::abs(value));
+            }
+            const float scale = maxAbs / 32767.F;
+            std::memcpy(ptr, &scale, sizeof(scale));
+            ptr += sizeof(scale);
+            for (const float value : values) {
+                const auto quantized = static_cast<int16_t>(scale > 0.F ? std::lround(value / scale) : 0);
+                std::memcpy(ptr, &quantized, sizeof(quantized));
+                ptr += sizeof(quantized);
+            }
+            return ptr;
+        }
+    }
+    throw std::invalid_argument("Unknown node encoding");
+}
+
+/// @brief Decode straight into the node's own buffer, which already has the right size
+const char* decodeVector(const char* ptr, std::vector<float>& out, NodeSerializer::Encoding encoding) {
+    const size_t count = out.size();
+    switch (encoding) {
+        case NodeSerializer::Encoding::Float32:
+            std::memcpy(out.data(), ptr, count * sizeof(float));
+            return ptr + count * sizeof(float);
+
+        case NodeSerializer::Encoding::Float16:
+        case NodeSerializer::Encoding::BFloat16:
+            for (size_t i = 0; i < count; ++i) {
+                uint16_t encoded;
+                std::memcpy(&encoded, ptr, sizeof(encoded));
+                ptr += sizeof(encoded);
+                out[i] = encoding == NodeSerializer::Encoding::Float16 ? halfToFloat(encoded) : bfloat16ToFloat(encoded);
+            }
+            return ptr;
+
+        case NodeSerializer::Encoding::Int16Scaled: {
+            float scale;
+            std::memcpy(&scale, ptr, sizeof(scale));
+            ptr += sizeof(scale);
+            for (size_t i = 0; i < count; ++i) {
+                int16_t quantized;
+                std::memcpy(&quantized, ptr, sizeof(quantized));
+                ptr += sizeof(quantized);
+                out[i] = static_cast<float>(quantized) * scale;
+            }
+            return ptr;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+size_t NodeSerializer::serializedSize(uint8_t actionNum, Encoding encoding) {
+    return 2 + varintSize(actionNum) + 2 * vectorBytes(actionNum, encoding);
+}
+
+std::string NodeSerializer::serialize(const Node& node, Encoding encoding, RecordKind kind) {
     const auto& regretSum = node.getRegretSum();
-    const auto& strategy = node.getStrategy();
     const auto& strategySum = node.getStrategySum();
-    const auto& averageStrategy = node.getAverageStrategy();
-    
+
     uint8_t actionNum = static_cast<uint8_t>(regretSum.size());
-    
-    // Calculate total size needed
-    size_t totalSize = sizeof(SerializedNode) + 4 * actionNum * sizeof(float);
-    
-    std::string result(totalSize, '\0');
+
+    std::string result(serializedSize(actionNum, encoding), '\0');
     char* ptr = result.data();
-    
-    SerializedNode header{actionNum};
-    std::memcpy(ptr, &header, sizeof(SerializedNode));
-    ptr += sizeof(SerializedNode);
-    
-    std::memcpy(ptr, regretSum.data(), actionNum * sizeof(float));
-    ptr += actionNum * sizeof(float);
-    
-    std::memcpy(ptr, strategy.data(), actionNum * sizeof(float));
-    ptr += actionNum * sizeof(float);
-    
-    std::memcpy(ptr, strategySum.data(), actionNum * sizeof(float));
-    ptr += actionNum * sizeof(float);
-    
-    std::memcpy(ptr, averageStrategy.data(), actionNum * sizeof(float));
-    
+
+    *ptr++ = static_cast<char>(Magic);
+    *ptr++ = static_cast<char>((Version << 4) | (static_cast<uint8_t>(kind) << 3) | static_cast<uint8_t>(encoding));
+    ptr = writeVarint(ptr, actionNum);
+
+    ptr = encodeVector(ptr, regretSum, encoding);
+    encodeVector(ptr, strategySum, encoding);
+
     return result;
 }
 
-std::shared_ptr<Node> NodeSerializer::deserialize(const std::string& data) {
+std::shared_ptr<Node> NodeSerializer::deserialize(std::string_view data) {
+    // A Delta with nothing beneath it is the increment over a freshly created node, whose sums are zero
+    DecodedRecord record;
+    return decode(data, record) ? record.node : nullptr;
+}
+
+bool NodeSerializer::merge(std::string_view existing, std::string_view update, std::string& result) {
+    DecodedRecord incoming;
+    if (!decode(update, incoming)) {
+        return false;
+    }
+
+    DecodedRecord base;
+    if (incoming.kind == RecordKind::Full || existing.empty() || !decode(existing, base)
+        || base.node->actionNum != incoming.node->actionNum) {
+        result.assign(update);
+        return true;
+    }
+
+    for (size_t i = 0; i < base.node->regretSum.size(); ++i) {
+        base.node->regretSum[i] += incoming.node->regretSum[i];
+        base.node->strategySum[i] += incoming.node->strategySum[i];
+    }
+    // Delta onto Delta stays a Delta until a Full record is reached
+    result = serialize(*base.node, base.encoding, base.kind);
+    return true;
+}
+
+bool NodeSerializer::decode(std::string_view data, DecodedRecord& record) {
+    record = DecodedRecord{};
+    if (data.size() < 3 || static_cast<uint8_t>(data[0]) != Magic) {
+        record.node = deserializeLegacy(data);
+        return record.node != nullptr;
+    }
+
+    const auto header = static_cast<uint8_t>(data[1]);
+    const auto encodingValue = static_cast<uint8_t>(header & 0x07);
+    if ((header >> 4) != Version || encodingValue > static_cast<uint8_t>(Encoding::Int16Scaled)) {
+        record.node = deserializeLegacy(data);
+        return record.node != nullptr;
+    }
+    record.encoding = static_cast<Encoding>(encodingValue);
+    record.kind = static_cast<RecordKind>((header >> 3) & 1);
+
+    uint32_t actionNum;
+    const char* ptr = readVarint(data.data() + 2, data.data() + data.size(), actionNum);
+    if (ptr == nullptr || actionNum > UINT8_MAX
+        || data.size() != serializedSize(static_cast<uint8_t>(actionNum), record.encoding)) {
+        record = DecodedRecord{};
+        record.node = deserializeLegacy(data);
+        return record.node != nullptr;
+    }
+
+    auto node = std::make_shared<Node>(static_cast<uint8_t>(actionNum));
+
+    ptr = decodeVector(ptr, node->regretSum, record.encoding);
+    decodeVector(ptr, node->strategySum, record.encoding);
+
+    // Recalculate the derived vectors
+    node->calcUpdatedStrategy();
+    node->calcAverageStrategy();
+
+    record.node = std::move(node);
+    return true;
+}
+
+std::shared_ptr<Node> NodeSerializer::deserializeLegacy(std::string_view data) {
     if (data.size() < sizeof(SerializedNode)) {
         return nullptr;
     }
-    
+
     const char* ptr = data.data();
-    
+
     SerializedNode header;
     std::memcpy(&header, ptr, sizeof(SerializedNode));
     ptr += sizeof(SerializedNode);
-    
+
     uint8_t actionNum = header.actionNum;
-    
+
     size_t expectedSize = sizeof(SerializedNode) + 4 * actionNum * sizeof(float);
     if (data.size() != expectedSize) {
         return nullptr;
     }
-    
+
     auto node = std::make_shared<Node>(actionNum);
-    
-    // Read and restore data
-    std::vector<float> regretSum(actionNum);
-    std::memcpy(regretSum.data(), ptr, actionNum * sizeof(float));
+
+    std::memcpy(node->regretSum.data(), ptr, actionNum * sizeof(float));
     ptr += actionNum * sizeof(float);
-    
+
     // Skip strategy - it will be recalculated
     ptr += actionNum * sizeof(float);
-    
-    std::vector<float> strategySum(actionNum);
-    std::memcpy(strategySum.data(), ptr, actionNum * sizeof(float));
+
+    std::memcpy(node->strategySum.data(), ptr, actionNum * sizeof(float));
     ptr += actionNum * sizeof(float);
-    
-    std::vector<float> averageStrategy(actionNum);
-    std::memcpy(averageStrategy.data(), ptr, actionNum * sizeof(float));
-    
-    // Restore node state
-    node->setRegretSum(regretSum);
-    node->setStrategySum(strategySum);
-    node->setAverageStrategy(averageStrategy);
-    
+
+    std::memcpy(node->averageStrategy.data(), ptr, actionNum * sizeof(float));
+
     // Recalculate current strategy
     node->calcUpdatedStrategy();
-    
+
     return node;
 }
 
-} // namespace CFR
\ No newline at end of file
+} // namespace CFR
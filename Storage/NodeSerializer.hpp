@@ -6,30 +6,77 @@
 #define NODESERIALIZER_HPP
 #include <cstdint>
 #include <memory>
+#include <string>
+#include <string_view>
 
 #include "../CFR/Node.hpp"
 
 namespace CFR {
 
 /// @brief Utility class for serializing and deserializing Node objects
+///
+/// Record layout (version 1):
+///   [0xCF magic][version << 4 | kind << 3 | encoding][varint actionNum][regretSum][strategySum]
+/// Only the cumulative sums are stored, strategy and averageStrategy are recomputed on load.
+/// Delta records hold increments that merge() adds onto the record below them.
+/// Int16Scaled prefixes each vector with its float scale. Values are written in host byte order.
+/// Records from the original raw float format (four float vectors, no header) are still readable.
 class NodeSerializer {
 public:
+    /// @brief Element encoding of the stored vectors
+    enum class Encoding : uint8_t {
+        Float32 = 0,     ///< lossless
+        Float16 = 1,     ///< IEEE half precision, 11 significant bits, clamps to +-65504
+        BFloat16 = 2,    ///< float32 range with 8 significant bits
+        Int16Scaled = 3  ///< int16 per element plus one float scale per vector
+    };
+
+    /// @brief Whether a record replaces or adds to the value stored before it
+    enum class RecordKind : uint8_t {
+        Full = 0,
+        Delta = 1
+    };
+
+    static constexpr uint8_t Magic = 0xCF;
+    static constexpr uint8_t Version = 1;
+
     /// @brief Serialize a Node to a binary string
     /// @param node The node to serialize
+    /// @param encoding How regretSum and strategySum are stored
+    /// @param kind Full for the node's value, Delta when the sums are increments to add onto the stored value
     /// @return Serialized binary data as string
-    static std::string serialize(const Node& node);
-    
-    /// @brief Deserialize a Node from binary string
-    /// @param data The serialized binary data
+    static std::string serialize(const Node& node, Encoding encoding = Encoding::Float32, RecordKind kind = RecordKind::Full);
+
+    /// @brief Deserialize a Node from binary data
+    /// @param data The serialized binary data, in either the current or the legacy format
     /// @return Shared pointer to deserialized Node, nullptr on error
-    static std::shared_ptr<Node> deserialize(const std::string& data);
+    static std::shared_ptr<Node> deserialize(std::string_view data);
+
+    /// @brief Fold an update record onto an existing one, a Full update replaces and a Delta update adds its sums
+    /// @param existing Previous record, empty when there is none
+    /// @param update Record being applied
+    /// @param result Receives the merged record, in the encoding of the existing record
+    /// @return False if the update can't be decoded
+    static bool merge(std::string_view existing, std::string_view update, std::string& result);
+
+    /// @brief Bytes serialize() produces for a node with the given number of actions
+    [[nodiscard]] static size_t serializedSize(uint8_t actionNum, Encoding encoding);
 
 private:
     struct SerializedNode {
         uint8_t actionNum;
-        // Followed by actionNum * sizeof(float) bytes for each vector
+        // Legacy format: followed by actionNum * sizeof(float) bytes for each vector
         // Order: regretSum, strategy, strategySum, averageStrategy
     };
+
+    struct DecodedRecord {
+        std::shared_ptr<Node> node;
+        Encoding encoding = Encoding::Float32;
+        RecordKind kind = RecordKind::Full;
+    };
+
+    static bool decode(std::string_view data, DecodedRecord& record);
+    static std::shared_ptr<Node> deserializeLegacy(std::string_view data);
 };
 
 } // CFR
@@ -0,0 +1,99 @@
+#include "NodeSnapshot.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include "NodeSerializer.hpp"
+
+namespace CFR {
+namespace {
+
+template<typename T>
+void writeValue(std::ofstream& out, T value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template<typename T>
+T readValue(std::ifstream& in) {
+    T value{};
+    in.read(reinterpret_cast<char*>(&value), sizeof(value));
+    return value;
+}
+
+std::string readBytes(std::ifstream& in, uint32_t length) {
+    std::string bytes(length, '\0');
+    in.read(bytes.data(), length);
+    return bytes;
+}
+
+} // namespace
+
+NodeSnapshot::NodeSnapshot(std::filesystem::path path)
+    : m_path(std::move(path)), m_temporary(m_path) {
+    m_temporary += ".tmp";
+    m_out.open(m_temporary, std::ios::binary | std::ios::trunc);
+    if (!m_out) {
+        throw std::runtime_error("Failed to create node snapshot " + m_temporary.string());
+    }
+    m_out.write(Tag.data(), static_cast<std::streamsize>(Tag.size()));
+    // patched by commit once the count is known
+    writeValue<uint64_t>(m_out, 0);
+}
+
+NodeSnapshot::~NodeSnapshot() {
+    if (!m_committed) {
+        m_out.close();
+        std::error_code ignored;
+        std::filesystem::remove(m_temporary, ignored);
+    }
+}
+
+void NodeSnapshot::add(const std::string& infoSet, const std::string& record) {
+    writeValue<uint32_t>(m_out, static_cast<uint32_t>(infoSet.size()));
+    m_out.write(infoSet.data(), static_cast<std::streamsize>(infoSet.size()));
+    writeValue<uint32_t>(m_out, static_cast<uint32_t>(record.size()));
+    m_out.write(record.data(), static_cast<std::streamsize>(record.size()));
+    ++m_count;
+}
+
+void NodeSnapshot::commit() {
+    m_out.seekp(static_cast<std::streamoff>(Tag.size()));
+    writeValue<uint64_t>(m_out, m_count);
+    m_out.close();
+    if (!m_out) {
+        throw std::runtime_error("Failed to write node snapshot " + m_temporary.string());
+    }
+    std::filesystem::rename(m_temporary, m_path);
+    m_committed = true;
+}
+
+void NodeSnapshot::read(const std::filesystem::path& path, const std::function<void(const std::string&, std::shared_ptr<Node>)>& visit) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Failed to open node snapshot " + path.string());
+    }
+    if (readBytes(in, static_cast<uint32_t>(Tag.size())) != Tag) {
+        throw std::runtime_error("Not a node snapshot: " + path.string());
+    }
+    const auto count = readValue<uint64_t>(in);
+    for (uint64_t i = 0; i < count && in; ++i) {
+        const std::string key = readBytes(in, readValue<uint32_t>(in));
+        const std::string record = readBytes(in, readValue<uint32_t>(in));
+        if (!in) {
+            break;
+        }
+        std::shared_ptr<Node> node = NodeSerializer::deserialize(record);
+        if (!node) {
+            throw std::runtime_error("Corrupt node record in snapshot " + path.string());
+        }
+        visit(key, std::move(node));
+    }
+    if (!in) {
+        throw std::runtime_error("Truncated node snapshot " + path.string());
+    }
+}
+
+} // namespace CFR
@@ -0,0 +1,56 @@
+#ifndef NODESNAPSHOT_HPP
+#define NODESNAPSHOT_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "../CFR/Node.hpp"
+
+namespace CFR {
+
+/// @brief Node snapshot file, written one record at a time so a snapshot never has to be held in memory
+///
+/// File layout: the 8 byte tag "CFRSNAP1", a uint64 record count, then per node a uint32 key length, the key,
+/// a uint32 record length and a NodeSerializer record. Integers are in host byte order like the records themselves.
+class NodeSnapshot {
+public:
+    static constexpr std::string_view Tag = "CFRSNAP1";
+
+    /// @brief Start writing a snapshot for path into a temporary file beside it
+    /// @throws std::runtime_error if the temporary file cannot be created
+    explicit NodeSnapshot(std::filesystem::path path);
+
+    /// @brief Removes the temporary file of a snapshot that was never committed
+    ~NodeSnapshot();
+
+    NodeSnapshot(const NodeSnapshot&) = delete;
+    NodeSnapshot& operator=(const NodeSnapshot&) = delete;
+
+    /// @brief Append a node already serialized with NodeSerializer
+    void add(const std::string& infoSet, const std::string& record);
+
+    [[nodiscard]] uint64_t size() const { return m_count; }
+
+    /// @brief Fill in the record count and rename the file into place, so a partial file is never left at path
+    /// @throws std::runtime_error if a write failed
+    void commit();
+
+    /// @brief Read a snapshot file, calling visit for each node
+    /// @throws std::runtime_error if the file is missing, truncated or not a snapshot
+    static void read(const std::filesystem::path& path, const std::function<void(const std::string&, std::shared_ptr<Node>)>& visit);
+
+private:
+    std::filesystem::path m_path;
+    std::filesystem::path m_temporary;
+    std::ofstream m_out;
+    uint64_t m_count = 0;
+    bool m_committed = false;
+};
+
+} // namespace CFR
+
+#endif //NODESNAPSHOT_HPP
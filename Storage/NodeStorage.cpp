@@ -0,0 +1,26 @@
+#include "NodeStorage.hpp"
+
+namespace CFR {
+
+std::function<void()> NodeStorage::captureSnapshot(const std::filesystem::path& dir) {
+    // Copying the pointers is all that happens paused, storage in general cannot be walked while it is trained
+    auto entries = std::make_shared<NodeCapture::Entries>();
+    entries->reserve(size());
+    forEachNode([&entries](const std::string& infoSet, const std::shared_ptr<Node>& node) {
+        entries->emplace_back(infoSet, node);
+    });
+    m_capture.begin();
+    return [this, entries, path = dir / "nodes.snapshot"] {
+        NodeCapture::Guard guard{m_capture};
+        NodeSnapshot snapshot(path);
+        for (auto& [infoSet, node] : *entries) {
+            if (std::optional<std::string> record = m_capture.take(*node)) {
+                snapshot.add(infoSet, *record);
+            }
+            node.reset();
+        }
+        snapshot.commit();
+    };
+}
+
+} // namespace CFR
@@ -5,9 +5,16 @@
 #ifndef NODESTORAGE_HPP
 #define NODESTORAGE_HPP
 
+#include <filesystem>
+#include <functional>
 #include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
 #include <string>
 #include "../CFR/Node.hpp"
+#include "NodeCapture.hpp"
+#include "NodeSnapshot.hpp"
 
 namespace CFR {
 
@@ -21,6 +28,33 @@ public:
     /// @return Shared pointer to the node, nullptr if not found
     virtual std::shared_ptr<Node> getNode(const std::string& infoSet) = 0;
 
+    /// @brief Look up several nodes in one request
+    /// @param infoSets The information set keys
+    /// @param out Receives the node for each key, nullptr where it is not found. Must be as long as infoSets
+    /// @details Looks each key up in turn, backends with a batched read path override it
+    virtual void getNodes(std::span<const std::string> infoSets, std::span<std::shared_ptr<Node>> out) {
+        for (size_t i = 0; i < infoSets.size(); ++i) {
+            out[i] = getNode(infoSets[i]);
+        }
+    }
+
+    /// @brief Look a node up only if that can be done without waiting on I/O
+    /// @return The node, or nullptr when it does not exist. nullopt when answering needs a blocking read through loadNode
+    /// @details Storage that never blocks always answers, which is the default
+    virtual std::optional<std::shared_ptr<Node>> tryGetNode(const std::string& infoSet) { return getNode(infoSet); }
+
+    /// @brief Blocking read from the backing store for a key tryGetNode could not answer
+    /// @details May run on an I/O thread concurrently with the trainer, so it must not touch unsynchronised state.
+    /// The result is handed back to the trainer's thread, which passes it to admitNode
+    virtual std::shared_ptr<Node> loadNode(const std::string& infoSet) { return getNode(infoSet); }
+
+    /// @brief Take in a node produced by loadNode, e.g. by promoting it into a cache
+    virtual void admitNode(const std::string& infoSet, const std::shared_ptr<Node>& node) { (void)infoSet; (void)node; }
+
+    /// @brief Hint that infoSet will be looked up soon so its entry can be pulled toward the CPU cache
+    /// @details Never blocks and never changes what a later lookup returns, the default does nothing
+    virtual void prefetch(const std::string& infoSet) const { (void)infoSet; }
+
     /// @brief Store a node with the given information set key
     /// @param infoSet The information set string key
     /// @param node The node to store
@@ -41,7 +75,57 @@ public:
 
     /// @brief Clear all nodes from storage
     virtual void clear() = 0;
+
+    /// @brief Visit every stored node, storage that cannot enumerate its nodes throws std::logic_error
+    virtual void forEachNode(const std::function<void(const std::string&, const std::shared_ptr<Node>&)>& visit) const {
+        (void)visit;
+        throw std::logic_error("This storage cannot enumerate its nodes");
+    }
+
+    /// @brief Take a consistent copy of every node for a checkpoint in dir
+    /// @details Called while nothing else touches storage. The returned job writes the copy into dir and is run on a
+    /// background thread while training carries on, the storage must outlive it. The default records which nodes
+    /// exist, without copying them, and the job serializes each through the capture, so nodes changed meanwhile are
+    /// written with the value they had here as long as their changes go through beforeUpdate.
+    virtual std::function<void()> captureSnapshot(const std::filesystem::path& dir);
+
+    /// @brief Replace every node with those of a checkpoint written through captureSnapshot
+    virtual void restoreSnapshot(const std::filesystem::path& dir) {
+        clear();
+        NodeSnapshot::read(dir / "nodes.snapshot", [this](const std::string& infoSet, std::shared_ptr<Node> node) {
+            putNode(infoSet, std::move(node));
+        });
+    }
+
+    /// @brief Call before changing a node in place, so a checkpoint being written keeps the value it was taken with
+    void beforeUpdate(const std::shared_ptr<Node>& node) {
+        if (m_capture.active()) [[unlikely]] {
+            m_capture.preserve(node);
+        }
+    }
+
+protected:
+    /// @brief Point-in-time view of the nodes while a captureSnapshot job runs
+    NodeCapture m_capture;
 };
 
+/// @brief Prefetch the first entry of the bucket a key hashes to, for maps that expose their buckets
+/// @details Hashing and reading the bucket array happen now, the chain entry that usually misses is fetched in the background
+template<typename Map>
+void prefetchBucket(const Map& map, const typename Map::key_type& key) {
+    if constexpr (requires { map.bucket(key); map.begin(map.bucket(key)); }) {
+        if (map.bucket_count() == 0) {
+            return;
+        }
+        const auto bucket = map.bucket(key);
+        const auto it = map.begin(bucket);
+        if (it != map.end(bucket)) {
+#if defined(__GNUC__) || defined(__clang__)
+            __builtin_prefetch(&*it);
+#endif
+        }
+    }
+}
+
 } // namespace CFR
 #endif //NODESTORAGE_HPP
@@ -4,44 +4,177 @@
 
 #include "RocksDBNodeStorage.hpp"
 
+#include <algorithm>
+#include <cctype>
 #include <iostream>
 #include <rocksdb/table.h>
 #include <rocksdb/filter_policy.h>
-#include "NodeSerializer.hpp"
+#include <rocksdb/statistics.h>
+#include "NodeMergeOperator.hpp"
 
 namespace CFR {
-RocksDBNodeStorage::RocksDBNodeStorage(std::string  dbPath) : m_dbPath(std::move(dbPath)) {
-    const rocksdb::Options options = getDefaultOptions();
-    rocksdb::DB* db;
+RocksDBNodeStorage::RocksDBNodeStorage(std::string  dbPath, RocksDBStorageOptions options)
+    : m_dbPath(std::move(dbPath)), m_options(std::move(options)) {
+    if (m_options.rounds.empty()) {
+        throw std::invalid_argument("RocksDB storage needs at least one round column family");
+    }
 
-    if (rocksdb::Status status = rocksdb::DB::Open(options, m_dbPath, &db); !status.ok()) {
-        throw std::runtime_error("Failed to open RocksDB: " + status.ToString());
+    rocksdb::DBOptions dbOptions = getDefaultDBOptions();
+    m_statistics = rocksdb::CreateDBStatistics();
+    dbOptions.statistics = m_statistics;
+
+    // Every family already in the database has to be opened, unknown ones keep default tuning
+    std::vector<std::string> existing;
+    if (!rocksdb::DB::ListColumnFamilies(dbOptions, m_dbPath, &existing).ok()) {
+        existing.clear();
     }
 
+    std::vector<rocksdb::ColumnFamilyDescriptor> descriptors;
+    descriptors.emplace_back(rocksdb::kDefaultColumnFamilyName, getColumnFamilyOptions(ColumnFamilyConfig{}));
+    for (const ColumnFamilyConfig& round : m_options.rounds) {
+        descriptors.emplace_back(round.name, getColumnFamilyOptions(round));
+    }
+    for (const std::string& name : existing) {
+        const bool known = std::ranges::any_of(descriptors, [&](const auto& d) { return d.name == name; });
+        if (!known) {
+            descriptors.emplace_back(name, getColumnFamilyOptions(ColumnFamilyConfig{}));
+        }
+    }
+
+    rocksdb::DB* db;
+    if (rocksdb::Status status = rocksdb::DB::Open(dbOptions, m_dbPath, descriptors, &m_handles, &db); !status.ok()) {
+        throw std::runtime_error("Failed to open RocksDB: " + status.ToString());
+    }
     m_db.reset(db);
+
+    m_roundFamilies.assign(m_handles.begin() + 1, m_handles.begin() + 1 + static_cast<std::ptrdiff_t>(m_options.rounds.size()));
+
+    // Databases written before the per-round split keep every node in the default family
+    std::unique_ptr<rocksdb::Iterator> it(m_db->NewIterator(rocksdb::ReadOptions(), m_db->DefaultColumnFamily()));
+    it->SeekToFirst();
+    m_legacyDefault = it->Valid();
+
     std::cout << std::format("DB Size: {}", this->size()) << std::endl;
 }
 
 RocksDBNodeStorage::~RocksDBNodeStorage() {
     if (m_db) {
+        for (rocksdb::ColumnFamilyHandle* handle : m_handles) {
+            m_db->DestroyColumnFamilyHandle(handle);
+        }
         m_db->Close();
     }
 }
 
+size_t RocksDBNodeStorage::bettingRound(std::string_view infoSet) {
+    size_t pos = 0;
+    while (pos < infoSet.size() && std::isdigit(static_cast<unsigned char>(infoSet[pos]))) {
+        ++pos;
+    }
+
+    size_t round = 0;
+    size_t actionsThisRound = 0;
+    bool lastWasCheck = false;
+    while (pos + 1 < infoSet.size()) {
+        const std::string_view token = infoSet.substr(pos, 2);
+        pos += 2;
+        while (pos < infoSet.size() && std::isdigit(static_cast<unsigned char>(infoSet[pos]))) {
+            ++pos;
+        }
+
+        const bool limp = token == "Ca" && round == 0 && actionsThisRound == 0;
+        const bool closesRound = (token == "Ca" && !limp) || (token == "Ch" && (round == 0 || lastWasCheck));
+        if (closesRound) {
+            ++round;
+            actionsThisRound = 0;
+            lastWasCheck = false;
+        } else {
+            ++actionsThisRound;
+            lastWasCheck = token == "Ch";
+        }
+    }
+    return round;
+}
+
+size_t RocksDBNodeStorage::roundIndex(std::string_view infoSet) const {
+    return std::min(bettingRound(infoSet), m_roundFamilies.size() - 1);
+}
+
+rocksdb::ColumnFamilyHandle* RocksDBNodeStorage::familyFor(std::string_view infoSet) const {
+    return m_roundFamilies[roundIndex(infoSet)];
+}
+
+SpillPolicy RocksDBNodeStorage::spillPolicy(std::string_view infoSet) const {
+    return m_options.rounds[roundIndex(infoSet)].spillPolicy;
+}
+
 std::shared_ptr<Node> RocksDBNodeStorage::getNode(const std::string& infoSet) {
 
     if (!m_db) {
         return nullptr;
     }
 
-    std::string value;
-    rocksdb::Status status = m_db->Get(rocksdb::ReadOptions(), infoSet, &value);
+    // Pinned value decodes straight out of the block cache without an intermediate copy
+    rocksdb::PinnableSlice value;
+    rocksdb::Status status;
+    {
+        LatencyHistogram::ScopedTimer timer(m_readLatency);
+        status = m_db->Get(rocksdb::ReadOptions(), familyFor(infoSet), infoSet, &value);
+
+        if (status.IsNotFound() && m_legacyDefault) {
+            value.Reset();
+            status = m_db->Get(rocksdb::ReadOptions(), m_db->DefaultColumnFamily(), infoSet, &value);
+        }
+    }
+    m_reads.fetch_add(1, std::memory_order_relaxed);
 
     if (!status.ok()) {
+        m_readMisses.fetch_add(1, std::memory_order_relaxed);
         return nullptr;
     }
 
-    return NodeSerializer::deserialize(value);
+    m_bytesRead.fetch_add(value.size(), std::memory_order_relaxed);
+    return NodeSerializer::deserialize(std::string_view(value.data(), value.size()));
+}
+
+void RocksDBNodeStorage::getNodes(std::span<const std::string> infoSets, std::span<std::shared_ptr<Node>> out) {
+    if (!m_db) {
+        std::fill(out.begin(), out.begin() + static_cast<std::ptrdiff_t>(infoSets.size()), nullptr);
+        return;
+    }
+    if (infoSets.empty()) {
+        return;
+    }
+
+    std::vector<rocksdb::ColumnFamilyHandle*> families;
+    std::vector<rocksdb::Slice> keys;
+    families.reserve(infoSets.size());
+    keys.reserve(infoSets.size());
+    for (const std::string& infoSet : infoSets) {
+        families.push_back(familyFor(infoSet));
+        keys.emplace_back(infoSet);
+    }
+
+    std::vector<std::string> values;
+    std::vector<rocksdb::Status> statuses;
+    {
+        LatencyHistogram::ScopedTimer timer(m_readLatency);
+        statuses = m_db->MultiGet(rocksdb::ReadOptions(), families, keys, &values);
+    }
+    m_reads.fetch_add(infoSets.size(), std::memory_order_relaxed);
+
+    for (size_t i = 0; i < infoSets.size(); ++i) {
+        if (statuses[i].IsNotFound() && m_legacyDefault) {
+            statuses[i] = m_db->Get(rocksdb::ReadOptions(), m_db->DefaultColumnFamily(), infoSets[i], &values[i]);
+        }
+        if (!statuses[i].ok()) {
+            m_readMisses.fetch_add(1, std::memory_order_relaxed);
+            out[i] = nullptr;
+            continue;
+        }
+        m_bytesRead.fetch_add(values[i].size(), std::memory_order_relaxed);
+        out[i] = NodeSerializer::deserialize(values[i]);
+    }
 }
 
 void RocksDBNodeStorage::putNode(const std::string& infoSet, std::shared_ptr<Node> node) {
@@ -50,22 +183,53 @@ void RocksDBNodeStorage::putNode(const std::string& infoSet, std::shared_ptr<Nod
         return;
     }
 
-    std::string serialized = NodeSerializer::serialize(*node);
-    rocksdb::Status status = m_db->Put(rocksdb::WriteOptions(), infoSet, serialized);
+    std::string serialized = NodeSerializer::serialize(*node, m_options.encoding);
+    rocksdb::Status status;
+    {
+        LatencyHistogram::ScopedTimer timer(m_writeLatency);
+        status = m_db->Put(rocksdb::WriteOptions(), familyFor(infoSet), infoSet, serialized);
+    }
+    m_writes.fetch_add(1, std::memory_order_relaxed);
+    m_bytesWritten.fetch_add(infoSet.size() + serialized.size(), std::memory_order_relaxed);
 
     if (!status.ok()) {
         throw std::runtime_error("Failed to put node: " + status.ToString());
     }
 }
 
+void RocksDBNodeStorage::mergeNode(const std::string& infoSet, const Node& delta) {
+
+    if (!m_db) {
+        return;
+    }
+
+    std::string serialized = NodeSerializer::serialize(delta, m_options.encoding, NodeSerializer::RecordKind::Delta);
+    rocksdb::Status status;
+    {
+        LatencyHistogram::ScopedTimer timer(m_writeLatency);
+        status = m_db->Merge(rocksdb::WriteOptions(), familyFor(infoSet), infoSet, serialized);
+    }
+    m_merges.fetch_add(1, std::memory_order_relaxed);
+    m_bytesWritten.fetch_add(infoSet.size() + serialized.size(), std::memory_order_relaxed);
+
+    if (!status.ok()) {
+        throw std::runtime_error("Failed to merge node: " + status.ToString());
+    }
+}
+
 bool RocksDBNodeStorage::hasNode(const std::string& infoSet) const {
 
     if (!m_db) {
         return false;
     }
 
-    std::string value;
-    rocksdb::Status status = m_db->Get(rocksdb::ReadOptions(), infoSet, &value);
+    rocksdb::PinnableSlice value;
+    rocksdb::Status status = m_db->Get(rocksdb::ReadOptions(), familyFor(infoSet), infoSet, &value);
+
+    if (status.IsNotFound() && m_legacyDefault) {
+        value.Reset();
+        status = m_db->Get(rocksdb::ReadOptions(), m_db->DefaultColumnFamily(), infoSet, &value);
+    }
 
     return status.ok();
 }
@@ -75,7 +239,12 @@ void RocksDBNodeStorage::removeNode(const std::string& infoSet) {
         return;
     }
 
-    rocksdb::Status status = m_db->Delete(rocksdb::WriteOptions(), infoSet);
+    rocksdb::WriteBatch batch;
+    batch.Delete(familyFor(infoSet), infoSet);
+    if (m_legacyDefault) {
+        batch.Delete(m_db->DefaultColumnFamily(), infoSet);
+    }
+    rocksdb::Status status = m_db->Write(rocksdb::WriteOptions(), &batch);
 
     if (!status.ok()) {
         throw std::runtime_error("Failed to remove node: " + status.ToString());
@@ -88,9 +257,18 @@ size_t RocksDBNodeStorage::size() const
         return 0;
     }
 
-    std::string value;
-    m_db->GetProperty("rocksdb.estimate-num-keys", &value);
-    return std::stoi(value);
+    return sumIntProperty(rocksdb::DB::Properties::kEstimateNumKeys);
+}
+
+uint64_t RocksDBNodeStorage::sumIntProperty(const std::string& property) const {
+    uint64_t total = 0;
+    for (rocksdb::ColumnFamilyHandle* handle : m_handles) {
+        uint64_t value = 0;
+        if (m_db->GetIntProperty(handle, property, &value)) {
+            total += value;
+        }
+    }
+    return total;
 }
 
 void RocksDBNodeStorage::clear() {
@@ -98,27 +276,55 @@ void RocksDBNodeStorage::clear() {
         return;
     }
 
-    rocksdb::Iterator* it = m_db->NewIterator(rocksdb::ReadOptions());
     rocksdb::WriteBatch batch;
-
-    for (it->SeekToFirst(); it->Valid(); it->Next()) {
-        batch.Delete(it->key());
+    for (rocksdb::ColumnFamilyHandle* handle : m_handles) {
+        std::unique_ptr<rocksdb::Iterator> it(m_db->NewIterator(rocksdb::ReadOptions(), handle));
+        for (it->SeekToFirst(); it->Valid(); it->Next()) {
+            batch.Delete(handle, it->key());
+        }
     }
 
-    delete it;
-
     rocksdb::Status status = m_db->Write(rocksdb::WriteOptions(), &batch);
 
     if (!status.ok()) {
         throw std::runtime_error("Failed to clear database: " + status.ToString());
     }
+    m_legacyDefault = false;
+}
+
+void RocksDBNodeStorage::forEachNode(const std::function<void(const std::string&, const std::shared_ptr<Node>&)>& visit) const {
+    forEachNode(nullptr, visit);
+}
+
+void RocksDBNodeStorage::forEachNode(const rocksdb::Snapshot* snapshot,
+                                     const std::function<void(const std::string&, const std::shared_ptr<Node>&)>& visit) const {
+    if (!m_db) {
+        return;
+    }
+    rocksdb::ReadOptions readOptions;
+    readOptions.snapshot = snapshot;
+    for (rocksdb::ColumnFamilyHandle* handle : m_handles) {
+        std::unique_ptr<rocksdb::Iterator> it(m_db->NewIterator(readOptions, handle));
+        for (it->SeekToFirst(); it->Valid(); it->Next()) {
+            if (auto node = NodeSerializer::deserialize(std::string_view(it->value().data(), it->value().size()))) {
+                visit(it->key().ToString(), node);
+            }
+        }
+    }
+}
+
+std::shared_ptr<const rocksdb::Snapshot> RocksDBNodeStorage::snapshot() const {
+    if (!m_db) {
+        throw std::runtime_error("Cannot snapshot a closed RocksDB");
+    }
+    rocksdb::DB* db = m_db.get();
+    return {db->GetSnapshot(), [db](const rocksdb::Snapshot* snapshot) { db->ReleaseSnapshot(snapshot); }};
 }
 
 bool RocksDBNodeStorage::isOpen() const {
     return m_db != nullptr;
 }
 
-
 std::string RocksDBNodeStorage::getStats() const {
     if (!m_db) {
         return "Database not open";
@@ -129,16 +335,53 @@ std::string RocksDBNodeStorage::getStats() const {
     return stats;
 }
 
-rocksdb::Options RocksDBNodeStorage::getDefaultOptions() {
-    rocksdb::Options options;
+DiskStats RocksDBNodeStorage::getDiskStats() const {
+    DiskStats stats;
+    stats.reads = m_reads.load(std::memory_order_relaxed);
+    stats.readMisses = m_readMisses.load(std::memory_order_relaxed);
+    stats.bytesRead = m_bytesRead.load(std::memory_order_relaxed);
+    stats.writes = m_writes.load(std::memory_order_relaxed);
+    stats.merges = m_merges.load(std::memory_order_relaxed);
+    stats.bytesWritten = m_bytesWritten.load(std::memory_order_relaxed);
+    stats.readLatency = m_readLatency.snapshot();
+    stats.writeLatency = m_writeLatency.snapshot();
 
-    // Create the DB if it doesn't exist
+    if (!m_db) {
+        return stats;
+    }
+
+    stats.estimatedKeys = size();
+    stats.pendingCompactionBytes = sumIntProperty(rocksdb::DB::Properties::kEstimatePendingCompactionBytes);
+    uint64_t writeStopped = 0;
+    m_db->GetIntProperty(rocksdb::DB::Properties::kIsWriteStopped, &writeStopped);
+    stats.writeStopped = writeStopped != 0;
+
+    if (m_statistics) {
+        stats.stallMicros = m_statistics->getTickerCount(rocksdb::STALL_MICROS);
+        rocksdb::HistogramData stalls;
+        m_statistics->histogramData(rocksdb::WRITE_STALL, &stalls);
+        stats.stallCount = stalls.count;
+    }
+    return stats;
+}
+
+rocksdb::DBOptions RocksDBNodeStorage::getDefaultDBOptions() {
+    rocksdb::DBOptions options;
+
+    // Create the DB and any missing round families if they don't exist
     options.create_if_missing = true;
+    options.create_missing_column_families = true;
 
     //Multithread options
     options.allow_concurrent_memtable_write = true;
     options.unordered_write = true;
 
+    return options;
+}
+
+rocksdb::ColumnFamilyOptions RocksDBNodeStorage::getColumnFamilyOptions(const ColumnFamilyConfig& config) {
+    rocksdb::ColumnFamilyOptions options;
+
     //Bloom filter or maybe ribbon?
     options.memtable_whole_key_filtering = true;
 
@@ -146,14 +389,16 @@ rocksdb::Options RocksDBNodeStorage::getDefaultOptions() {
     options.OptimizeForPointLookup(64);
 
     // Set compression
-    options.compression = rocksdb::kSnappyCompression;
+    options.compression = config.compression;
+    options.bottommost_compression = config.compression;
 
     // Set memory budget
-    options.write_buffer_size = 64 * 1024 * 1024; // 64MB
+    options.write_buffer_size = config.writeBufferBytes;
     options.max_write_buffer_number = 4;
     options.min_write_buffer_number_to_merge = 2;
 
-    // Set level compaction
+    // Set compaction
+    options.compaction_style = config.compactionStyle;
     options.level0_file_num_compaction_trigger = 4;
     options.level0_slowdown_writes_trigger = 20;
     options.level0_stop_writes_trigger = 36;
@@ -162,12 +407,17 @@ rocksdb::Options RocksDBNodeStorage::getDefaultOptions() {
 
     //Bloom filter
     rocksdb::BlockBasedTableOptions table_options;
-    table_options.filter_policy.reset(rocksdb::NewBloomFilterPolicy(10, false));
-
+    if (config.bloomBitsPerKey > 0) {
+        table_options.filter_policy.reset(rocksdb::NewBloomFilterPolicy(config.bloomBitsPerKey, false));
+    }
 
-    // Set block cache
+    // Set block cache, one per family so the hot rounds are not pushed out by river blocks
+    table_options.block_cache = rocksdb::NewLRUCache(config.blockCacheBytes);
     options.table_factory.reset(rocksdb::NewBlockBasedTableFactory(table_options));
 
+    // Delta records are summed by compaction instead of a read-modify-write
+    options.merge_operator = std::make_shared<NodeMergeOperator>();
+
     return options;
 }
 
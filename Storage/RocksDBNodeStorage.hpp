@@ -5,40 +5,138 @@
 #ifndef ROCKSDBNODESTORAGE_HPP
 #define ROCKSDBNODESTORAGE_HPP
 
+#include <string_view>
+#include <vector>
+
 #include "NodeStorage.hpp"
+#include "NodeSerializer.hpp"
+#include "StorageStats.hpp"
 #include <rocksdb/db.h>
 #include <rocksdb/options.h>
 
 namespace CFR {
 
+/// @brief How a cache in front of the database writes back evicted nodes
+enum class SpillPolicy {
+    /// @brief Misses read the stored node, evictions overwrite it with the full value
+    ReadThrough,
+    /// @brief Misses read the stored node too, evictions merge only what it gained since that read as a delta, so a
+    /// spill never reads. Suits nodes that are rarely revisited, where most spills would overwrite a fresh read
+    WriteOnlyDelta
+};
+
+/// @brief Tuning of a single RocksDB column family
+struct ColumnFamilyConfig {
+    std::string name;
+    size_t blockCacheBytes = 64 * 1024 * 1024;
+    /// @brief Bloom filter bits per key, 0 disables the filter
+    double bloomBitsPerKey = 10;
+    rocksdb::CompressionType compression = rocksdb::kSnappyCompression;
+    rocksdb::CompactionStyle compactionStyle = rocksdb::kCompactionStyleLevel;
+    size_t writeBufferBytes = 64 * 1024 * 1024;
+    SpillPolicy spillPolicy = SpillPolicy::ReadThrough;
+};
+
+/// @brief Options for RocksDBNodeStorage
+struct RocksDBStorageOptions {
+    /// @brief One column family per betting round, index 0 is preflop; rounds past the end share the last family
+    std::vector<ColumnFamilyConfig> rounds = defaultRounds();
+
+    /// @brief Element encoding for newly written nodes, existing records of any encoding stay readable
+    NodeSerializer::Encoding encoding = NodeSerializer::Encoding::Float32;
+
+    /// @brief Small hot early rounds stay uncompressed, the large cold river is compressed hard
+    static std::vector<ColumnFamilyConfig> defaultRounds() {
+        return {
+            {"round0", 32 * 1024 * 1024, 10, rocksdb::kNoCompression, rocksdb::kCompactionStyleUniversal, 16 * 1024 * 1024},
+            {"round1", 64 * 1024 * 1024, 10, rocksdb::kLZ4Compression, rocksdb::kCompactionStyleUniversal, 32 * 1024 * 1024},
+            {"round2", 128 * 1024 * 1024, 10, rocksdb::kLZ4Compression, rocksdb::kCompactionStyleLevel, 64 * 1024 * 1024},
+            {"round3", 256 * 1024 * 1024, 10, rocksdb::kZSTD, rocksdb::kCompactionStyleLevel, 64 * 1024 * 1024},
+        };
+    }
+};
+
 /// @brief RocksDB-based persistent storage for cold nodes
 class RocksDBNodeStorage final : public NodeStorage {
 public:
     /// @brief Constructor
     /// @param dbPath Path to the RocksDB database directory
-    explicit RocksDBNodeStorage(std::string  dbPath);
+    /// @param options Column family layout and record encoding
+    explicit RocksDBNodeStorage(std::string  dbPath, RocksDBStorageOptions options = {});
 
     ~RocksDBNodeStorage() override;
 
     // NodeStorage interface
     std::shared_ptr<Node> getNode(const std::string& infoSet) override;
+    /// @details One MultiGet across the round column families
+    void getNodes(std::span<const std::string> infoSets, std::span<std::shared_ptr<Node>> out) override;
     void putNode(const std::string& infoSet, std::shared_ptr<Node> node) override;
     bool hasNode(const std::string& infoSet) const override;
     void removeNode(const std::string& infoSet) override;
     [[nodiscard]] size_t size() const override;
     void clear() override;
+    /// @details Walks every column family, merged delta records are visited as their folded value
+    void forEachNode(const std::function<void(const std::string&, const std::shared_ptr<Node>&)>& visit) const override;
+    /// @brief forEachNode as the database stood when snapshot was taken, nullptr reads the current state
+    void forEachNode(const rocksdb::Snapshot* snapshot,
+                     const std::function<void(const std::string&, const std::shared_ptr<Node>&)>& visit) const;
+
+    /// @brief Add the node's sums onto the stored value through the merge operator, without reading it
+    /// @param infoSet The information set string key
+    /// @param delta Node holding the increments
+    void mergeNode(const std::string& infoSet, const Node& delta);
+
+    /// @brief Spill policy configured for the round this key belongs to
+    [[nodiscard]] SpillPolicy spillPolicy(std::string_view infoSet) const;
 
     /// @brief Check if the database is open
     [[nodiscard]] bool isOpen() const;
 
+    /// @brief Pin the database as it is now, later writes are not seen through the handle
+    /// @details A RocksDB snapshot only records a sequence number, taking one is constant time. It is released with the
+    /// last copy of the handle, which must go before the storage is closed
+    [[nodiscard]] std::shared_ptr<const rocksdb::Snapshot> snapshot() const;
+
+    [[nodiscard]] const std::string& path() const { return m_dbPath; }
+    [[nodiscard]] const RocksDBStorageOptions& options() const { return m_options; }
+
     /// @brief Get RocksDB statistics
     [[nodiscard]] std::string getStats() const;
 
+    /// @brief I/O counters, latencies, pending compaction and write stall figures
+    [[nodiscard]] DiskStats getDiskStats() const;
+
+    /// @brief Number of betting rounds completed before the node with this info set key
+    /// @details Keys are a card index followed by action tokens (Ch, Ca, Fo, Ra<n>, Re<n>, AI). A call closes the
+    /// round unless it is the small blind limping as the first action preflop, a check closes it preflop or after a check.
+    [[nodiscard]] static size_t bettingRound(std::string_view infoSet);
+
 private:
     std::unique_ptr<rocksdb::DB> m_db;
     std::string m_dbPath;
+    RocksDBStorageOptions m_options;
+    std::vector<rocksdb::ColumnFamilyHandle*> m_handles;
+    std::vector<rocksdb::ColumnFamilyHandle*> m_roundFamilies;
+    /// @brief Set when the default family still holds nodes written before keys were split by round
+    bool m_legacyDefault = false;
+
+    std::shared_ptr<rocksdb::Statistics> m_statistics;
+    mutable std::atomic<uint64_t> m_reads{0};
+    mutable std::atomic<uint64_t> m_readMisses{0};
+    mutable std::atomic<uint64_t> m_bytesRead{0};
+    std::atomic<uint64_t> m_writes{0};
+    std::atomic<uint64_t> m_merges{0};
+    std::atomic<uint64_t> m_bytesWritten{0};
+    mutable LatencyHistogram m_readLatency;
+    LatencyHistogram m_writeLatency;
+
+    [[nodiscard]] uint64_t sumIntProperty(const std::string& property) const;
+
+    [[nodiscard]] size_t roundIndex(std::string_view infoSet) const;
+    [[nodiscard]] rocksdb::ColumnFamilyHandle* familyFor(std::string_view infoSet) const;
 
-    [[nodiscard]] static rocksdb::Options getDefaultOptions();
+    [[nodiscard]] static rocksdb::DBOptions getDefaultDBOptions();
+    [[nodiscard]] static rocksdb::ColumnFamilyOptions getColumnFamilyOptions(const ColumnFamilyConfig& config);
     [[nodiscard]] static rocksdb::ReadOptions getDefaultReadOptions();
 };
 
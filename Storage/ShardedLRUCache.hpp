@@ -16,30 +16,55 @@ public:
     using EvictionCallback = std::function<void(const std::string&, std::shared_ptr<Node>)>;
 
     /// @brief Constructor
-    /// @param cacheCapacity Maximum number of nodes in entire cache
+    /// @param cacheBudgetBytes Maximum bytes for the entire cache, split evenly between shards
     /// @param evictionCallback Optional callback when nodes are evicted
-    explicit ShardedLRUCache(size_t cacheCapacity, const EvictionCallback& evictionCallback = nullptr);
+    explicit ShardedLRUCache(size_t cacheBudgetBytes, const EvictionCallback& evictionCallback = nullptr);
 
     ~ShardedLRUCache() override = default;
 
     std::shared_ptr<Node> getNode(const std::string& infoSet) override;
     void putNode(const std::string& infoSet, std::shared_ptr<Node> node) override;
+    /// @brief putNode that tells whether the key was new to the cache, decided under the shard's lock
+    bool insertOrAssign(const std::string& infoSet, std::shared_ptr<Node> node);
     bool hasNode(const std::string& infoSet) const override;
     void removeNode(const std::string& infoSet) override;
+    void prefetch(const std::string& infoSet) const override { getShard(infoSet).cache.prefetchSafe(infoSet); }
+    void forEachNode(const std::function<void(const std::string&, const std::shared_ptr<Node>&)>& visit) const override {
+        for (const auto& shard : m_shards) {
+            shard->cache.forEachNode(visit);
+        }
+    }
+    /// @brief Copy one shard's entries at a time under its lock and visit the copy unlocked, safe while the cache is in use
+    void forEachShard(const std::function<void(NodeCapture::Entries&)>& visit) const {
+        NodeCapture::Entries entries;
+        for (const auto& shard : m_shards) {
+            entries.clear();
+            shard->cache.forEachNode([&entries](const std::string& infoSet, const std::shared_ptr<Node>& node) {
+                entries.emplace_back(infoSet, node);
+            });
+            visit(entries);
+        }
+    }
     size_t size() const override;
     void clear() override;
 
     /// @brief Get current cache hit rate across all shards
     double getHitRate() const;
 
+    /// @brief Hits, misses and evictions summed over all shards
+    [[nodiscard]] CacheCounters getCounters() const;
+
     /// @brief Reset hit/miss statistics across all shards
     void resetStats();
 
     /// @brief Flush all cached nodes to disk using eviction callback
     void flush();
 
-    /// @brief Get total capacity across all shards
-    size_t getTotalCapacity() const { return m_capacityPerShard * NUM_SHARDS; }
+    /// @brief Get total budget in bytes across all shards
+    size_t getTotalCapacity() const { return m_budgetPerShard * NUM_SHARDS; }
+
+    /// @brief Bytes in use versus budget summed over all shards
+    [[nodiscard]] CacheMemoryStats getMemoryStats() const;
 
     /// @brief Get number of shards
     size_t getNumShards() const { return NUM_SHARDS; }
@@ -50,8 +75,8 @@ private:
     struct Shard {
         LRUNodeCache<CacheMap,CacheList> cache;
 
-        Shard(size_t capacity, EvictionCallback callback)
-            : cache(capacity, std::move(callback)) {}
+        Shard(size_t budgetBytes, EvictionCallback callback)
+            : cache(budgetBytes, std::move(callback)) {}
     };
 
     /// @brief Get shard index for a given key using hash
@@ -61,7 +86,7 @@ private:
     Shard& getShard(const std::string& key);
     const Shard& getShard(const std::string& key) const;
 
-    size_t m_capacityPerShard;
+    size_t m_budgetPerShard;
     std::array<std::unique_ptr<Shard>, NUM_SHARDS> m_shards;
 
     // Global statistics
@@ -70,15 +95,15 @@ private:
 };
 
 template< template<typename mapKey, typename mapValue> typename CacheMap, template<typename CacheListObject> typename CacheList>
-ShardedLRUCache<CacheMap,CacheList>::ShardedLRUCache(size_t cacheCapacity, const EvictionCallback& evictionCallback)
-    : m_capacityPerShard(std::ceil(cacheCapacity/NUM_SHARDS)) {
-    if (m_capacityPerShard == 0) {
-        throw std::invalid_argument("Cache capacity per shard must be greater than 0");
+ShardedLRUCache<CacheMap,CacheList>::ShardedLRUCache(size_t cacheBudgetBytes, const EvictionCallback& evictionCallback)
+    : m_budgetPerShard(cacheBudgetBytes / NUM_SHARDS) {
+    if (m_budgetPerShard == 0) {
+        throw std::invalid_argument("Cache budget per shard must be greater than 0 bytes");
     }
 
     // Initialize all shards
     for (size_t i = 0; i < NUM_SHARDS; ++i) {
-        m_shards[i] = std::make_unique<Shard>(m_capacityPerShard, evictionCallback);
+        m_shards[i] = std::make_unique<Shard>(m_budgetPerShard, evictionCallback);
     }
 }
 
@@ -115,9 +140,14 @@ std::shared_ptr<Node> ShardedLRUCache<CacheMap,CacheList>::getNode(const std::st
 
 template< template<typename mapKey, typename mapValue> typename CacheMap, template<typename CacheListObject> typename CacheList>
 void ShardedLRUCache<CacheMap,CacheList>::putNode(const std::string& infoSet, std::shared_ptr<Node> node) {
+    insertOrAssign(infoSet, std::move(node));
+}
+
+template< template<typename mapKey, typename mapValue> typename CacheMap, template<typename CacheListObject> typename CacheList>
+bool ShardedLRUCache<CacheMap,CacheList>::insertOrAssign(const std::string& infoSet, std::shared_ptr<Node> node) {
     auto& shard = getShard(infoSet);
 
-    shard.cache.putNodeSafe(infoSet, std::move(node));
+    return shard.cache.insertOrAssignSafe(infoSet, std::move(node));
 }
 
 template< template<typename mapKey, typename mapValue> typename CacheMap, template<typename CacheListObject> typename CacheList>
@@ -178,5 +208,23 @@ void ShardedLRUCache<CacheMap,CacheList>::flush() {
     }
 }
 
+template< template<typename mapKey, typename mapValue> typename CacheMap, template<typename CacheListObject> typename CacheList>
+CacheCounters ShardedLRUCache<CacheMap,CacheList>::getCounters() const {
+    CacheCounters counters{totalHits_.load(std::memory_order_relaxed), totalMisses_.load(std::memory_order_relaxed), 0};
+    for (const auto& shardPtr : m_shards) {
+        counters.evictions += shardPtr->cache.getCounters().evictions;
+    }
+    return counters;
+}
+
+template< template<typename mapKey, typename mapValue> typename CacheMap, template<typename CacheListObject> typename CacheList>
+CacheMemoryStats ShardedLRUCache<CacheMap,CacheList>::getMemoryStats() const {
+    CacheMemoryStats stats;
+    for (const auto& shardPtr : m_shards) {
+        stats += shardPtr->cache.getMemoryStats();
+    }
+    return stats;
+}
+
 } // namespace CFR
 #endif //SHARDEDLRUCACHE_HPP
@@ -0,0 +1,70 @@
+#include "StorageStats.hpp"
+
+#include <format>
+#include <stdexcept>
+
+namespace CFR {
+namespace {
+
+std::string latencyJson(const LatencyHistogram::Snapshot& latency) {
+    return std::format(R"({{"count":{},"mean_ns":{:.0f},"p50_ns":{},"p99_ns":{},"max_ns":{}}})",
+                       latency.count, latency.meanNanos(), latency.percentileNanos(0.5),
+                       latency.percentileNanos(0.99), latency.maxNanos);
+}
+
+} // namespace
+
+std::string StorageStats::toJson() const {
+    std::string json = std::format(
+        R"({{"ts_ms":{},"nodes":{},"cache":{{"hits":{},"misses":{},"hit_rate":{:.4f},"evictions":{},"entries":{},"used_bytes":{},"budget_bytes":{}}},)",
+        timestampMs, nodes, cache.hits, cache.misses, hitRate(), cache.evictions, memory.entries,
+        memory.usedBytes, memory.budgetBytes);
+    json += std::format(
+        R"("disk":{{"reads":{},"read_misses":{},"bytes_read":{},"writes":{},"merges":{},"bytes_written":{},"estimated_keys":{},)",
+        disk.reads, disk.readMisses, disk.bytesRead, disk.writes, disk.merges, disk.bytesWritten, disk.estimatedKeys);
+    json += std::format(
+        R"("pending_compaction_bytes":{},"stall_micros":{},"stall_count":{},"write_stopped":{},"read_latency":{},"write_latency":{}}},)",
+        disk.pendingCompactionBytes, disk.stallMicros, disk.stallCount, disk.writeStopped,
+        latencyJson(disk.readLatency), latencyJson(disk.writeLatency));
+    json += std::format(R"("spill_latency":{},"flush_latency":{}}})", latencyJson(spillLatency), latencyJson(flushLatency));
+    return json;
+}
+
+StatsReporter::StatsReporter(std::function<StorageStats()> source, const std::string& path, std::chrono::milliseconds interval)
+    : m_source(std::move(source)), m_out(path, std::ios::app), m_interval(interval) {
+    if (!m_out) {
+        throw std::runtime_error("Failed to open stats file: " + path);
+    }
+    m_thread = std::thread(&StatsReporter::run, this);
+}
+
+StatsReporter::~StatsReporter() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    writeSample();
+}
+
+void StatsReporter::run() {
+    std::unique_lock lock(m_mutex);
+    while (!m_cv.wait_for(lock, m_interval, [this] { return m_stop; })) {
+        lock.unlock();
+        writeSample();
+        lock.lock();
+    }
+}
+
+void StatsReporter::writeSample() {
+    StorageStats stats = m_source();
+    stats.timestampMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    m_out << stats.toJson() << '\n';
+    m_out.flush();
+}
+
+} // namespace CFR
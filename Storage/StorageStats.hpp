@@ -0,0 +1,100 @@
+#ifndef STORAGESTATS_HPP
+#define STORAGESTATS_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "CacheMemory.hpp"
+#include "LatencyHistogram.hpp"
+
+namespace CFR {
+
+/// @brief Lookup and eviction counts of a node cache
+struct CacheCounters {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+
+    CacheCounters& operator+=(const CacheCounters& other) {
+        hits += other.hits;
+        misses += other.misses;
+        evictions += other.evictions;
+        return *this;
+    }
+};
+
+/// @brief I/O counters and engine health of the on-disk store
+struct DiskStats {
+    uint64_t reads = 0;
+    uint64_t readMisses = 0;
+    uint64_t bytesRead = 0;
+    uint64_t writes = 0;
+    uint64_t merges = 0;
+    uint64_t bytesWritten = 0;
+    LatencyHistogram::Snapshot readLatency;
+    LatencyHistogram::Snapshot writeLatency;
+
+    uint64_t estimatedKeys = 0;
+    uint64_t pendingCompactionBytes = 0;
+    uint64_t stallMicros = 0;
+    uint64_t stallCount = 0;
+    bool writeStopped = false;
+};
+
+/// @brief Point in time view of a HybridNodeStorage
+struct StorageStats {
+    /// @brief Milliseconds since the epoch when the stats were taken
+    int64_t timestampMs = 0;
+    uint64_t nodes = 0;
+    CacheCounters cache;
+    CacheMemoryStats memory;
+    DiskStats disk;
+    /// @brief Time spent serializing and writing one evicted node
+    LatencyHistogram::Snapshot spillLatency;
+    LatencyHistogram::Snapshot flushLatency;
+
+    [[nodiscard]] double hitRate() const {
+        const uint64_t lookups = cache.hits + cache.misses;
+        return lookups > 0 ? static_cast<double>(cache.hits) / static_cast<double>(lookups) : 0.0;
+    }
+
+    /// @brief Single line JSON object, latencies summarised as count, mean, p50, p99 and max in nanoseconds
+    [[nodiscard]] std::string toJson() const;
+};
+
+/// @brief Background thread appending a JSON line of stats to a file at a fixed interval
+class StatsReporter {
+public:
+    /// @param source Called on the reporter thread to take each sample
+    /// @param path File the lines are appended to
+    /// @param interval Time between samples
+    StatsReporter(std::function<StorageStats()> source, const std::string& path, std::chrono::milliseconds interval);
+
+    /// @brief Writes a final sample and joins the thread
+    ~StatsReporter();
+
+    StatsReporter(const StatsReporter&) = delete;
+    StatsReporter& operator=(const StatsReporter&) = delete;
+
+private:
+    void run();
+    void writeSample();
+
+    std::function<StorageStats()> m_source;
+    std::ofstream m_out;
+    std::chrono::milliseconds m_interval;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_stop = false;
+    std::thread m_thread;
+};
+
+} // namespace CFR
+
+#endif //STORAGESTATS_HPP
@@ -0,0 +1,309 @@
+#include "StrategyServer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "../Game/Utility/Random.hpp"
+
+namespace CFR {
+namespace {
+
+/// @brief Most actions the wire format can carry
+constexpr size_t MaxWireActions = 255;
+
+sockaddr_un socketAddress(const std::filesystem::path& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    const std::string& name = path.native();
+    if (name.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Socket path " + name + " is too long");
+    }
+    std::memcpy(address.sun_path, name.c_str(), name.size() + 1);
+    return address;
+}
+
+bool readExact(int fd, void* data, size_t bytes) {
+    auto* out = static_cast<char*>(data);
+    for (size_t done = 0; done < bytes;) {
+        const ssize_t received = ::recv(fd, out + done, bytes - done, 0);
+        if (received <= 0) {
+            return false;
+        }
+        done += static_cast<size_t>(received);
+    }
+    return true;
+}
+
+bool writeExact(int fd, const void* data, size_t bytes) {
+    const auto* in = static_cast<const char*>(data);
+    for (size_t done = 0; done < bytes;) {
+        const ssize_t sent = ::send(fd, in + done, bytes - done, MSG_NOSIGNAL);
+        if (sent <= 0) {
+            return false;
+        }
+        done += static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+template <typename T>
+void append(std::vector<std::byte>& out, const T& value) {
+    const size_t at = out.size();
+    out.resize(at + sizeof(T));
+    std::memcpy(out.data() + at, &value, sizeof(T));
+}
+
+template <typename T>
+bool take(std::span<const std::byte>& in, T& value) {
+    if (in.size() < sizeof(T)) {
+        return false;
+    }
+    std::memcpy(&value, in.data(), sizeof(T));
+    in = in.subspan(sizeof(T));
+    return true;
+}
+
+} // namespace
+
+StrategyServer::StrategyServer(NodeStorage& strategy, std::filesystem::path socketPath, std::chrono::milliseconds ioTimeout)
+    : m_strategy(strategy), m_frozen(dynamic_cast<FrozenStrategy*>(&strategy)), m_socketPath(std::move(socketPath)),
+      m_ioTimeout(ioTimeout) {
+    const sockaddr_un address = socketAddress(m_socketPath);
+    m_socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_socket < 0) {
+        throw std::runtime_error("Failed to create strategy server socket");
+    }
+    // a socket file left by a server that did not shut down would make bind fail
+    ::unlink(address.sun_path);
+    if (::bind(m_socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0 || ::listen(m_socket, 64) < 0) {
+        ::close(m_socket);
+        throw std::runtime_error("Failed to bind strategy server socket " + m_socketPath.string());
+    }
+    m_acceptThread = std::thread([this] { acceptLoop(); });
+}
+
+StrategyServer::~StrategyServer() {
+    m_stop = true;
+    m_acceptThread.join();
+    // every connection notices m_stop or its I/O timeout, so none of these waits on a client
+    for (Connection& connection : m_connections) {
+        connection.thread.join();
+    }
+    ::close(m_socket);
+    ::unlink(m_socketPath.c_str());
+}
+
+void StrategyServer::acceptLoop() {
+    pollfd listening{m_socket, POLLIN, 0};
+    while (!m_stop) {
+        // wake regularly to notice shutdown
+        const int ready = ::poll(&listening, 1, 100);
+        reapConnections();
+        if (ready <= 0) {
+            continue;
+        }
+        const int client = ::accept(m_socket, nullptr, nullptr);
+        if (client < 0) {
+            continue;
+        }
+        // a blocked recv or send gives up after the timeout rather than holding the connection's thread forever
+        timeval timeout{};
+        timeout.tv_sec = static_cast<time_t>(m_ioTimeout.count() / 1000);
+        timeout.tv_usec = static_cast<suseconds_t>(m_ioTimeout.count() % 1000 * 1000);
+        ::setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        ::setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        std::lock_guard lock(m_connectionsMutex);
+        Connection& connection = m_connections.emplace_back();
+        connection.thread = std::thread([this, client, &connection] {
+            serve(client);
+            ::close(client);
+            connection.done.store(true, std::memory_order_release);
+        });
+    }
+}
+
+void StrategyServer::reapConnections() {
+    std::lock_guard lock(m_connectionsMutex);
+    for (auto it = m_connections.begin(); it != m_connections.end();) {
+        if (it->done.load(std::memory_order_acquire)) {
+            it->thread.join();
+            it = m_connections.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+size_t StrategyServer::openConnections() const {
+    std::lock_guard lock(m_connectionsMutex);
+    return m_connections.size();
+}
+
+void StrategyServer::serve(int client) {
+    std::vector<std::byte> request;
+    std::vector<std::byte> response;
+    pollfd readable{client, POLLIN, 0};
+    while (!m_stop) {
+        // between batches wait in short slices to notice shutdown, a started frame is read to its end or the I/O timeout
+        const int ready = ::poll(&readable, 1, 100);
+        if (ready == 0) {
+            continue;
+        }
+        uint32_t payloadBytes = 0;
+        if (ready < 0 || !readExact(client, &payloadBytes, sizeof(payloadBytes)) || payloadBytes > StrategyProtocol::MaxFrameBytes) {
+            return;
+        }
+        request.resize(payloadBytes);
+        if (!readExact(client, request.data(), payloadBytes)) {
+            return;
+        }
+        {
+            LatencyHistogram::ScopedTimer timer(m_batchLatency);
+            if (!answer(request, response)) {
+                return;
+            }
+        }
+        if (!writeExact(client, response.data(), response.size())) {
+            return;
+        }
+    }
+}
+
+bool StrategyServer::answer(std::span<const std::byte> request, std::vector<std::byte>& response) {
+    uint8_t mode = 0;
+    uint64_t seed = 0;
+    uint32_t count = 0;
+    std::array<uint8_t, 3> pad{};
+    if (!take(request, mode) || !take(request, pad) || !take(request, seed) || !take(request, count) ||
+        mode > static_cast<uint8_t>(StrategyQueryMode::Sample)) {
+        return false;
+    }
+    const bool sample = mode == static_cast<uint8_t>(StrategyQueryMode::Sample);
+    Random::DefaultEngine engine(seed);
+
+    response.clear();
+    append(response, uint32_t{0});
+    append(response, count);
+    std::string infoSet;
+    std::array<float, MaxWireActions> probabilities{};
+    for (uint32_t i = 0; i < count; ++i) {
+        uint16_t length = 0;
+        if (!take(request, length) || request.size() < length) {
+            return false;
+        }
+        infoSet.assign(reinterpret_cast<const char*>(request.data()), length);
+        request = request.subspan(length);
+
+        const uint32_t actions = distribution(infoSet, probabilities);
+        const auto sampled = actions == 0 ? uint8_t{0}
+            : static_cast<uint8_t>(Random::sampleCategorical(std::span<const float>(probabilities.data(), actions), engine));
+        append(response, static_cast<uint8_t>(actions));
+        append(response, sampled);
+        if (!sample) {
+            const size_t at = response.size();
+            response.resize(at + actions * sizeof(float));
+            std::memcpy(response.data() + at, probabilities.data(), actions * sizeof(float));
+        }
+    }
+    const auto payloadBytes = static_cast<uint32_t>(response.size() - sizeof(uint32_t));
+    std::memcpy(response.data(), &payloadBytes, sizeof(payloadBytes));
+    m_queries.fetch_add(count, std::memory_order_relaxed);
+    return true;
+}
+
+uint32_t StrategyServer::distribution(const std::string& infoSet, std::span<float> out) {
+    if (m_frozen != nullptr) {
+        return m_frozen->lookup(infoSet, out);
+    }
+    const auto node = m_strategy.getNode(infoSet);
+    if (node == nullptr) {
+        return 0;
+    }
+    const std::vector<float> average = node->averageStrategyOf();
+    const size_t actions = std::min(average.size(), out.size());
+    std::copy_n(average.begin(), actions, out.begin());
+    return static_cast<uint32_t>(actions);
+}
+
+StrategyClient::StrategyClient(const std::filesystem::path& socketPath) {
+    const sockaddr_un address = socketAddress(socketPath);
+    m_socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_socket < 0 || ::connect(m_socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0) {
+        if (m_socket >= 0) {
+            ::close(m_socket);
+        }
+        throw std::runtime_error("Failed to connect to strategy server " + socketPath.string());
+    }
+}
+
+StrategyClient::~StrategyClient() {
+    ::close(m_socket);
+}
+
+std::vector<StrategyAnswer> StrategyClient::query(std::span<const std::string> infoSets, StrategyQueryMode mode, uint64_t seed) {
+    m_buffer.clear();
+    append(m_buffer, uint32_t{0});
+    append(m_buffer, static_cast<uint8_t>(mode));
+    append(m_buffer, std::array<uint8_t, 3>{});
+    append(m_buffer, seed);
+    append(m_buffer, static_cast<uint32_t>(infoSets.size()));
+    for (const std::string& infoSet : infoSets) {
+        if (infoSet.size() > UINT16_MAX) {
+            throw std::invalid_argument("Info set key is too long to query");
+        }
+        append(m_buffer, static_cast<uint16_t>(infoSet.size()));
+        const size_t at = m_buffer.size();
+        m_buffer.resize(at + infoSet.size());
+        std::memcpy(m_buffer.data() + at, infoSet.data(), infoSet.size());
+    }
+    const auto requestBytes = static_cast<uint32_t>(m_buffer.size() - sizeof(uint32_t));
+    if (requestBytes > StrategyProtocol::MaxFrameBytes) {
+        throw std::invalid_argument("Strategy query batch is too large");
+    }
+    std::memcpy(m_buffer.data(), &requestBytes, sizeof(requestBytes));
+
+    uint32_t responseBytes = 0;
+    if (!writeExact(m_socket, m_buffer.data(), m_buffer.size()) || !readExact(m_socket, &responseBytes, sizeof(responseBytes))) {
+        throw std::runtime_error("Strategy server connection failed");
+    }
+    m_buffer.resize(responseBytes);
+    if (!readExact(m_socket, m_buffer.data(), responseBytes)) {
+        throw std::runtime_error("Strategy server connection failed");
+    }
+
+    std::span<const std::byte> in(m_buffer);
+    uint32_t count = 0;
+    if (!take(in, count) || count != infoSets.size()) {
+        throw std::runtime_error("Malformed strategy server response");
+    }
+    std::vector<StrategyAnswer> answers(count);
+    for (StrategyAnswer& answer : answers) {
+        uint8_t actions = 0;
+        uint8_t sampled = 0;
+        if (!take(in, actions) || !take(in, sampled)) {
+            throw std::runtime_error("Malformed strategy server response");
+        }
+        answer.actions = actions;
+        answer.sampledAction = sampled;
+        if (mode == StrategyQueryMode::Distribution) {
+            if (in.size() < actions * sizeof(float)) {
+                throw std::runtime_error("Malformed strategy server response");
+            }
+            answer.probabilities.resize(actions);
+            std::memcpy(answer.probabilities.data(), in.data(), actions * sizeof(float));
+            in = in.subspan(actions * sizeof(float));
+        }
+    }
+    return answers;
+}
+
+} // namespace CFR
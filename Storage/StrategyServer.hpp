@@ -0,0 +1,132 @@
+#ifndef STRATEGYSERVER_HPP
+#define STRATEGYSERVER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "FrozenStrategy.hpp"
+#include "LatencyHistogram.hpp"
+#include "NodeStorage.hpp"
+
+namespace CFR {
+
+/// @brief What a strategy query answers with
+enum class StrategyQueryMode : uint8_t {
+    /// @brief The average strategy of every info set
+    Distribution,
+    /// @brief Only one action per info set, drawn from its average strategy
+    Sample,
+};
+
+/// @brief Answer to one info set of a batch
+struct StrategyAnswer {
+    /// @brief 0 when the strategy has no node for the info set, the caller decides how to play it
+    uint32_t actions = 0;
+    /// @brief Index into the game's action list, only meaningful for a known info set
+    uint32_t sampledAction = 0;
+    /// @brief One probability per action in Distribution mode, empty in Sample mode
+    std::vector<float> probabilities;
+
+    [[nodiscard]] bool known() const { return actions > 0; }
+};
+
+/// @brief Wire format shared by StrategyServer and StrategyClient, a stream of length prefixed frames
+///
+/// request:  uint32 payload bytes, uint8 mode, 3 pad bytes, uint64 seed, uint32 count, then count times uint16 key
+///           length and the key bytes
+/// response: uint32 payload bytes, uint32 count, then per info set uint8 action count (0 for an unknown info set),
+///           uint8 sampled action and, in Distribution mode, a float per action
+/// Keys are the exact strings Game::getInfoSet returns, so a client builds them by replaying its lines through the game.
+/// Integers and floats are in host byte order, client and server share a machine.
+struct StrategyProtocol {
+    static constexpr uint32_t MaxFrameBytes = 16u << 20;
+};
+
+/// @brief Serves a loaded strategy to local processes over a Unix domain socket
+/// @details Each connection gets its own thread, so a client keeping one connection open pays no accept per batch.
+/// The accept thread joins the threads of closed connections as it goes. A client that stalls for longer than the I/O
+/// timeout in the middle of a frame, or stops reading its answers, is dropped, so stopping the server never waits on one.
+/// Every connection reads the storage concurrently, which FrozenStrategy and a MapNodeStorage that is no longer trained
+/// allow. A FrozenStrategy is read through its allocation free lookup, other storage through getNode.
+class StrategyServer {
+public:
+    static constexpr std::chrono::milliseconds DefaultIoTimeout{5000};
+
+    /// @brief Bind socketPath, replacing a stale socket file, and start accepting
+    /// @param ioTimeout Longest a connection waits on the rest of a started frame or on writing an answer
+    /// @throws std::runtime_error if the socket cannot be bound
+    StrategyServer(NodeStorage& strategy, std::filesystem::path socketPath, std::chrono::milliseconds ioTimeout = DefaultIoTimeout);
+    ~StrategyServer();
+
+    StrategyServer(const StrategyServer&) = delete;
+    StrategyServer& operator=(const StrategyServer&) = delete;
+
+    [[nodiscard]] const std::filesystem::path& socketPath() const { return m_socketPath; }
+    [[nodiscard]] uint64_t queriesServed() const { return m_queries.load(std::memory_order_relaxed); }
+    /// @brief Time from a batch being read to its answer being written, excluding the socket
+    [[nodiscard]] LatencyHistogram::Snapshot batchLatency() const { return m_batchLatency.snapshot(); }
+    /// @brief Connections whose threads have not been joined yet
+    [[nodiscard]] size_t openConnections() const;
+
+private:
+    struct Connection {
+        std::thread thread;
+        /// @brief Set by the connection's thread as it finishes, the accept thread then joins it
+        std::atomic<bool> done{false};
+    };
+
+    /// @brief Join the threads of connections that have closed
+    void reapConnections();
+    void acceptLoop();
+    void serve(int client);
+    /// @brief Answer one request payload with a whole response frame
+    /// @return false when the request is malformed and the connection should be dropped
+    bool answer(std::span<const std::byte> request, std::vector<std::byte>& response);
+    uint32_t distribution(const std::string& infoSet, std::span<float> out);
+
+    NodeStorage& m_strategy;
+    FrozenStrategy* m_frozen;
+    std::filesystem::path m_socketPath;
+    std::chrono::milliseconds m_ioTimeout;
+    int m_socket = -1;
+    std::atomic<bool> m_stop{false};
+    std::atomic<uint64_t> m_queries{0};
+    LatencyHistogram m_batchLatency;
+    mutable std::mutex m_connectionsMutex;
+    /// @brief A list so a running thread's done flag never moves
+    std::list<Connection> m_connections;
+    std::thread m_acceptThread;
+};
+
+/// @brief One connection to a StrategyServer, batches are answered in order
+/// @details Not thread safe, give each thread its own client.
+class StrategyClient {
+public:
+    /// @throws std::runtime_error if no server is listening on socketPath
+    explicit StrategyClient(const std::filesystem::path& socketPath);
+    ~StrategyClient();
+
+    StrategyClient(const StrategyClient&) = delete;
+    StrategyClient& operator=(const StrategyClient&) = delete;
+
+    /// @brief Answer every info set in one round trip
+    /// @param seed Seeds the server's draws in Sample mode, the same batch and seed give the same actions
+    /// @throws std::runtime_error if the connection fails
+    std::vector<StrategyAnswer> query(std::span<const std::string> infoSets, StrategyQueryMode mode, uint64_t seed = 0);
+
+private:
+    int m_socket = -1;
+    std::vector<std::byte> m_buffer;
+};
+
+} // namespace CFR
+
+#endif //STRATEGYSERVER_HPP
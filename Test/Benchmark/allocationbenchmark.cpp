@@ -0,0 +1,71 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+
+#include "../../CFR/RegretMinimizer.hpp"
+#include "../../Game/GameImpl/Preflop/Game.hpp"
+#include "../../Game/GameImpl/Texas/Game.hpp"
+#include "../../Storage/MapNodeStorage.hpp"
+
+// Replacing operator new instruments every allocation in the binary, so these benchmarks get an executable of their
+// own and the timings in benchmarkmain are measured with the allocator untouched
+
+/// @brief Heap allocations made by this thread
+/// @details Per thread so the counting itself stays off any shared cache line
+thread_local uint64_t t_allocations = 0;
+
+namespace {
+
+void* countedAlloc(std::size_t size, std::size_t alignment) {
+    ++t_allocations;
+    size = std::max<std::size_t>(size, 1);
+    void* ptr = alignment <= alignof(std::max_align_t)
+        ? std::malloc(size)
+        : std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+} // namespace
+
+// Every form of operator new is replaced and every delete frees with std::free, so each pair matches
+void* operator new(std::size_t size) { return countedAlloc(size, 0); }
+void* operator new[](std::size_t size) { return countedAlloc(size, 0); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return countedAlloc(size, static_cast<std::size_t>(alignment)); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return countedAlloc(size, static_cast<std::size_t>(alignment)); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+
+/// @brief Heap allocations per training iteration once the traversal stack is warm
+/// @details Traversal itself allocates nothing, what remains is storage for info sets visited for the first time, so
+/// new nodes per iteration are reported alongside.
+template<typename GameType>
+static void BM_TrainAllocations(benchmark::State& state) {
+    auto storage = std::make_shared<CFR::MapNodeStorage>();
+    CFR::RegretMinimizer<GameType> minimize(42, storage);
+    minimize.Train(2000);
+    const size_t nodesBefore = storage->size();
+    uint64_t allocations = 0;
+    for (auto _ : state) {
+        const uint64_t before = t_allocations;
+        minimize.Train(1);
+        allocations += t_allocations - before;
+    }
+    state.counters["allocs_per_iter"] = benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+    state.counters["new_nodes_per_iter"] = benchmark::Counter(static_cast<double>(storage->size() - nodesBefore), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK_TEMPLATE(BM_TrainAllocations, Preflop::Game);
+BENCHMARK_TEMPLATE(BM_TrainAllocations, Texas::Game);
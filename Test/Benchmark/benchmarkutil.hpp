@@ -0,0 +1,100 @@
+#ifndef BENCHMARKUTIL_HPP
+#define BENCHMARKUTIL_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../CFR/Node.hpp"
+#include "../../Storage/MapNodeStorage.hpp"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/// @brief Most threads the scaling benchmarks use, every power of two up to it is run
+inline int maxBenchmarkThreads() {
+    return static_cast<int>(std::max(2u, std::thread::hardware_concurrency()));
+}
+
+/// @brief Info set keys shaped like real ones, a hand index followed by an action history
+inline std::vector<std::string> syntheticKeys(size_t count) {
+    std::vector<std::string> keys;
+    keys.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        keys.push_back(std::to_string(1000000 + i * 7919) + (i % 2 == 0 ? "ChRa1" : "Ra1Re2"));
+    }
+    return keys;
+}
+
+/// @brief A node for every key with a strategy sum that differs from node to node
+inline void fillSyntheticStrategy(CFR::MapNodeStorage& storage, const std::vector<std::string>& keys, uint8_t actions) {
+    for (size_t i = 0; i < keys.size(); ++i) {
+        auto node = std::make_shared<CFR::Node>(actions);
+        std::vector<float> strategySum(actions, 1.F);
+        strategySum[i % actions] = 5.F;
+        node->setStrategySum(strategySum);
+        storage.putNode(keys[i], node);
+    }
+}
+
+/// @brief Hardware cache miss counter for the calling thread, reads zero where perf events are unavailable
+class CacheMissCounter {
+public:
+    CacheMissCounter() {
+#ifdef __linux__
+        perf_event_attr attr{};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        m_fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+    ~CacheMissCounter() {
+#ifdef __linux__
+        if (m_fd >= 0) {
+            close(m_fd);
+        }
+#endif
+    }
+    CacheMissCounter(const CacheMissCounter&) = delete;
+    CacheMissCounter& operator=(const CacheMissCounter&) = delete;
+
+    [[nodiscard]] bool available() const { return m_fd >= 0; }
+
+    void start() {
+#ifdef __linux__
+        if (m_fd >= 0) {
+            ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    uint64_t stop() {
+        uint64_t count = 0;
+#ifdef __linux__
+        if (m_fd >= 0) {
+            ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(m_fd, &count, sizeof(count)) != sizeof(count)) {
+                count = 0;
+            }
+        }
+#endif
+        return count;
+    }
+
+private:
+    int m_fd = -1;
+};
+
+#endif //BENCHMARKUTIL_HPP
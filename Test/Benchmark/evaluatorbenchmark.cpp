@@ -0,0 +1,28 @@
+#include <benchmark/benchmark.h>
+
+#include "../../Evaluator/BestResponse.hpp"
+#include "../../Evaluator/Evaluator.hpp"
+#include "../../Evaluator/RandomStrategy.hpp"
+#include "../../Game/GameImpl/Preflop/Game.hpp"
+#include "../../Storage/MapNodeStorage.hpp"
+
+static void BM_EvaluateMirrored(benchmark::State& state) {
+    RandomStrategy<Preflop::Game> first;
+    RandomStrategy<Preflop::Game> second;
+    Evaluator<Preflop::Game> evaluator({static_cast<uint32_t>(state.range(0)), 1, true});
+    EvaluationResult result;
+    for (auto _ : state)
+        result = evaluator.evaluate(first, second, 20000);
+    state.counters["hands_per_second"] = result.handsPerSecond;
+}
+BENCHMARK(BM_EvaluateMirrored)->Arg(1)->Arg(4)->UseRealTime();
+
+static void BM_BestResponseBoards(benchmark::State& state) {
+    CFR::MapNodeStorage uniform;
+    BestResponse<Preflop::Game> bestResponse({static_cast<uint32_t>(state.range(0)), 200, 1, true});
+    BestResponseResult result;
+    for (auto _ : state)
+        result = bestResponse.compute(uniform);
+    state.counters["boards_per_second"] = static_cast<double>(result.boards) / result.seconds;
+}
+BENCHMARK(BM_BestResponseBoards)->Arg(1)->Arg(4)->UseRealTime();
@@ -0,0 +1,155 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <random>
+#include <vector>
+
+#include "../../Game/GameImpl/Preflop/Game.hpp"
+#include "../../Game/GameImpl/Texas/Game.hpp"
+#include "../../Game/Utility/HandAbstraction/hand_index.h"
+#include "../../Game/Utility/Random.hpp"
+#include "../../Game/Utility/Utility.hpp"
+
+template<typename GameType>
+static void BM_CreateGame(benchmark::State& state) {
+    auto rng = typename GameType::Engine(42);
+    for (auto _ : state) {
+        GameType game(rng);
+        benchmark::DoNotOptimize(game);
+    }
+}
+BENCHMARK_TEMPLATE(BM_CreateGame, Preflop::Game);
+BENCHMARK_TEMPLATE(BM_CreateGame, Texas::Game);
+
+template<typename GameType>
+static void BM_Reinitialize(benchmark::State& state) {
+    auto rng = typename GameType::Engine(42);
+    GameType game(rng);
+    game.transition(GameType::Action::None);
+    game.transition(GameType::Action::Call);
+    for (auto _ : state) {
+        game.reInitialize();
+    }
+}
+BENCHMARK_TEMPLATE(BM_Reinitialize, Preflop::Game);
+BENCHMARK_TEMPLATE(BM_Reinitialize, Texas::Game);
+
+template<typename GameType>
+static void BM_GameCopy(benchmark::State& state) {
+    auto rng = typename GameType::Engine(42);
+    GameType game(rng);
+    game.transition(GameType::Action::None);
+    game.transition(GameType::Action::Call);
+    for (auto _ : state) {
+        GameType copy(game);
+        benchmark::DoNotOptimize(copy);
+    }
+}
+BENCHMARK_TEMPLATE(BM_GameCopy, Preflop::Game);
+BENCHMARK_TEMPLATE(BM_GameCopy, Texas::Game);
+
+/// @brief Random playouts from a fresh deal to a terminal state, items are transitions
+template<typename GameType>
+static void BM_Transition(benchmark::State& state) {
+    auto rng = typename GameType::Engine(42);
+    Random::DefaultEngine actions(7);
+    GameType dealt(rng);
+    GameType game = dealt;
+    int64_t transitions = 0;
+    for (auto _ : state) {
+        game = dealt;
+        while (game.getType() != "terminal") {
+            const auto& legal = game.getActions();
+            game.transition(game.getType() == "chance" ? GameType::Action::None
+                                                       : legal[Random::uniformBelow(actions, static_cast<uint32_t>(legal.size()))]);
+            ++transitions;
+        }
+        benchmark::DoNotOptimize(game.getUtility(0));
+    }
+    state.SetItemsProcessed(transitions);
+}
+BENCHMARK_TEMPLATE(BM_Transition, Preflop::Game);
+BENCHMARK_TEMPLATE(BM_Transition, Texas::Game);
+
+/// @brief Building the info set key a storage lookup starts from
+template<typename GameType>
+static void BM_GetInfoSet(benchmark::State& state) {
+    auto rng = typename GameType::Engine(42);
+    GameType game(rng);
+    game.transition(GameType::Action::None);
+    game.transition(GameType::Action::Raise1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(game.getInfoSet(game.getCurrentPlayer()));
+    }
+}
+BENCHMARK_TEMPLATE(BM_GetInfoSet, Preflop::Game);
+BENCHMARK_TEMPLATE(BM_GetInfoSet, Texas::Game);
+
+/// @brief Random 7 card deals, cards numbered 0 to 51 as the hand indexer takes them
+static std::vector<std::array<uint8_t, 7>> randomDeals(size_t count) {
+    std::mt19937 rng(3);
+    std::array<uint8_t, 52> deck{};
+    for (uint8_t c = 0; c < 52; ++c) {
+        deck[c] = c;
+    }
+    std::vector<std::array<uint8_t, 7>> deals(count);
+    for (auto& deal : deals) {
+        std::shuffle(deck.begin(), deck.end(), rng);
+        std::copy_n(deck.begin(), 7, deal.begin());
+    }
+    return deals;
+}
+
+/// @brief Incremental Texas hand indexing through the first range(0) rounds, as the game does street by street
+static void BM_HandIndexNextRound(benchmark::State& state) {
+    const uint8_t cardsPerRound[] = {2, 3, 1, 1};
+    hand_indexer_t indexer;
+    hand_indexer_init(4, cardsPerRound, &indexer);
+    const auto deals = randomDeals(4096);
+    const auto rounds = static_cast<uint32_t>(state.range(0));
+    size_t next = 0;
+    for (auto _ : state) {
+        hand_indexer_state_t indexerState;
+        hand_indexer_state_init(&indexer, &indexerState);
+        const uint8_t* cards = deals[next].data();
+        for (uint32_t round = 0; round < rounds; ++round) {
+            benchmark::DoNotOptimize(hand_index_next_round(&indexer, cards, &indexerState));
+            cards += cardsPerRound[round];
+        }
+        next = (next + 1) % deals.size();
+    }
+    hand_indexer_free(&indexer);
+}
+BENCHMARK(BM_HandIndexNextRound)->DenseRange(1, 4);
+
+/// @brief Indexing a whole river hand in one call
+static void BM_HandIndexLast(benchmark::State& state) {
+    const uint8_t cardsPerRound[] = {2, 3, 1, 1};
+    hand_indexer_t indexer;
+    hand_indexer_init(4, cardsPerRound, &indexer);
+    const auto deals = randomDeals(4096);
+    size_t next = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(hand_index_last(&indexer, deals[next].data()));
+        next = (next + 1) % deals.size();
+    }
+    hand_indexer_free(&indexer);
+}
+BENCHMARK(BM_HandIndexLast);
+
+/// @brief Seven card evaluation through the two plus two table, random deals defeat the cache as showdowns do
+static void BM_LookupHandValue(benchmark::State& state) {
+    Utility::initLookup();
+    std::vector<std::array<int, 7>> hands;
+    for (const auto& deal : randomDeals(4096)) {
+        std::array<int, 7>& hand = hands.emplace_back();
+        // the lookup table numbers cards from 1
+        std::transform(deal.begin(), deal.end(), hand.begin(), [](uint8_t card) { return card + 1; });
+    }
+    size_t next = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Utility::LookupHandValue(hands[next].data()));
+        next = (next + 1) % hands.size();
+    }
+}
+BENCHMARK(BM_LookupHandValue);
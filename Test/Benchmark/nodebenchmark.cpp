@@ -0,0 +1,51 @@
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "../../CFR/Node.hpp"
+#include "../../Storage/NodeSerializer.hpp"
+
+/// @brief One regret matching step and the regret and strategy sum updates of a visit, by action count
+static void BM_NodeRegretUpdate(benchmark::State& state) {
+    const auto actions = static_cast<uint8_t>(state.range(0));
+    CFR::Node node(actions);
+    std::vector<float> regrets(actions);
+    for (uint8_t a = 0; a < actions; ++a) {
+        regrets[a] = static_cast<float>(a % 3) - 1.F;
+    }
+    for (auto _ : state) {
+        node.calcUpdatedStrategy();
+        for (uint8_t a = 0; a < actions; ++a) {
+            node.updateRegretSum(a, regrets[a], 0.5F);
+        }
+        node.updateStrategySum(node.getStrategy(), 0.25F);
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_NodeRegretUpdate)->Arg(2)->Arg(3)->Arg(5)->Arg(9)->Arg(14);
+
+static CFR::Node filledNode(uint8_t actions) {
+    CFR::Node node(actions);
+    std::vector<float> regretSum(actions);
+    std::vector<float> strategySum(actions);
+    for (uint8_t a = 0; a < actions; ++a) {
+        regretSum[a] = 1250.5F - 310.25F * a;
+        strategySum[a] = 0.125F + 7.5F * a;
+    }
+    node.setRegretSum(regretSum);
+    node.setStrategySum(strategySum);
+    return node;
+}
+
+/// @brief Node to record and back, range(0) is the encoding and range(1) the action count
+static void BM_NodeSerializerRoundTrip(benchmark::State& state) {
+    const auto encoding = static_cast<CFR::NodeSerializer::Encoding>(state.range(0));
+    const CFR::Node node = filledNode(static_cast<uint8_t>(state.range(1)));
+    for (auto _ : state) {
+        const std::string record = CFR::NodeSerializer::serialize(node, encoding);
+        benchmark::DoNotOptimize(CFR::NodeSerializer::deserialize(record));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() *
+        CFR::NodeSerializer::serializedSize(static_cast<uint8_t>(state.range(1)), encoding)));
+}
+BENCHMARK(BM_NodeSerializerRoundTrip)->ArgsProduct({{0, 1, 2, 3}, {3, 14}});
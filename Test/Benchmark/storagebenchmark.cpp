@@ -0,0 +1,207 @@
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <unordered_map>
+
+#include "benchmarkutil.hpp"
+#include "../../CFR/RegretMinimizer.hpp"
+#include "../../Game/GameImpl/Texas/Game.hpp"
+#include "../../Game/Utility/Random.hpp"
+#include "../../Storage/AccessTrace.hpp"
+#include "../../Storage/FrozenStrategy.hpp"
+#include "../../Storage/HybridNodeStorage.hpp"
+#include "../../Storage/LRUList.hpp"
+#include "../../Storage/LRUNodeCache.hpp"
+#include "../../Storage/MapNodeStorage.hpp"
+#include "../../Storage/ShardedLRUCache.hpp"
+#include "../../Storage/StrategyServer.hpp"
+
+template<typename K, typename V> using BenchMap = std::unordered_map<K, V>;
+using BenchLRU = CFR::LRUNodeCache<BenchMap, LRUList>;
+using BenchSharded = CFR::ShardedLRUCache<BenchMap, LRUList>;
+using BenchHybrid = CFR::HybridNodeStorage<BenchSharded>;
+
+/// @brief Keys in the storage benchmarks' working set
+constexpr size_t StorageKeys = 1 << 16;
+
+/// @brief Shared by every thread of one storage benchmark run, built in its Setup and dropped in its Teardown
+static std::unique_ptr<CFR::NodeStorage> g_storage;
+static std::vector<std::string> g_keys;
+
+static std::filesystem::path benchmarkDbPath() {
+    return std::filesystem::temp_directory_path() / "cfr_benchmark_storage_db";
+}
+
+/// @brief Empty storage sized for a working set of keys shaped like sampleKey
+template<typename StorageType>
+static std::unique_ptr<CFR::NodeStorage> makeStorage(const std::string& sampleKey, size_t keys) {
+    const size_t entryBytes = BenchLRU::entryBytes(sampleKey, std::make_shared<CFR::Node>(3));
+    if constexpr (std::is_same_v<StorageType, BenchHybrid>) {
+        // a quarter of the working set fits, so misses spill to and read back from the database
+        std::filesystem::remove_all(benchmarkDbPath());
+        return std::make_unique<BenchHybrid>(entryBytes * keys / 4, benchmarkDbPath().string());
+    } else if constexpr (std::is_constructible_v<StorageType, size_t>) {
+        return std::make_unique<StorageType>(entryBytes * keys * 2);
+    } else {
+        return std::make_unique<StorageType>();
+    }
+}
+
+template<typename StorageType>
+static void setUpStorage(const benchmark::State&) {
+    g_keys = syntheticKeys(StorageKeys);
+    g_storage = makeStorage<StorageType>(g_keys.front(), StorageKeys);
+    for (const std::string& key : g_keys) {
+        g_storage->putNode(key, std::make_shared<CFR::Node>(3));
+    }
+}
+
+static void tearDownStorage(const benchmark::State&) {
+    g_storage.reset();
+    g_keys.clear();
+    std::filesystem::remove_all(benchmarkDbPath());
+}
+
+/// @brief Trainer shaped traffic on a populated storage: random lookups, a node replaced on every 16th
+template<typename StorageType>
+static void BM_StorageGetPut(benchmark::State& state) {
+    Random::DefaultEngine engine(static_cast<uint64_t>(state.thread_index()) + 1);
+    uint64_t operation = 0;
+    for (auto _ : state) {
+        const std::string& key = g_keys[Random::uniformBelow(engine, static_cast<uint32_t>(g_keys.size()))];
+        if (++operation % 16 == 0) {
+            g_storage->putNode(key, std::make_shared<CFR::Node>(3));
+        } else {
+            benchmark::DoNotOptimize(g_storage->getNode(key));
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+// the map and the single LRU cache are not safe to share between threads, the sharded and hybrid storages are
+BENCHMARK_TEMPLATE(BM_StorageGetPut, CFR::MapNodeStorage)
+    ->Setup(setUpStorage<CFR::MapNodeStorage>)->Teardown(tearDownStorage);
+BENCHMARK_TEMPLATE(BM_StorageGetPut, BenchLRU)
+    ->Setup(setUpStorage<BenchLRU>)->Teardown(tearDownStorage);
+BENCHMARK_TEMPLATE(BM_StorageGetPut, BenchSharded)
+    ->Setup(setUpStorage<BenchSharded>)->Teardown(tearDownStorage)->ThreadRange(1, maxBenchmarkThreads())->UseRealTime();
+BENCHMARK_TEMPLATE(BM_StorageGetPut, BenchHybrid)
+    ->Setup(setUpStorage<BenchHybrid>)->Teardown(tearDownStorage)->ThreadRange(1, maxBenchmarkThreads())->UseRealTime();
+
+static std::filesystem::path frozenBenchmarkPath() {
+    return std::filesystem::temp_directory_path() / "cfr_benchmark_frozen.bin";
+}
+
+/// @brief range(0) nodes of 12 actions, wide enough that 8 bit probabilities halve the slot, stored at range(1) bits
+static void setUpFrozen(const benchmark::State& state) {
+    g_keys = syntheticKeys(static_cast<size_t>(state.range(0)));
+    CFR::MapNodeStorage source;
+    fillSyntheticStrategy(source, g_keys, 12);
+    const auto precision = state.range(1) == 8 ? CFR::ProbabilityPrecision::Bits8 : CFR::ProbabilityPrecision::Bits16;
+    CFR::FrozenStrategy::write(source, frozenBenchmarkPath(), {precision});
+    g_storage = std::make_unique<CFR::FrozenStrategy>(frozenBenchmarkPath(), true);
+}
+
+static void tearDownFrozen(const benchmark::State&) {
+    g_storage.reset();
+    g_keys.clear();
+    std::filesystem::remove(frozenBenchmarkPath());
+}
+
+static void BM_FrozenStrategyLookup(benchmark::State& state) {
+    const auto& frozen = static_cast<const CFR::FrozenStrategy&>(*g_storage);
+    Random::DefaultEngine engine(static_cast<uint64_t>(state.thread_index()) + 1);
+    float probabilities[CFR::FrozenStrategy::MaxActions];
+    for (auto _ : state) {
+        const std::string& key = g_keys[Random::uniformBelow(engine, static_cast<uint32_t>(g_keys.size()))];
+        benchmark::DoNotOptimize(frozen.lookup(key, probabilities));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_FrozenStrategyLookup)->ArgsProduct({{1 << 10, 1 << 20}, {16, 8}})
+    ->Setup(setUpFrozen)->Teardown(tearDownFrozen)->ThreadRange(1, maxBenchmarkThreads())->UseRealTime();
+
+/// @brief Load generator: one client sending batches of range(0) keys back to back, latency is the client's round trip
+/// @details range(1) is 0 for full distributions and 1 for sampled actions
+static void BM_StrategyServerBatch(benchmark::State& state) {
+    const auto directory = std::filesystem::temp_directory_path();
+    const std::vector<std::string> keys = syntheticKeys(100000);
+    {
+        CFR::MapNodeStorage source;
+        fillSyntheticStrategy(source, keys, 4);
+        CFR::FrozenStrategy::write(source, directory / "cfr_benchmark_served.bin");
+    }
+    CFR::FrozenStrategy frozen(directory / "cfr_benchmark_served.bin", true);
+    CFR::StrategyServer server(frozen, directory / "cfr_benchmark.sock");
+    CFR::StrategyClient client(server.socketPath());
+
+    const auto batchSize = static_cast<size_t>(state.range(0));
+    const auto mode = state.range(1) == 0 ? CFR::StrategyQueryMode::Distribution : CFR::StrategyQueryMode::Sample;
+    std::vector<std::string> batch(batchSize);
+    CFR::LatencyHistogram roundTrips;
+    size_t next = 0;
+    uint64_t seed = 0;
+    for (auto _ : state) {
+        for (std::string& key : batch) {
+            key = keys[next];
+            next = next + 1 == keys.size() ? 0 : next + 1;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        benchmark::DoNotOptimize(client.query(batch, mode, ++seed));
+        roundTrips.record(std::chrono::steady_clock::now() - start);
+    }
+    const CFR::LatencyHistogram::Snapshot latency = roundTrips.snapshot();
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batchSize));
+    state.counters["p50_us"] = static_cast<double>(latency.percentileNanos(0.5)) / 1000.0;
+    state.counters["p99_us"] = static_cast<double>(latency.percentileNanos(0.99)) / 1000.0;
+    std::filesystem::remove(directory / "cfr_benchmark_served.bin");
+}
+BENCHMARK(BM_StrategyServerBatch)->ArgsProduct({{1, 16, 256}, {0, 1}})->UseRealTime();
+
+/// @brief Recorded once from real Texas training and replayed by every BM_TraceReplay run
+static const CFR::AccessTrace& texasTrace() {
+    static const CFR::AccessTrace trace = [] {
+        const auto path = std::filesystem::temp_directory_path() / "cfr_benchmark_texas.trace";
+        {
+            CFR::RegretMinimizer<Texas::Game> minimize{42};
+            minimize.setTrace(std::make_shared<CFR::AccessTraceWriter>(path));
+            minimize.Train(5000);
+        }
+        CFR::AccessTrace loaded = CFR::AccessTrace::load(path);
+        std::filesystem::remove(path);
+        return loaded;
+    }();
+    return trace;
+}
+
+/// @brief Replays the recorded training accesses against an empty storage split across range(0) threads
+/// @details Unlike the synthetic get/put mix the key order, reuse distance and node creation rate are the trainer's
+/// own, and the trace is identical for every storage. As above, the hybrid storage's cache holds a quarter of the keys.
+template<typename StorageType>
+static void BM_TraceReplay(benchmark::State& state) {
+    const CFR::AccessTrace& trace = texasTrace();
+    const std::vector<CFR::AccessTrace> parts = trace.split(static_cast<uint32_t>(state.range(0)));
+    CFR::ReplayResult result;
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::unique_ptr<CFR::NodeStorage> storage = makeStorage<StorageType>(trace.key(0), trace.uniqueKeys());
+        state.ResumeTiming();
+        result = CFR::replayTraces(*storage, parts);
+        state.PauseTiming();
+        storage.reset();
+        state.ResumeTiming();
+    }
+    std::filesystem::remove_all(benchmarkDbPath());
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * trace.records().size()));
+    state.counters["hit_rate"] = result.hitRate();
+    state.counters["get_p50_ns"] = static_cast<double>(result.getLatency.percentileNanos(0.5));
+    state.counters["get_p99_ns"] = static_cast<double>(result.getLatency.percentileNanos(0.99));
+    state.counters["put_p99_ns"] = static_cast<double>(result.putLatency.percentileNanos(0.99));
+}
+BENCHMARK_TEMPLATE(BM_TraceReplay, CFR::MapNodeStorage)->Arg(1)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_TraceReplay, BenchLRU)->Arg(1)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_TraceReplay, BenchSharded)
+    ->RangeMultiplier(2)->Range(1, maxBenchmarkThreads())->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_TraceReplay, BenchHybrid)
+    ->RangeMultiplier(2)->Range(1, maxBenchmarkThreads())->UseRealTime()->Unit(benchmark::kMillisecond);
@@ -0,0 +1,209 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <thread>
+#include <unordered_map>
+
+#include "benchmarkutil.hpp"
+#include "../../CFR/FullTreeCFR.hpp"
+#include "../../CFR/MultiThreadedTrainer.hpp"
+#include "../../CFR/RegretMinimizer.hpp"
+#include "../../CFR/WorkStealingScheduler.hpp"
+#include "../../Game/GameImpl/Preflop/Game.hpp"
+#include "../../Game/GameImpl/Texas/Game.hpp"
+#include "../../Storage/HybridNodeStorage.hpp"
+#include "../../Storage/LRUList.hpp"
+#include "../../Storage/ShardedLRUCache.hpp"
+
+/// @brief How a single minimizer walks its deals
+enum TrainMode : int64_t { OneDeal = 0, Batched = 1, Async = 2 };
+
+/// @brief Iterations per second of one RegretMinimizer, range(0) is the TrainMode
+/// @details In-memory storage answers every lookup without I/O, so Async against Batched is the coroutine overhead
+template<typename GameType, typename Sampling = CFR::ExternalSampling>
+static void BM_Train(benchmark::State& state) {
+    CFR::RegretMinimizer<GameType, CFR::MapNodeStorage, Sampling> minimize{42};
+    constexpr uint32_t iterations = 100;
+    for (auto _ : state) {
+        switch (state.range(0)) {
+            case Batched: minimize.TrainBatched(iterations, 64); break;
+            case Async: minimize.TrainAsync(iterations, 32); break;
+            default: minimize.Train(iterations); break;
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * iterations));
+}
+BENCHMARK_TEMPLATE(BM_Train, Preflop::Game)->Arg(OneDeal)->Arg(Batched)->Arg(Async);
+BENCHMARK_TEMPLATE(BM_Train, Texas::Game)->Arg(OneDeal)->Arg(Batched)->Arg(Async);
+BENCHMARK_TEMPLATE(BM_Train, Preflop::Game, CFR::OutcomeSampling)->Arg(OneDeal)->Arg(Batched);
+BENCHMARK_TEMPLATE(BM_Train, Texas::Game, CFR::OutcomeSampling)->Arg(OneDeal)->Arg(Batched);
+BENCHMARK_TEMPLATE(BM_Train, Preflop::Game, CFR::AverageStrategySampling)->Arg(OneDeal)->Arg(Batched);
+BENCHMARK_TEMPLATE(BM_Train, Texas::Game, CFR::AverageStrategySampling)->Arg(OneDeal)->Arg(Batched);
+
+template<typename K, typename V> using BenchMap = std::unordered_map<K, V>;
+
+/// @brief The storage main trains with, over a database emptied for each benchmark run
+class BenchmarkHybridStorage : public CFR::HybridNodeStorage<CFR::ShardedLRUCache<BenchMap, LRUList>> {
+public:
+    BenchmarkHybridStorage() : HybridNodeStorage(CFR::CacheMemory::autoBudget(), freshDbPath()) {}
+
+    static std::filesystem::path dbPath() { return std::filesystem::temp_directory_path() / "cfr_benchmark_trainer_db"; }
+
+private:
+    static std::string freshDbPath() {
+        std::filesystem::remove_all(dbPath());
+        return dbPath().string();
+    }
+};
+
+/// @brief Iterations per second of a MultiThreadedTrainer with range(0) workers over hybrid storage
+template<typename GameType>
+static void BM_MultiThreadedTrain(benchmark::State& state) {
+    CFR::TrainerOptions options;
+    options.numThreads = static_cast<uint32_t>(state.range(0));
+    options.masterSeed = 42;
+    constexpr uint32_t iterations = 2000;
+    {
+        CFR::MultiThreadedTrainer<GameType, BenchmarkHybridStorage> trainer(options);
+        for (auto _ : state) {
+            trainer.startRun(iterations).wait();
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * iterations));
+    std::filesystem::remove_all(BenchmarkHybridStorage::dbPath());
+}
+BENCHMARK_TEMPLATE(BM_MultiThreadedTrain, Preflop::Game)
+    ->RangeMultiplier(2)->Range(1, maxBenchmarkThreads())->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_MultiThreadedTrain, Texas::Game)
+    ->RangeMultiplier(2)->Range(1, maxBenchmarkThreads())->UseRealTime()->Unit(benchmark::kMillisecond);
+
+/// @brief Full width Preflop iterations over range(0) sampled boards with range(1) threads
+/// @details Every iteration walks every board for both seats, so items are board walks rather than deals
+static void BM_FullTreeIteration(benchmark::State& state) {
+    const auto threads = static_cast<uint32_t>(state.range(1));
+    auto storage = std::make_shared<CFR::ShardedLRUCache<BenchMap, LRUList>>(size_t{4} << 30);
+    CFR::FullTreeCFR<Preflop::Game> solver(storage, {threads, static_cast<uint64_t>(state.range(0)), 1});
+    solver.Train(1);
+    for (auto _ : state) {
+        solver.Train(1);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * solver.getBoards()));
+}
+BENCHMARK(BM_FullTreeIteration)->ArgsProduct({{16, 64}, {1, maxBenchmarkThreads()}})->UseRealTime()->Unit(benchmark::kMillisecond);
+
+/// @brief Training with child info set prefetching off (0) and on (1), with cache misses per iteration when perf allows
+static void BM_TrainPrefetch(benchmark::State& state) {
+    CFR::RegretMinimizer<Texas::Game> Minimize{42};
+    Minimize.setPrefetch(state.range(0) != 0);
+    Minimize.Train(2000);
+    CacheMissCounter misses;
+    uint64_t total = 0;
+    for (auto _ : state) {
+        misses.start();
+        Minimize.Train(100);
+        total += misses.stop();
+    }
+    if (misses.available()) {
+        state.counters["cache_misses_per_iter"] = benchmark::Counter(static_cast<double>(total) / 100.0, benchmark::Counter::kAvgIterations);
+    }
+}
+BENCHMARK(BM_TrainPrefetch)->Arg(0)->Arg(1);
+
+/// @brief Synthetic iteration with the uneven cost of real hands, most end early and some reach a showdown
+static void SpinIteration(std::mt19937& rng) {
+    const auto cost = std::chrono::microseconds(rng() % 4 == 0 ? 40 : 2);
+    const auto until = std::chrono::steady_clock::now() + cost;
+    while (std::chrono::steady_clock::now() < until) {}
+}
+
+/// @brief Runs workers to completion and reports tail idle time, the gap between each worker finishing and the last
+template<typename Setup, typename Worker>
+static void RunSchedulerBenchmark(benchmark::State& state, uint32_t threads, Setup&& setup, Worker&& worker) {
+    double tailIdleMs = 0;
+    uint64_t done = 0;
+    for (auto _ : state) {
+        setup();
+        std::vector<std::chrono::steady_clock::time_point> finish(threads);
+        std::atomic<uint64_t> completed{0};
+        std::vector<std::thread> pool;
+        for (uint32_t t = 0; t < threads; ++t) {
+            pool.emplace_back([&, t] {
+                std::mt19937 rng(t);
+                completed += worker(t, rng);
+                finish[t] = std::chrono::steady_clock::now();
+            });
+        }
+        for (auto& thread : pool) {
+            thread.join();
+        }
+        const auto end = *std::max_element(finish.begin(), finish.end());
+        for (const auto& f : finish) {
+            tailIdleMs += std::chrono::duration<double, std::milli>(end - f).count();
+        }
+        done += completed;
+    }
+    state.counters["tail_idle_ms"] = benchmark::Counter(tailIdleMs, benchmark::Counter::kAvgIterations);
+    state.counters["iterations_run"] = benchmark::Counter(static_cast<double>(done), benchmark::Counter::kAvgIterations);
+    state.SetItemsProcessed(static_cast<int64_t>(done));
+}
+
+/// @brief The previous trainer policy: one mutex protected queue of fixed batches, remainder of total / threads dropped
+static void BM_SchedulerFixedQueue(benchmark::State& state) {
+    const auto threads = static_cast<uint32_t>(state.range(0));
+    constexpr uint32_t total = 20011;
+    std::mutex mutex;
+    std::queue<uint32_t> queue;
+    const uint32_t batchSize = std::max<uint32_t>(1000u, total / (threads * 20));
+    const auto fill = [&] {
+        for (uint32_t i = 0; i < threads; ++i) {
+            for (uint32_t remaining = total / threads; remaining > 0;) {
+                const uint32_t batch = std::min(batchSize, remaining);
+                queue.push(batch);
+                remaining -= batch;
+            }
+        }
+    };
+    RunSchedulerBenchmark(state, threads, fill, [&](uint32_t, std::mt19937& rng) -> uint64_t {
+        uint64_t done = 0;
+        while (true) {
+            uint32_t batch;
+            {
+                std::lock_guard lock(mutex);
+                if (queue.empty()) {
+                    break;
+                }
+                batch = queue.front();
+                queue.pop();
+            }
+            for (uint32_t i = 0; i < batch; ++i) {
+                SpinIteration(rng);
+            }
+            done += batch;
+        }
+        return done;
+    });
+}
+BENCHMARK(BM_SchedulerFixedQueue)->Arg(4)->Arg(8)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void BM_SchedulerWorkStealing(benchmark::State& state) {
+    const auto threads = static_cast<uint32_t>(state.range(0));
+    constexpr uint64_t total = 20011;
+    CFR::WorkStealingScheduler scheduler(threads);
+    RunSchedulerBenchmark(state, threads, [&] { scheduler.reset(total); }, [&](uint32_t t, std::mt19937& rng) -> uint64_t {
+        uint64_t done = 0;
+        for (auto range = scheduler.next(t); range.size() > 0; range = scheduler.next(t)) {
+            for (uint64_t i = range.begin; i < range.end; ++i) {
+                SpinIteration(rng);
+            }
+            done += range.size();
+        }
+        return done;
+    });
+}
+BENCHMARK(BM_SchedulerWorkStealing)->Arg(4)->Arg(8)->UseRealTime()->Unit(benchmark::kMillisecond);
@@ -8,20 +8,25 @@
 #include "../../Game/GameImpl/Preflop/Game.hpp"
 #include "../../Game/GameImpl/Preflop/Game.cpp"
 
+#include "FullTreeCFR.hpp"
 #include "RegretMinimizer.hpp"
+#include "../../Evaluator/BestResponse.hpp"
+#include "../../Evaluator/Evaluator.hpp"
+#include "../../Evaluator/RandomStrategy.hpp"
+#include "../../Storage/LRUList.hpp"
+#include "../../Storage/ShardedLRUCache.hpp"
+#include "../../Storage/StrategyServer.hpp"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
 
 
-//using wsl on my windows machine so detect linux header
-#ifdef __MINGW32__
-#define windowsOS true
-#else
-#define windowsOS false
-#endif
 
 
 namespace Preflop {
 TEST(PreflopTests, Game1) {
-  auto rng = std::mt19937(std::random_device()());
+  auto rng = Game::Engine(std::random_device()());
   Game *game1 = new Game(rng);
   // Expect equality.
   EXPECT_EQ(game1->getType(), "chance");
@@ -31,7 +36,7 @@ TEST(PreflopTests, Game1) {
   EXPECT_EQ(game1->getType(), "terminal");
 
 
-  auto rng2 = std::mt19937(std::random_device()());
+  auto rng2 = Game::Engine(std::random_device()());
   Game *game2 = new Game(rng2);
 
   EXPECT_EQ(game2->currentRound, 0);
@@ -53,7 +58,7 @@ TEST(PreflopTests, Game1) {
   EXPECT_EQ(game2->currentRound, 2);
   EXPECT_EQ(game2->getType(), "terminal");
 
-  auto rng3 = std::mt19937(std::random_device()());
+  auto rng3 = Game::Engine(std::random_device()());
   Game *game3 = new Game(rng3);
 
   EXPECT_EQ(game3->currentRound, 0);
@@ -78,7 +83,7 @@ TEST(PreflopTests, Game1) {
   EXPECT_EQ(game3->currentRound, 2);
   EXPECT_EQ(game3->getType(), "terminal");
 
-  auto rng4 = std::mt19937(std::random_device()());
+  auto rng4 = Game::Engine(std::random_device()());
   Game *game4 = new Game(rng4);
 
   EXPECT_EQ(game4->currentRound, 0);
@@ -129,7 +134,7 @@ TEST(PreflopUtilityTests, WorkingTest) {
 TEST(PreflopRegretMinTests, Test1) {
   //Utility::initLookup();
   uint64_t seed = 120;
-  auto rng3 = std::mt19937(seed);
+  auto rng3 = Game::Engine(seed);
   Game *game3 = new Game(rng3);
   //game3->transition(Action::None);
 
@@ -150,13 +155,248 @@ TEST(PreflopRegretMinTests, Test1) {
     p1look[i - 2] = game3->getPlayableCards(i);
   }
 
-  if (windowsOS) {
-    EXPECT_EQ(weiUtil, -218.75f);
-  } else {
-    EXPECT_EQ(weiUtil, 2250.f);
+  // dealing no longer goes through the standard library shuffle, so the value is the same on every platform
+  EXPECT_EQ(weiUtil, -218.75f);
+
+}
+
+TEST(PreflopEvaluatorTests, MirroredSelfPlayCancels) {
+  RandomStrategy<Game> first;
+  RandomStrategy<Game> second;
+  Evaluator<Game> evaluator({2, 5, true});
+  const EvaluationResult result = evaluator.evaluate(first, second, 1000);
+
+  // identical strategies on mirrored seats with the same action draws play each hand both ways
+  EXPECT_EQ(result.hands, 1000u);
+  EXPECT_EQ(result.meanMbb, 0.0);
+  EXPECT_EQ(result.standardErrorMbb, 0.0);
+  EXPECT_GT(result.handsPerSecond, 0.0);
+}
+
+TEST(PreflopEvaluatorTests, SeededEvaluationReproduces) {
+  auto trained = std::make_shared<CFR::MapNodeStorage>();
+  {
+    CFR::RegretMinimizer<Game> minimizer(3, trained);
+    minimizer.Train(500);
+  }
+  RandomStrategy<Game> random;
+
+  for (const bool mirrored : {false, true}) {
+    Evaluator<Game> evaluator({3, 17, mirrored});
+    const EvaluationResult a = evaluator.evaluate(*trained, random, 2000);
+    const EvaluationResult b = evaluator.evaluate(*trained, random, 2000);
+    EXPECT_EQ(a.hands, 2000u);
+    EXPECT_EQ(a.meanMbb, b.meanMbb);
+    EXPECT_EQ(a.standardErrorMbb, b.standardErrorMbb);
+    EXPECT_GT(a.standardErrorMbb, 0.0);
+  }
+}
+/// @brief Plays the first listed action at every info set, which is card independent so its best response is known
+class FirstActionStorage : public CFR::NodeStorage {
+ public:
+  FirstActionStorage() {
+    m_three->setStrategySum({1.f, 0.f, 0.f});
+    m_two->setStrategySum({1.f, 0.f});
+  }
+  std::shared_ptr<CFR::Node> getNode(const std::string& infoSet) override {
+    const size_t digits = std::min(infoSet.find_first_not_of("0123456789"), infoSet.size());
+    const std::string_view history = std::string_view(infoSet).substr(digits);
+    // the opening and any spot facing Ra1 offer three actions, everything else two
+    return history.empty() || history.ends_with("Ra1") ? m_three : m_two;
+  }
+  void putNode(const std::string&, std::shared_ptr<CFR::Node>) override {}
+  bool hasNode(const std::string&) const override { return true; }
+  void removeNode(const std::string&) override {}
+  size_t size() const override { return 0; }
+  void clear() override {}
+
+ private:
+  std::shared_ptr<CFR::Node> m_three = std::make_shared<CFR::Node>(3);
+  std::shared_ptr<CFR::Node> m_two = std::make_shared<CFR::Node>(2);
+};
+
+TEST(PreflopBestResponseTests, PureStrategyHasKnownExploitability) {
+  // the strategy raises, folds to any raise and opens the river with a raise. Seat 0 limps, calls the raise and
+  // reraises the river raise to take 4000. Seat 1 calls, checks the river and reraises the raise to take 3500.
+  FirstActionStorage strategy;
+  BestResponse<Game> bestResponse({2, 12, 7, true});
+  const BestResponseResult result = bestResponse.compute(strategy);
+
+  EXPECT_FALSE(result.exact);
+  EXPECT_EQ(result.boards, 12u);
+  EXPECT_NEAR(result.bestResponseMbb[0], 4000.0, 1e-6);
+  EXPECT_NEAR(result.bestResponseMbb[1], 3500.0, 1e-6);
+  EXPECT_NEAR(result.exploitabilityMbb, 3750.0, 1e-6);
+}
+
+TEST(PreflopBestResponseTests, ThreadCountDoesNotChangeTheResult) {
+  auto trained = std::make_shared<CFR::MapNodeStorage>();
+  {
+    CFR::RegretMinimizer<Game> minimizer(5, trained);
+    minimizer.Train(500);
+  }
+  const BestResponseResult single = BestResponse<Game>({1, 24, 3, true}).compute(*trained);
+  const BestResponseResult parallel = BestResponse<Game>({4, 24, 3, true}).compute(*trained);
+
+  EXPECT_NEAR(single.bestResponseMbb[0], parallel.bestResponseMbb[0], 1e-6);
+  EXPECT_NEAR(single.bestResponseMbb[1], parallel.bestResponseMbb[1], 1e-6);
+  // neither seat of a zero sum game can lose to a best response
+  EXPECT_GT(single.exploitabilityMbb, 0.0);
+}
+
+/// @brief Exploitability on a fixed board sample of the untrained, uniform, strategy and after training with Sampling
+template<typename Sampling>
+std::pair<double, double> samplingExploitability(uint32_t iterations) {
+  auto storage = std::make_shared<CFR::MapNodeStorage>();
+  const BestResponse<Game> bestResponse({1, 24, 5, true});
+  const double uniform = bestResponse.compute(*storage).exploitabilityMbb;
+  CFR::RegretMinimizer<Game, CFR::MapNodeStorage, Sampling> minimizer(11, storage);
+  minimizer.Train(iterations);
+  return {uniform, bestResponse.compute(*storage).exploitabilityMbb};
+}
+
+TEST(PreflopSamplingTests, OutcomeSamplingWalksOneTrajectory) {
+  CFR::RegretMinimizer<Game, CFR::MapNodeStorage, CFR::OutcomeSampling> outcome(11);
+  CFR::RegretMinimizer<Game> external(11);
+  outcome.Train(1000);
+  external.Train(1000);
+  // external sampling enumerates every update player action, outcome sampling follows one of them
+  EXPECT_GT(outcome.getNodesTouched(), 0u);
+  EXPECT_LT(outcome.getNodesTouched() * 2, external.getNodesTouched());
+}
+
+TEST(PreflopSamplingTests, OutcomeSamplingConverges) {
+  // one path per deal learns less from each, so it gets more deals
+  const auto [uniform, trained] = samplingExploitability<CFR::OutcomeSampling>(20000);
+  EXPECT_LT(trained, uniform - 50.0);
+}
+
+TEST(PreflopSamplingTests, AverageStrategySamplingConverges) {
+  const auto [uniform, trained] = samplingExploitability<CFR::AverageStrategySampling>(2000);
+  EXPECT_LT(trained, uniform - 50.0);
+}
+
+TEST(PreflopFullTreeTests, ConvergesOnItsBoardSample) {
+  // BestResponse with the same board sample measures the game the solver plays
+  auto storage = std::make_shared<CFR::MapNodeStorage>();
+  CFR::FullTreeCFR<Game> solver(storage, {1, 4, 3});
+  EXPECT_EQ(solver.getBoards(), 4u);
+  solver.Train(2);
+  const double early = BestResponse<Game>({1, 4, 3, true}).compute(*storage).exploitabilityMbb;
+  solver.Train(30);
+  const double late = BestResponse<Game>({1, 4, 3, true}).compute(*storage).exploitabilityMbb;
+
+  EXPECT_EQ(solver.getIterations(), 32u);
+  EXPECT_GT(late, 0.0);
+  EXPECT_LT(late, early / 3);
+}
+
+template<typename K, typename V> using FullTreeMap = std::unordered_map<K, V>;
+
+TEST(PreflopFullTreeTests, ThreadCountDoesNotChangeTheResult) {
+  std::array<double, 2> exploitability{};
+  for (const uint32_t threads : {1u, 3u}) {
+    auto storage = std::make_shared<CFR::ShardedLRUCache<FullTreeMap, LRUList>>(size_t{1} << 30);
+    CFR::FullTreeCFR<Game> solver(storage, {threads, 6, 9});
+    solver.Train(3);
+    exploitability[threads == 1 ? 0 : 1] = BestResponse<Game>({1, 6, 9, true}).compute(*storage).exploitabilityMbb;
+  }
+  // chunks are summed in a fixed order and every board class updates only its own nodes
+  EXPECT_EQ(exploitability[0], exploitability[1]);
+}
+
+TEST(PreflopStrategyServerTests, AnswersBatchesKeyedByGameInfoSets) {
+  // a client builds its keys by replaying the line through the game, as the trainer did
+  auto rng = Game::Engine(11);
+  Game game(rng);
+  game.transition(Game::Action::None);
+  CFR::MapNodeStorage trained;
+  std::vector<std::string> infoSets;
+  for (const Game::Action action : {Game::Action::Call, Game::Action::Check}) {
+    infoSets.push_back(game.getInfoSet(game.getCurrentPlayer()));
+    std::vector<float> strategySum(game.getActions().size());
+    for (size_t a = 0; a < strategySum.size(); ++a) {
+      strategySum[a] = static_cast<float>(a + 1);
+    }
+    auto node = std::make_shared<CFR::Node>(static_cast<uint8_t>(strategySum.size()));
+    node->setStrategySum(strategySum);
+    trained.putNode(infoSets.back(), node);
+    game.transition(action);
+  }
+  infoSets.emplace_back("0000Ch");
+
+  const auto frozenPath = std::filesystem::temp_directory_path() / "cfr_prefloptest_served.bin";
+  CFR::FrozenStrategy::write(trained, frozenPath);
+  CFR::FrozenStrategy frozen(frozenPath);
+  for (CFR::NodeStorage* strategy : {static_cast<CFR::NodeStorage*>(&trained), static_cast<CFR::NodeStorage*>(&frozen)}) {
+    CFR::StrategyServer server(*strategy, std::filesystem::temp_directory_path() / "cfr_prefloptest.sock");
+    CFR::StrategyClient client(server.socketPath());
+
+    const auto distributions = client.query(infoSets, CFR::StrategyQueryMode::Distribution);
+    ASSERT_EQ(distributions.size(), 3u);
+    for (size_t i = 0; i < 2; ++i) {
+      const std::vector<float> expected = trained.getNode(infoSets[i])->averageStrategyOf();
+      ASSERT_EQ(distributions[i].actions, expected.size());
+      for (size_t a = 0; a < expected.size(); ++a) {
+        EXPECT_NEAR(distributions[i].probabilities[a], expected[a], 2e-5);
+      }
+    }
+    EXPECT_FALSE(distributions[2].known());
+
+    const auto samples = client.query(infoSets, CFR::StrategyQueryMode::Sample, 5);
+    const auto repeated = client.query(infoSets, CFR::StrategyQueryMode::Sample, 5);
+    for (size_t i = 0; i < 2; ++i) {
+      EXPECT_TRUE(samples[i].probabilities.empty());
+      EXPECT_LT(samples[i].sampledAction, samples[i].actions);
+      EXPECT_EQ(samples[i].sampledAction, repeated[i].sampledAction);
+    }
+    EXPECT_EQ(server.queriesServed(), 9u);
+  }
+  std::filesystem::remove(frozenPath);
+}
+
+/// @brief A raw connection to a strategy server, for clients that misbehave
+int connectRaw(const std::filesystem::path& socketPath) {
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+  const int client = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  EXPECT_EQ(::connect(client, reinterpret_cast<const sockaddr*>(&address), sizeof(address)), 0);
+  return client;
+}
+
+TEST(PreflopStrategyServerTests, ReapsClosedConnections) {
+  CFR::MapNodeStorage strategy;
+  CFR::StrategyServer server(strategy, std::filesystem::temp_directory_path() / "cfr_prefloptest_reap.sock");
+  for (int i = 0; i < 3; ++i) {
+    CFR::StrategyClient client(server.socketPath());
+    EXPECT_EQ(client.query(std::vector<std::string>{"0000"}, CFR::StrategyQueryMode::Sample).size(), 1u);
+  }
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (server.openConnections() > 0 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
   }
+  EXPECT_EQ(server.openConnections(), 0u);
+}
 
+TEST(PreflopStrategyServerTests, DropsClientStalledMidFrame) {
+  CFR::MapNodeStorage strategy;
+  const auto start = std::chrono::steady_clock::now();
+  int client = -1;
+  {
+    CFR::StrategyServer server(strategy, std::filesystem::temp_directory_path() / "cfr_prefloptest_stall.sock",
+                               std::chrono::milliseconds(100));
+    client = connectRaw(server.socketPath());
+    // half a length prefix, then nothing
+    const uint16_t partial = 8;
+    ::send(client, &partial, sizeof(partial), MSG_NOSIGNAL);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+  // the server stopped without waiting for the rest of the frame
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+  ::close(client);
 }
+
 TEST(PreflopHandAbstract, MainTest) {
   uint8_t cards1[] ={2};
   uint8_t cards2[] ={2,5};
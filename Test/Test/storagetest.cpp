@@ -0,0 +1,461 @@
+#include <gtest/gtest.h>
+
+#include "../../Storage/LRUNodeCache.hpp"
+#include "../../Storage/ShardedLRUCache.hpp"
+#include "../../Storage/LRUList.hpp"
+#include "../../Storage/NodeSerializer.hpp"
+#include "../../Storage/RocksDBNodeStorage.hpp"
+#include "../../Storage/HybridNodeStorage.hpp"
+#include "../../Storage/MapNodeStorage.hpp"
+#include "../../Storage/FrozenStrategy.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <thread>
+#include <unordered_map>
+
+
+namespace CFR {
+template<typename K, typename V> using TestMap = std::unordered_map<K, V>;
+
+TEST(StorageTests, LRUCacheStaysWithinByteBudget) {
+  const std::string key = "12345678901234567890Ch";
+  const size_t entryBytes = LRUNodeCache<TestMap, LRUList>::entryBytes(key, std::make_shared<Node>(3));
+  size_t evicted = 0;
+  LRUNodeCache<TestMap, LRUList> cache(entryBytes * 10, [&](const std::string&, std::shared_ptr<Node>) { ++evicted; });
+
+  for (int i = 0; i < 100; ++i) {
+    cache.putNode(key + std::to_string(i), std::make_shared<Node>(3));
+    EXPECT_LE(cache.getMemoryStats().usedBytes, entryBytes * 10);
+  }
+  EXPECT_GT(evicted, 0u);
+  EXPECT_EQ(cache.size() + evicted, 100u);
+  EXPECT_EQ(cache.getMemoryStats().entries, cache.size());
+
+  cache.clear();
+  EXPECT_EQ(cache.getMemoryStats().usedBytes, 0u);
+}
+
+TEST(StorageTests, ShardedCacheSumsShardBudgets) {
+  ShardedLRUCache<TestMap, LRUList> cache(1 << 20);
+  cache.putNode("Ch", std::make_shared<Node>(2));
+  cache.putNode("ChRa1", std::make_shared<Node>(3));
+
+  const CacheMemoryStats stats = cache.getMemoryStats();
+  EXPECT_EQ(stats.budgetBytes, cache.getTotalCapacity());
+  EXPECT_EQ(stats.entries, 2u);
+  EXPECT_GT(stats.usedBytes, 0u);
+
+  cache.removeNode("Ch");
+  EXPECT_LT(cache.getMemoryStats().usedBytes, stats.usedBytes);
+}
+
+TEST(StorageTests, AutoBudgetIsPositive) {
+  EXPECT_GT(CacheMemory::availableMemoryBytes(), 0u);
+  EXPECT_GE(CacheMemory::autoBudget(), CacheMemory::autoBudget(0.0));
+  EXPECT_GT(CacheMemory::autoBudget(0.0), 0u);
+}
+TEST(StorageTests, SerializerRoundTripsEveryEncoding) {
+  Node node(3);
+  node.setRegretSum({1250.5F, -310.25F, 0.F});
+  node.setStrategySum({0.125F, 42.F, 7.5F});
+
+  using Encoding = NodeSerializer::Encoding;
+  for (const auto& [encoding, tolerance] : {std::pair{Encoding::Float32, 0.F}, std::pair{Encoding::Float16, 1e-3F},
+                                           std::pair{Encoding::BFloat16, 4e-3F}, std::pair{Encoding::Int16Scaled, 1e-4F}}) {
+    const std::string data = NodeSerializer::serialize(node, encoding);
+    EXPECT_EQ(data.size(), NodeSerializer::serializedSize(3, encoding));
+
+    const auto decoded = NodeSerializer::deserialize(data);
+    ASSERT_NE(decoded, nullptr);
+    for (int i = 0; i < 3; ++i) {
+      // relative to the largest element of each vector, which is how the scaled encodings lose precision
+      EXPECT_NEAR(decoded->getRegretSum()[i], node.getRegretSum()[i], tolerance * 1250.5F);
+      EXPECT_NEAR(decoded->getStrategySum()[i], node.getStrategySum()[i], tolerance * 42.F);
+    }
+  }
+  EXPECT_EQ(NodeSerializer::serialize(node).size(), 3u + 2 * 3 * sizeof(float));
+  EXPECT_EQ(NodeSerializer::serialize(node, Encoding::Float16).size(), 3u + 2 * 3 * sizeof(uint16_t));
+}
+TEST(StorageTests, Float16ClampsSumsPastHalfRange) {
+  Node node(3);
+  node.setRegretSum({70000.F, -1e9F, std::numeric_limits<float>::infinity()});
+  node.setStrategySum({65504.F, 1e6F, 12.F});
+
+  const auto decoded = NodeSerializer::deserialize(NodeSerializer::serialize(node, NodeSerializer::Encoding::Float16));
+  ASSERT_NE(decoded, nullptr);
+  EXPECT_EQ(decoded->getRegretSum(), (std::vector<float>{65504.F, -65504.F, 65504.F}));
+  EXPECT_EQ(decoded->getStrategySum(), (std::vector<float>{65504.F, 65504.F, 12.F}));
+  for (const float probability : decoded->averageStrategyOf()) {
+    EXPECT_TRUE(std::isfinite(probability));
+  }
+  for (const float probability : decoded->getStrategy()) {
+    EXPECT_TRUE(std::isfinite(probability));
+  }
+}
+
+TEST(StorageTests, SerializerReadsLegacyRecords) {
+  const std::vector<float> regretSum{3.F, -1.F}, strategy{1.F, 0.F}, strategySum{0.75F, 0.25F}, average{0.75F, 0.25F};
+  std::string legacy(1 + 4 * 2 * sizeof(float), '\0');
+  legacy[0] = 2;
+  char* ptr = legacy.data() + 1;
+  for (const auto* vector : {&regretSum, &strategy, &strategySum, &average}) {
+    std::memcpy(ptr, vector->data(), 2 * sizeof(float));
+    ptr += 2 * sizeof(float);
+  }
+
+  const auto decoded = NodeSerializer::deserialize(legacy);
+  ASSERT_NE(decoded, nullptr);
+  EXPECT_EQ(decoded->getRegretSum(), regretSum);
+  EXPECT_EQ(decoded->getStrategySum(), strategySum);
+  EXPECT_EQ(decoded->getStrategy(), strategy);
+  EXPECT_EQ(NodeSerializer::deserialize(legacy.substr(1)), nullptr);
+}
+TEST(StorageTests, BettingRoundFromInfoSet) {
+  EXPECT_EQ(RocksDBNodeStorage::bettingRound("1234"), 0u);
+  EXPECT_EQ(RocksDBNodeStorage::bettingRound("1234Ca"), 0u);       // small blind limp
+  EXPECT_EQ(RocksDBNodeStorage::bettingRound("1234Ra1Re2"), 0u);
+  EXPECT_EQ(RocksDBNodeStorage::bettingRound("98765CaCh"), 1u);    // limp then big blind checks
+  EXPECT_EQ(RocksDBNodeStorage::bettingRound("98765Ra1Ca"), 1u);
+  EXPECT_EQ(RocksDBNodeStorage::bettingRound("98765Ra1CaCh"), 1u);
+  EXPECT_EQ(RocksDBNodeStorage::bettingRound("5CaChChCh"), 2u);
+  EXPECT_EQ(RocksDBNodeStorage::bettingRound("5CaChChRa1Re2Ca"), 2u);
+  EXPECT_EQ(RocksDBNodeStorage::bettingRound("5Ra1CaChChRa1CaCh"), 3u);
+}
+
+TEST(StorageTests, RocksDBRoutesRoundsAndReopens) {
+  const auto path = std::filesystem::temp_directory_path() / "cfr_storagetest_db";
+  std::filesystem::remove_all(path);
+  {
+    RocksDBNodeStorage storage(path.string());
+    storage.putNode("12Ra1", std::make_shared<Node>(3));
+    storage.putNode("3456Ra1CaChCh", std::make_shared<Node>(2));
+    EXPECT_TRUE(storage.hasNode("12Ra1"));
+    EXPECT_FALSE(storage.hasNode("12Ca"));
+    EXPECT_EQ(storage.getNode("3456Ra1CaChCh")->getRegretSum().size(), 2u);
+  }
+  {
+    RocksDBNodeStorage storage(path.string());
+    ASSERT_NE(storage.getNode("12Ra1"), nullptr);
+    storage.removeNode("12Ra1");
+    EXPECT_EQ(storage.getNode("12Ra1"), nullptr);
+    storage.clear();
+    EXPECT_FALSE(storage.hasNode("3456Ra1CaChCh"));
+  }
+  std::filesystem::remove_all(path);
+}
+TEST(StorageTests, BatchedReadsMatchSingleReads) {
+  const auto path = std::filesystem::temp_directory_path() / "cfr_storagetest_batch_db";
+  std::filesystem::remove_all(path);
+  {
+    HybridNodeStorage<LRUNodeCache<TestMap, LRUList>> storage(1 << 20, path.string());
+    storage.putNode("12Ra1", std::make_shared<Node>(3));
+    storage.putNode("3456Ra1CaChCh", std::make_shared<Node>(2));
+    storage.flush();
+
+    const std::vector<std::string> keys{"3456Ra1CaChCh", "12Ca", "12Ra1"};
+    std::vector<std::shared_ptr<Node>> nodes(keys.size());
+    storage.getNodes(keys, nodes);
+    ASSERT_NE(nodes[0], nullptr);
+    EXPECT_EQ(nodes[0]->getRegretSum().size(), 2u);
+    EXPECT_EQ(nodes[1], nullptr);
+    ASSERT_NE(nodes[2], nullptr);
+    EXPECT_EQ(nodes[2]->getRegretSum().size(), 3u);
+    // the batch promoted what it read, a second lookup is a cache hit
+    EXPECT_EQ(storage.getNode("12Ra1"), nodes[2]);
+  }
+  std::filesystem::remove_all(path);
+}
+TEST(StorageTests, RocksDBMergesDeltaRecords) {
+  const auto path = std::filesystem::temp_directory_path() / "cfr_storagetest_merge_db";
+  std::filesystem::remove_all(path);
+  {
+    RocksDBNodeStorage storage(path.string());
+    Node delta(2);
+    delta.setRegretSum({1.F, -2.F});
+    delta.setStrategySum({0.5F, 0.25F});
+
+    storage.mergeNode("7Ra1", delta);
+    storage.mergeNode("7Ra1", delta);
+    auto merged = storage.getNode("7Ra1");
+    ASSERT_NE(merged, nullptr);
+    EXPECT_EQ(merged->getRegretSum(), (std::vector<float>{2.F, -4.F}));
+    EXPECT_EQ(merged->getStrategySum(), (std::vector<float>{1.F, 0.5F}));
+
+    // a full write replaces whatever deltas came before it
+    storage.putNode("7Ra1", std::make_shared<Node>(2));
+    storage.mergeNode("7Ra1", delta);
+    EXPECT_EQ(storage.getNode("7Ra1")->getRegretSum(), (std::vector<float>{1.F, -2.F}));
+  }
+  std::filesystem::remove_all(path);
+}
+
+TEST(StorageTests, HybridWriteOnlyDeltaSpill) {
+  const auto path = std::filesystem::temp_directory_path() / "cfr_storagetest_delta_db";
+  std::filesystem::remove_all(path);
+  RocksDBStorageOptions options;
+  options.rounds = {ColumnFamilyConfig{"round0"}};
+  options.rounds[0].spillPolicy = SpillPolicy::WriteOnlyDelta;
+  {
+    // room for one node, caching another evicts it
+    const size_t entryBytes = LRUNodeCache<TestMap, LRUList>::entryBytes("3Ra1", std::make_shared<Node>(2));
+    HybridNodeStorage<LRUNodeCache<TestMap, LRUList>> storage(entryBytes, path.string(), options);
+    ASSERT_EQ(storage.getNode("3Ra1"), nullptr);
+    storage.putNode("3Ra1", std::make_shared<Node>(2));
+    for (int residency = 0; residency < 3; ++residency) {
+      // every residency starts from the regret accumulated before the node was evicted
+      auto node = storage.getNode("3Ra1");
+      ASSERT_NE(node, nullptr);
+      EXPECT_EQ(node->getRegretSum()[0], static_cast<float>(2 * residency));
+      node->updateRegretSum(0, 1.F, 1.F);
+      // a flush keeps the node cached, its gain must not be merged again when it is evicted
+      storage.flush();
+      node->updateRegretSum(0, 1.F, 1.F);
+      if (storage.getNode("4Ra1") == nullptr) {
+        storage.putNode("4Ra1", std::make_shared<Node>(2));
+      }
+    }
+    EXPECT_EQ(storage.readNode("3Ra1")->getRegretSum()[0], 6.F);
+  }
+  {
+    HybridNodeStorage<LRUNodeCache<TestMap, LRUList>> storage(1 << 20, path.string(), options);
+    EXPECT_EQ(storage.getNode("3Ra1")->getRegretSum()[0], 6.F);
+  }
+  std::filesystem::remove_all(path);
+}
+TEST(StorageTests, HybridSizeCountsResidentNodesOnce) {
+  const auto path = std::filesystem::temp_directory_path() / "cfr_storagetest_size_db";
+  const auto statsPath = std::filesystem::temp_directory_path() / "cfr_storagetest_stats.jsonl";
+  std::filesystem::remove_all(path);
+  std::filesystem::remove(statsPath);
+  {
+    const size_t entryBytes = LRUNodeCache<TestMap, LRUList>::entryBytes("0000Ra1", std::make_shared<Node>(3));
+    HybridNodeStorage<LRUNodeCache<TestMap, LRUList>> storage(entryBytes * 8, path.string());
+    storage.startStatsReporter(statsPath.string(), std::chrono::milliseconds(5));
+    for (int i = 0; i < 50; ++i) {
+      const std::string key = std::to_string(1000 + i) + "Ra1";
+      if (storage.getNode(key) == nullptr) {
+        storage.putNode(key, std::make_shared<Node>(3));
+      }
+    }
+    // revisiting evicted nodes must not grow the count
+    for (int i = 0; i < 50; ++i) {
+      const std::string key = std::to_string(1000 + i) + "Ra1";
+      if (storage.getNode(key) == nullptr) {
+        storage.putNode(key, std::make_shared<Node>(3));
+      }
+    }
+    EXPECT_EQ(storage.size(), 50u);
+
+    const StorageStats stats = storage.getStats();
+    EXPECT_GT(stats.cache.evictions, 0u);
+    EXPECT_GT(stats.disk.reads, 0u);
+    EXPECT_GT(stats.disk.bytesWritten, 0u);
+    EXPECT_EQ(stats.spillLatency.count, stats.disk.writes);
+    storage.stopStatsReporter();
+  }
+  {
+    HybridNodeStorage<LRUNodeCache<TestMap, LRUList>> storage(1 << 20, path.string());
+    EXPECT_EQ(storage.size(), 50u);
+  }
+
+  std::ifstream lines(statsPath);
+  std::string line;
+  ASSERT_TRUE(std::getline(lines, line));
+  EXPECT_EQ(line.front(), '{');
+  EXPECT_NE(line.find("\"pending_compaction_bytes\""), std::string::npos);
+  std::filesystem::remove_all(path);
+  std::filesystem::remove(statsPath);
+}
+TEST(StorageTests, HybridSizeCountsDeltaRevisitsOnce) {
+  const auto path = std::filesystem::temp_directory_path() / "cfr_storagetest_delta_size_db";
+  std::filesystem::remove_all(path);
+  RocksDBStorageOptions options;
+  options.rounds = {ColumnFamilyConfig{"round0"}};
+  options.rounds[0].spillPolicy = SpillPolicy::WriteOnlyDelta;
+  {
+    const size_t entryBytes = LRUNodeCache<TestMap, LRUList>::entryBytes("0000Ra1", std::make_shared<Node>(3));
+    HybridNodeStorage<LRUNodeCache<TestMap, LRUList>> storage(entryBytes * 8, path.string(), options);
+    // revisiting evicted nodes must not grow the count in delta rounds either
+    for (int pass = 0; pass < 3; ++pass) {
+      for (int i = 0; i < 50; ++i) {
+        const std::string key = std::to_string(1000 + i) + "Ra1";
+        if (storage.getNode(key) == nullptr) {
+          storage.putNode(key, std::make_shared<Node>(3));
+        }
+      }
+    }
+    EXPECT_EQ(storage.size(), 50u);
+    EXPECT_GT(storage.getStats().cache.evictions, 0u);
+  }
+  {
+    HybridNodeStorage<LRUNodeCache<TestMap, LRUList>> storage(1 << 20, path.string(), options);
+    EXPECT_EQ(storage.size(), 50u);
+  }
+  std::filesystem::remove_all(path);
+}
+TEST(StorageTests, SnapshotKeepsValuesFromCapture) {
+  const auto dir = std::filesystem::temp_directory_path() / "cfr_storagetest_snapshot";
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+  MapNodeStorage storage;
+  for (int i = 0; i < 64; ++i) {
+    auto node = std::make_shared<Node>(2);
+    node->updateRegretSum(0, static_cast<float>(i), 1.F);
+    storage.putNode(std::to_string(1000 + i) + "Ra1", node);
+  }
+  const std::function<void()> write = storage.captureSnapshot(dir);
+
+  // training carries on before and while the capture is written, changes must not reach it
+  const auto train = [&storage](int first) {
+    for (int i = first; i < 64; i += 2) {
+      const auto node = storage.getNode(std::to_string(1000 + i) + "Ra1");
+      storage.beforeUpdate(node);
+      node->updateRegretSum(0, 100.F, 1.F);
+    }
+  };
+  train(0);
+  storage.putNode("9999Ra1", std::make_shared<Node>(2));
+  std::thread writer(write);
+  train(1);
+  writer.join();
+
+  MapNodeStorage restored;
+  restored.restoreSnapshot(dir);
+  EXPECT_EQ(restored.size(), 64u);
+  EXPECT_FALSE(restored.hasNode("9999Ra1"));
+  for (int i = 0; i < 64; ++i) {
+    EXPECT_EQ(restored.getNode(std::to_string(1000 + i) + "Ra1")->getRegretSum()[0], static_cast<float>(i));
+    EXPECT_EQ(storage.getNode(std::to_string(1000 + i) + "Ra1")->getRegretSum()[0], static_cast<float>(i + 100));
+  }
+  std::filesystem::remove_all(dir);
+}
+TEST(StorageTests, HybridSnapshotKeepsValuesFromCapture) {
+  const auto path = std::filesystem::temp_directory_path() / "cfr_storagetest_snapshot_db";
+  const auto dir = std::filesystem::temp_directory_path() / "cfr_storagetest_hybrid_snapshot";
+  std::filesystem::remove_all(path);
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+  RocksDBStorageOptions options;
+  options.rounds = {ColumnFamilyConfig{"round0"}};
+  options.rounds[0].spillPolicy = SpillPolicy::WriteOnlyDelta;
+  using Cache = ShardedLRUCache<TestMap, LRUList>;
+  const auto key = [](int i) { return std::to_string(1000 + i) + "Ra1"; };
+  {
+    // about four entries per shard, so the capture starts with nodes both cached and spilled and evicts more while written
+    const size_t entryBytes = LRUNodeCache<TestMap, LRUList>::entryBytes(key(0), std::make_shared<Node>(2));
+    HybridNodeStorage<Cache> storage(entryBytes * 128, path.string(), options);
+    for (int i = 0; i < 400; ++i) {
+      auto node = std::make_shared<Node>(2);
+      node->updateRegretSum(0, static_cast<float>(i), 1.F);
+      storage.putNode(key(i), node);
+    }
+    const std::function<void()> write = storage.captureSnapshot(dir);
+    ASSERT_GT(storage.getStats().cache.evictions, 0u);
+    const uint64_t evictionsBefore = storage.getStats().cache.evictions;
+
+    const auto train = [&storage, &key](int first) {
+      for (int i = first; i < 400; i += 2) {
+        const auto node = storage.getNode(key(i));
+        storage.beforeUpdate(node);
+        node->updateRegretSum(0, 1000.F, 1.F);
+      }
+    };
+    train(0);
+    storage.putNode("9999Ra1", std::make_shared<Node>(2));
+    std::thread writer(write);
+    train(1);
+    writer.join();
+    EXPECT_GT(storage.getStats().cache.evictions, evictionsBefore);
+    EXPECT_EQ(storage.readNode(key(7))->getRegretSum()[0], 1007.F);
+  }
+  RocksDBNodeStorage checkpoint((dir / "rocksdb").string(), options);
+  EXPECT_EQ(checkpoint.size(), 400u);
+  EXPECT_FALSE(checkpoint.hasNode("9999Ra1"));
+  for (int i = 0; i < 400; ++i) {
+    const auto node = checkpoint.getNode(key(i));
+    ASSERT_NE(node, nullptr);
+    EXPECT_EQ(node->getRegretSum()[0], static_cast<float>(i));
+  }
+  std::filesystem::remove_all(path);
+  std::filesystem::remove_all(dir);
+}
+static void fillRandomStrategies(MapNodeStorage& source) {
+  std::mt19937 engine(7);
+  std::uniform_real_distribution<float> mass(0.F, 100.F);
+  for (int i = 0; i < 2000; ++i) {
+    const auto actions = static_cast<uint8_t>(2 + i % 4);
+    auto node = std::make_shared<Node>(actions);
+    std::vector<float> strategySum(actions);
+    for (float& value : strategySum) {
+      value = i % 3 == 0 ? 0.F : mass(engine);
+    }
+    node->setStrategySum(strategySum);
+    source.putNode(std::to_string(100000 + i) + "Ra1", node);
+  }
+}
+
+TEST(StorageTests, FrozenStrategyMatchesAverageStrategies) {
+  const auto path = std::filesystem::temp_directory_path() / "cfr_storagetest_frozen.bin";
+  MapNodeStorage source;
+  fillRandomStrategies(source);
+  const FrozenExportReport report = FrozenStrategy::write(source, path);
+  EXPECT_EQ(report.nodes, 2000u);
+  EXPECT_LT(report.maxL1Error, 1e-4);
+
+  FrozenStrategy frozen(path);
+  EXPECT_EQ(frozen.size(), 2000u);
+  float probabilities[FrozenStrategy::MaxActions];
+  source.forEachNode([&](const std::string& infoSet, const std::shared_ptr<Node>& node) {
+    const std::vector<float> expected = node->averageStrategyOf();
+    ASSERT_EQ(frozen.lookup(infoSet, probabilities), expected.size());
+    const auto served = frozen.getNode(infoSet);
+    ASSERT_NE(served, nullptr);
+    for (size_t a = 0; a < expected.size(); ++a) {
+      EXPECT_NEAR(probabilities[a], expected[a], 2e-5);
+      EXPECT_NEAR(served->getStrategy()[a], expected[a], 2e-5);
+    }
+  });
+  EXPECT_EQ(frozen.lookup("99Ra1", probabilities), 0u);
+  EXPECT_EQ(frozen.getNode("99Ra1"), nullptr);
+  EXPECT_FALSE(frozen.hasNode("99Ra1"));
+  EXPECT_THROW(frozen.putNode("99Ra1", std::make_shared<Node>(2)), std::logic_error);
+  std::filesystem::remove(path);
+}
+TEST(StorageTests, FrozenStrategyEightBitProbabilities) {
+  const auto path = std::filesystem::temp_directory_path() / "cfr_storagetest_frozen8.bin";
+  MapNodeStorage source;
+  fillRandomStrategies(source);
+  const FrozenExportReport wide = FrozenStrategy::write(source, path);
+  const FrozenExportReport report = FrozenStrategy::write(source, path, {ProbabilityPrecision::Bits8});
+  EXPECT_LT(report.fileBytes, wide.fileBytes);
+  EXPECT_GT(report.meanL1Error, 0.);
+  EXPECT_LE(report.meanL1Error, report.maxL1Error);
+
+  FrozenStrategy frozen(path);
+  EXPECT_EQ(frozen.precision(), ProbabilityPrecision::Bits8);
+  float probabilities[FrozenStrategy::MaxActions];
+  double maxError = 0;
+  source.forEachNode([&](const std::string& infoSet, const std::shared_ptr<Node>& node) {
+    const std::vector<float> expected = node->averageStrategyOf();
+    ASSERT_EQ(frozen.lookup(infoSet, probabilities), expected.size());
+    int steps = 0;
+    double error = 0;
+    for (size_t a = 0; a < expected.size(); ++a) {
+      // rounding moves each action by less than one step, in the original action order
+      EXPECT_LT(std::abs(probabilities[a] - expected[a]), 1.F / 255.F);
+      steps += static_cast<int>(std::lround(probabilities[a] * 255.F));
+      error += std::abs(probabilities[a] - expected[a]);
+    }
+    EXPECT_EQ(steps, 255);
+    maxError = std::max(maxError, error);
+  });
+  EXPECT_NEAR(maxError, report.maxL1Error, 1e-5);
+  std::filesystem::remove(path);
+}
+}
@@ -9,17 +9,11 @@
 
 #include "RegretMinimizer.hpp"
 
-//using wsl on my windows machine so detect linux header
-#ifdef __MINGW32__
-#define windowsOS true
-#else
-#define windowsOS false
-#endif
 
 
 namespace Texas {
 TEST(TexasTests, Game1) {
-  auto rng = std::mt19937(std::random_device()());
+  auto rng = Game::Engine(std::random_device()());
   Game *game1 = new Game(rng);
   // Expect equality.
   EXPECT_EQ(game1->getType(), "chance");
@@ -29,7 +23,7 @@ TEST(TexasTests, Game1) {
   EXPECT_EQ(game1->getType(), "terminal");
 
 
-  auto rng2 = std::mt19937(std::random_device()());
+  auto rng2 = Game::Engine(std::random_device()());
   Game *game2 = new Game(rng2);
 
   EXPECT_EQ(game2->currentRound, 0);
@@ -66,7 +60,7 @@ TEST(TexasTests, Game1) {
   EXPECT_EQ(game2->getType(), "terminal");
 
 
-  auto rng3 = std::mt19937(std::random_device()());
+  auto rng3 = Game::Engine(std::random_device()());
   Game *game3 = new Game(rng3);
 
   EXPECT_EQ(game3->currentRound, 0);
@@ -108,7 +102,7 @@ TEST(TexasTests, Game1) {
   game3->transition(Game::Action::Fold);
   EXPECT_EQ(game3->getType(), "terminal");
 
-  auto rng4 = std::mt19937(std::random_device()());
+  auto rng4 = Game::Engine(std::random_device()());
   auto *game4 = new Game(rng4);
 
   EXPECT_EQ(game4->currentRound, 0);
@@ -176,7 +170,7 @@ TEST(TexasUtilityTests, WorkingTest) {
 TEST(TexasRegretMinTests, Test1) {
   //Utility::initLookup();
   uint64_t seed = 120;
-  auto rng3 = std::mt19937(seed);
+  auto rng3 = Game::Engine(seed);
   Game *game3 = new Game(rng3);
   //game3->transition(Action::None);
 
@@ -197,11 +191,8 @@ TEST(TexasRegretMinTests, Test1) {
     p1look[i - 2] = game3->playableCards[i];
   }
 
-  if (windowsOS) {
-    EXPECT_EQ(weiUtil, 345.214783f);
-  } else {
-    EXPECT_EQ(weiUtil, 1773.4375f);
-  }
+  // dealing no longer goes through the standard library shuffle, so the value is the same on every platform
+  EXPECT_EQ(weiUtil, 345.214783f);
 
 }
 TEST(TexasHandAbstract, MainTest) {
@@ -258,5 +249,42 @@ TEST(TexasHandAbstract, MainTest) {
   hand_indexer_free(&flop_indexer);
   hand_indexer_free(&preflop_indexer);
 }
+TEST(RandomTests, PartialShuffleDealsDistinctCards) {
+  Game::Engine rng(5);
+  std::array<int, 9> counts{};
+  for (int deal = 0; deal < 2000; ++deal) {
+    std::array<uint8_t, Game::DeckCardNum> deck = Game::baseDeck;
+    Random::partialShuffle(std::span<uint8_t>(deck), 9, rng);
+    std::array<uint8_t, Game::DeckCardNum> sorted = deck;
+    std::ranges::sort(sorted);
+    ASSERT_EQ(sorted, Game::baseDeck);
+    // card 0 lands in each dealt position about 1/52 of the time
+    for (int i = 0; i < 9; ++i) {
+      counts[i] += deck[i] == 0;
+    }
+  }
+  for (const int count : counts) {
+    EXPECT_GT(count, 10);
+    EXPECT_LT(count, 80);
+  }
+}
+
+TEST(RandomTests, CategoricalSkipsZeroWeights) {
+  Random::Pcg32 rng(11);
+  const std::array<float, 4> strategy{0.f, 0.25f, 0.f, 0.75f};
+  std::array<int, 4> counts{};
+  for (int i = 0; i < 4000; ++i) {
+    ++counts[Random::sampleCategorical(std::span<const float>(strategy), rng)];
+  }
+  EXPECT_EQ(counts[0], 0);
+  EXPECT_EQ(counts[2], 0);
+  EXPECT_NEAR(counts[3] / 4000.0, 0.75, 0.05);
+
+  Random::WyRand wy(3);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_LT(Random::uniformBelow(wy, 7), 7u);
+  }
+  EXPECT_EQ(Random::Xoshiro256pp(9)(), Random::Xoshiro256pp(9)());
+}
 }
 
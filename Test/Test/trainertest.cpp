@@ -0,0 +1,481 @@
+#include <gtest/gtest.h>
+
+#include "../../CFR/AsyncTraversal.hpp"
+#include "../../CFR/Checkpoint.hpp"
+#include "../../CFR/Metrics.hpp"
+#include "../../CFR/MultiThreadedTrainer.hpp"
+#include "../../CFR/ThreadTopology.hpp"
+#include "../../CFR/WorkStealingScheduler.hpp"
+#include "../../Storage/AccessTrace.hpp"
+#include "../../Storage/MapNodeStorage.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+
+namespace CFR {
+
+/// @brief true if the ranges tile [0, total) with no gaps or overlaps
+bool coversExactly(std::vector<WorkStealingScheduler::Range> ranges, uint64_t total) {
+  std::ranges::sort(ranges, {}, &WorkStealingScheduler::Range::begin);
+  uint64_t expected = 0;
+  for (const auto& range : ranges) {
+    if (range.begin != expected || range.size() == 0) {
+      return false;
+    }
+    expected = range.end;
+  }
+  return expected == total;
+}
+
+TEST(SchedulerTests, SingleWorkerStealsEverything) {
+  WorkStealingScheduler scheduler(4, 64);
+  scheduler.reset(10007);
+
+  std::vector<WorkStealingScheduler::Range> ranges;
+  for (auto range = scheduler.next(0); range.size() > 0; range = scheduler.next(0)) {
+    EXPECT_LE(range.size(), 64u);
+    ranges.push_back(range);
+  }
+  EXPECT_TRUE(coversExactly(ranges, 10007));
+  EXPECT_GE(scheduler.steals(), 3u);
+  EXPECT_EQ(scheduler.remaining(), 0u);
+}
+
+TEST(SchedulerTests, ConcurrentWorkersCoverRunExactly) {
+  constexpr uint32_t workers = 8;
+  constexpr uint64_t total = 100003;
+  WorkStealingScheduler scheduler(workers);
+  scheduler.reset(total);
+
+  std::mutex mutex;
+  std::vector<WorkStealingScheduler::Range> ranges;
+  std::vector<std::thread> threads;
+  for (uint32_t w = 0; w < workers; ++w) {
+    threads.emplace_back([&, w] {
+      std::vector<WorkStealingScheduler::Range> mine;
+      // uneven work: odd workers are slow so the rest have to steal from them
+      for (auto range = scheduler.next(w); range.size() > 0; range = scheduler.next(w)) {
+        mine.push_back(range);
+        if (w % 2 == 1) {
+          std::this_thread::yield();
+        }
+      }
+      std::lock_guard lock(mutex);
+      ranges.insert(ranges.end(), mine.begin(), mine.end());
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_TRUE(coversExactly(ranges, total));
+}
+
+TEST(SchedulerTests, CancelDropsUnclaimedWork) {
+  WorkStealingScheduler scheduler(2, 10);
+  scheduler.reset(1000);
+  EXPECT_EQ(scheduler.next(1).size(), 10u);
+  scheduler.cancel();
+  EXPECT_EQ(scheduler.remaining(), 0u);
+  EXPECT_EQ(scheduler.next(0).size(), 0u);
+}
+/// @brief MapNodeStorage behind a mutex so several trainer threads can share it
+class LockedMapStorage : public MapNodeStorage {
+public:
+  std::shared_ptr<Node> getNode(const std::string& infoSet) override {
+    std::lock_guard lock(m_mutex);
+    return MapNodeStorage::getNode(infoSet);
+  }
+  void putNode(const std::string& infoSet, std::shared_ptr<Node> node) override {
+    std::lock_guard lock(m_mutex);
+    MapNodeStorage::putNode(infoSet, std::move(node));
+  }
+
+private:
+  std::mutex m_mutex;
+};
+
+/// @brief Counts how lookups and prefetch hints reach storage
+class BatchCountingStorage : public MapNodeStorage {
+public:
+  void getNodes(std::span<const std::string> infoSets, std::span<std::shared_ptr<Node>> out) override {
+    ++batches;
+    keys += infoSets.size();
+    MapNodeStorage::getNodes(infoSets, out);
+  }
+
+  void prefetch(const std::string& infoSet) const override {
+    ++prefetches;
+    MapNodeStorage::prefetch(infoSet);
+  }
+
+  uint64_t batches = 0;
+  uint64_t keys = 0;
+  mutable uint64_t prefetches = 0;
+};
+
+/// @brief Treats every node it did not create or admit as on disk, so each first lookup goes through loadNode
+class ColdStorage : public LockedMapStorage {
+public:
+  std::optional<std::shared_ptr<Node>> tryGetNode(const std::string& infoSet) override {
+    if (!m_resident.contains(infoSet)) {
+      return std::nullopt;
+    }
+    return getNode(infoSet);
+  }
+
+  std::shared_ptr<Node> loadNode(const std::string& infoSet) override {
+    const uint32_t running = ++m_loading;
+    uint32_t peak = peakLoads.load();
+    while (running > peak && !peakLoads.compare_exchange_weak(peak, running)) {}
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+    ++loads;
+    --m_loading;
+    return getNode(infoSet);
+  }
+
+  void admitNode(const std::string& infoSet, const std::shared_ptr<Node>& node) override {
+    (void)node;
+    m_resident.insert(infoSet);
+  }
+
+  void putNode(const std::string& infoSet, std::shared_ptr<Node> node) override {
+    m_resident.insert(infoSet);
+    LockedMapStorage::putNode(infoSet, std::move(node));
+  }
+
+  std::atomic<uint32_t> loads{0};
+  std::atomic<uint32_t> peakLoads{0};
+
+private:
+  std::unordered_set<std::string> m_resident;
+  std::atomic<uint32_t> m_loading{0};
+};
+
+TEST(TrainerTests, AsyncTrainingOverlapsReads) {
+  auto storage = std::make_shared<ColdStorage>();
+  RegretMinimizer<Preflop::Game, ColdStorage> minimizer(7, storage);
+  minimizer.setIoPool(std::make_shared<IoThreadPool>(4));
+  minimizer.TrainAsync(200, 16);
+
+  EXPECT_GT(storage->size(), 0u);
+  EXPECT_GT(storage->loads.load(), 0u);
+  // deals waiting on different keys have their reads served side by side
+  EXPECT_GT(storage->peakLoads.load(), 1u);
+}
+
+TEST(TrainerTests, BatchedTrainingGroupsLookups) {
+  auto storage = std::make_shared<BatchCountingStorage>();
+  RegretMinimizer<Preflop::Game, BatchCountingStorage> minimizer(7, storage);
+  minimizer.TrainBatched(100, 32);
+
+  EXPECT_GT(storage->size(), 0u);
+  // each batch carries the decision nodes of many deals at once
+  EXPECT_GT(storage->keys, 8 * storage->batches);
+}
+
+TEST(TrainerTests, PrefetchHintsChildInfoSets) {
+  auto storage = std::make_shared<BatchCountingStorage>();
+  RegretMinimizer<Preflop::Game, BatchCountingStorage> minimizer(7, storage);
+  minimizer.Train(20);
+  EXPECT_EQ(storage->prefetches, 0u);
+
+  minimizer.setPrefetch(true);
+  minimizer.Train(20);
+  EXPECT_GT(storage->prefetches, 0u);
+}
+
+TEST(TrainerTests, AccessTraceReplaysTraining) {
+  const auto path = std::filesystem::temp_directory_path() / "cfr_trainer_test.trace";
+  auto storage = std::make_shared<MapNodeStorage>();
+  {
+    RegretMinimizer<Preflop::Game> minimizer(7, storage);
+    minimizer.setTrace(std::make_shared<AccessTraceWriter>(path));
+    minimizer.Train(100);
+  }
+
+  const AccessTrace trace = AccessTrace::load(path);
+  std::filesystem::remove(path);
+  const auto puts = std::count_if(trace.records().begin(), trace.records().end(),
+                                  [](const AccessTrace::Record &record) { return record.op == AccessOp::Put; });
+  EXPECT_EQ(static_cast<size_t>(puts), storage->size());
+  EXPECT_EQ(trace.uniqueKeys(), storage->size());
+
+  // replay rebuilds the same node table, every get that training answered from the table is a hit again
+  MapNodeStorage replayed;
+  const ReplayResult result = replayTraces(replayed, std::span<const AccessTrace>(&trace, 1));
+  EXPECT_EQ(replayed.size(), storage->size());
+  EXPECT_EQ(result.puts, static_cast<uint64_t>(puts));
+  EXPECT_EQ(result.gets + result.puts, trace.records().size());
+  EXPECT_EQ(result.hits, result.gets - result.puts);
+  EXPECT_EQ(result.getLatency.count, result.gets);
+
+  const std::vector<AccessTrace> parts = trace.split(3);
+  size_t records = 0;
+  for (const AccessTrace &part : parts) {
+    records += part.records().size();
+  }
+  EXPECT_EQ(records, trace.records().size());
+}
+
+TEST(TrainerTests, BackToBackRunsCompleteExactly) {
+  MultiThreadedTrainer<Preflop::Game, LockedMapStorage> trainer(3);
+  for (const uint64_t iterations : {1u, 97u, 250u}) {
+    const RunHandle run = trainer.startRun(iterations);
+    const TrainingRunStats stats = run.wait();
+    EXPECT_TRUE(run.done());
+    EXPECT_FALSE(stats.cancelled);
+    EXPECT_EQ(stats.requested, iterations);
+    EXPECT_EQ(stats.iterations, iterations);
+    EXPECT_EQ(trainer.getCompletedIterations(), iterations);
+  }
+}
+
+TEST(TrainerTests, CancelledRunReleasesTrainer) {
+  MultiThreadedTrainer<Preflop::Game, LockedMapStorage> trainer(2);
+  const RunHandle run = trainer.startRun(1'000'000'000);
+  EXPECT_THROW(trainer.startRun(1), std::logic_error);
+
+  run.cancel();
+  const TrainingRunStats stats = run.wait();
+  EXPECT_TRUE(stats.cancelled);
+  EXPECT_LT(stats.iterations, stats.requested);
+  EXPECT_EQ(stats.iterations, run.completed());
+
+  EXPECT_EQ(trainer.startRun(10).wait().iterations, 10u);
+}
+/// @brief regret sums of every stored node, to compare the state of two trainers
+std::map<std::string, std::vector<float>> regretSums(const NodeStorage& storage) {
+  std::map<std::string, std::vector<float>> sums;
+  storage.forEachNode([&sums](const std::string& infoSet, const std::shared_ptr<Node>& node) {
+    sums.emplace(infoSet, node->getRegretSum());
+  });
+  return sums;
+}
+
+TEST(TrainerTests, CheckpointRestoresIntoFreshTrainer) {
+  const auto root = std::filesystem::temp_directory_path() / "cfr_trainertest_checkpoint";
+  std::filesystem::remove_all(root);
+  TrainerOptions options;
+  options.numThreads = 1;
+  options.masterSeed = 11;
+
+  std::map<std::string, std::vector<float>> saved;
+  {
+    MultiThreadedTrainer<Preflop::Game, LockedMapStorage> trainer(options);
+    trainer.startRun(150).wait();
+    const std::filesystem::path dir = trainer.checkpoint(root).get();
+    EXPECT_EQ(latestCheckpoint(root), dir);
+    EXPECT_TRUE(std::filesystem::exists(dir / "nodes.snapshot"));
+    saved = regretSums(*trainer.getStorage());
+  }
+
+  // two trainers resumed from one checkpoint continue identically
+  std::map<std::string, std::vector<float>> continued[2];
+  for (auto& sums : continued) {
+    options.masterSeed = 99;
+    MultiThreadedTrainer<Preflop::Game, LockedMapStorage> trainer(options);
+    const CheckpointManifest manifest = trainer.resume(root);
+    EXPECT_EQ(manifest.iterations, 150u);
+    EXPECT_EQ(manifest.runRemaining, 0u);
+    EXPECT_EQ(trainer.getMasterSeed(), 11u);
+    EXPECT_EQ(trainer.getTotalIterations(), 150u);
+    EXPECT_EQ(regretSums(*trainer.getStorage()), saved);
+
+    trainer.startRun(50).wait();
+    EXPECT_EQ(trainer.getTotalIterations(), 200u);
+    sums = regretSums(*trainer.getStorage());
+  }
+  EXPECT_EQ(continued[0], continued[1]);
+  EXPECT_NE(continued[0], saved);
+  std::filesystem::remove_all(root);
+}
+
+TEST(TrainerTests, CheckpointDuringRunRecordsRemainingWork) {
+  const auto root = std::filesystem::temp_directory_path() / "cfr_trainertest_checkpoint_run";
+  std::filesystem::remove_all(root);
+  TrainerOptions options;
+  options.numThreads = 2;
+  options.checkpointsKept = 1;
+  MultiThreadedTrainer<Preflop::Game, LockedMapStorage> trainer(options);
+
+  const RunHandle run = trainer.startRun(1'000'000'000);
+  std::filesystem::path first;
+  std::filesystem::path second;
+  while (trainer.getTotalIterations() == 0) {
+    std::this_thread::yield();
+  }
+  first = trainer.checkpoint(root).get();
+  second = trainer.checkpoint(root).get();
+  // workers are held only to pin the nodes, serializing and writing them happens while they train
+  const auto pause = std::chrono::duration_cast<std::chrono::microseconds>(trainer.getLastCheckpointPause());
+  RecordProperty("checkpoint_pause_us", std::to_string(pause.count()));
+  EXPECT_LT(pause, std::chrono::milliseconds(50));
+  run.cancel();
+  run.wait();
+
+  const CheckpointManifest manifest = CheckpointManifest::read(second / CheckpointManifest::FileName);
+  EXPECT_GT(manifest.iterations, 0u);
+  EXPECT_EQ(manifest.iterations + manifest.runRemaining, 1'000'000'000u);
+  EXPECT_EQ(manifest.engines.size(), 2u);
+  // only the newest checkpoint is kept
+  EXPECT_FALSE(std::filesystem::exists(first));
+  EXPECT_EQ(latestCheckpoint(root), second);
+  std::filesystem::remove_all(root);
+}
+
+TEST(TrainerTests, AsyncRunPublishesIterations) {
+  TrainerOptions options;
+  options.numThreads = 2;
+  options.asyncInFlight = 4;
+  MultiThreadedTrainer<Preflop::Game, LockedMapStorage> trainer(options);
+  trainer.startRun(90).wait();
+
+  const MetricsSnapshot snapshot = trainer.getMetrics()->snapshot();
+  EXPECT_EQ(snapshot.iterations, 90u);
+  EXPECT_GT(snapshot.nodesCreated, 0u);
+}
+
+TEST(TrainerTests, ResumeDoesNotCountIterations) {
+  const auto root = std::filesystem::temp_directory_path() / "cfr_trainertest_checkpoint_metrics";
+  std::filesystem::remove_all(root);
+  TrainerOptions options;
+  options.numThreads = 2;
+  // async workers hold batch deals, which resuming redeals
+  options.asyncInFlight = 4;
+  MultiThreadedTrainer<Preflop::Game, LockedMapStorage> trainer(options);
+  trainer.startRun(40).wait();
+  trainer.checkpoint(root).get();
+
+  trainer.resume(root);
+  EXPECT_EQ(trainer.getMetrics()->snapshot().iterations, 40u);
+  trainer.startRun(10).wait();
+  EXPECT_EQ(trainer.getMetrics()->snapshot().iterations, 50u);
+  std::filesystem::remove_all(root);
+}
+
+/// @brief body of an HTTP GET to a loopback port
+std::string httpGet(uint16_t port, const std::string& target) {
+  const int client = ::socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(port);
+  std::string response;
+  if (::connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+    const std::string request = "GET " + target + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    ::send(client, request.data(), request.size(), 0);
+    char buffer[4096];
+    for (ssize_t received; (received = ::recv(client, buffer, sizeof(buffer), 0)) > 0;) {
+      response.append(buffer, static_cast<size_t>(received));
+    }
+  }
+  ::close(client);
+  return response;
+}
+
+TEST(TrainerTests, PhaseProfileCoversTraining) {
+  auto storage = std::make_shared<MapNodeStorage>();
+  RegretMinimizer<Preflop::Game> minimizer(7, storage);
+  minimizer.Train(50);
+  const PhaseProfile profile = minimizer.getProfile();
+  const auto cycles = [&](Phase phase) { return profile.cycles[static_cast<size_t>(phase)]; };
+  if constexpr (!PhaseProfiler::Enabled) {
+    EXPECT_EQ(cycles(Phase::Total), 0u);
+    EXPECT_NE(profile.report().find("compiled out"), std::string::npos);
+    return;
+  }
+  EXPECT_EQ(profile.calls[static_cast<size_t>(Phase::Total)], 1u);
+  for (const Phase phase : {Phase::Transition, Phase::InfoSet, Phase::Storage, Phase::Regret, Phase::Showdown}) {
+    EXPECT_GT(cycles(phase), 0u) << phaseName(phase);
+  }
+  EXPECT_LT(cycles(Phase::Transition) + cycles(Phase::Storage) + cycles(Phase::Regret), cycles(Phase::Total));
+  EXPECT_EQ(profile.storagePuts.count, storage->size());
+  EXPECT_GE(profile.storageGets.count, profile.storagePuts.count);
+}
+
+TEST(TrainerTests, MetricsEndpointReportsTraining) {
+  const auto file = std::filesystem::temp_directory_path() / "cfr_trainertest_metrics.prom";
+  std::filesystem::remove(file);
+  TrainerOptions options;
+  options.numThreads = 2;
+  options.metricsPort = 0;
+  options.metricsFile = file;
+  {
+    MultiThreadedTrainer<Preflop::Game, LockedMapStorage> trainer(options);
+    trainer.startRun(120).wait();
+
+    const MetricsSnapshot snapshot = trainer.getMetrics()->snapshot();
+    EXPECT_EQ(snapshot.iterations, 120u);
+    EXPECT_EQ(snapshot.workerIterations.size(), 2u);
+    EXPECT_GT(snapshot.nodesTouched, snapshot.iterations);
+    EXPECT_GT(snapshot.nodesCreated, 0u);
+    EXPECT_GT(snapshot.averageRegretMagnitude(), 0.0);
+
+    ASSERT_NE(trainer.getMetricsPort(), 0);
+    const std::string response = httpGet(trainer.getMetricsPort(), "/metrics");
+    EXPECT_TRUE(response.starts_with("HTTP/1.1 200 OK"));
+    EXPECT_NE(response.find("\ncfr_iterations_total 120\n"), std::string::npos);
+    EXPECT_NE(response.find("# TYPE cfr_nodes_touched_total counter"), std::string::npos);
+    // exports keep no window of their own, so one consumer can't change what the next one reads
+    EXPECT_EQ(response.find("per_second"), std::string::npos);
+    EXPECT_NE(httpGet(trainer.getMetricsPort(), "/metrics").find("\ncfr_iterations_total 120\n"), std::string::npos);
+    EXPECT_TRUE(httpGet(trainer.getMetricsPort(), "/other").starts_with("HTTP/1.1 404"));
+  }
+  // the writer leaves a final sample behind when the trainer goes away
+  std::ifstream written(file);
+  const std::string text((std::istreambuf_iterator<char>(written)), std::istreambuf_iterator<char>());
+  EXPECT_NE(text.find("cfr_iterations_total 120"), std::string::npos);
+  std::filesystem::remove(file);
+}
+
+TEST(TopologyTests, ParsesKernelCpuLists) {
+  EXPECT_EQ(CpuTopology::parseCpuList("0-3,8,10-11"), (std::vector<uint32_t>{0, 1, 2, 3, 8, 10, 11}));
+  EXPECT_TRUE(CpuTopology::parseCpuList("").empty());
+}
+
+TEST(TopologyTests, PlacesPhysicalCoresBeforeSiblings) {
+  // Two nodes with two cores each, SMT siblings numbered after all first threads as Linux does
+  const CpuTopology topology({
+      {0, 0, 0, 0}, {1, 1, 0, 0}, {2, 0, 1, 1}, {3, 1, 1, 1},
+      {4, 0, 0, 0}, {5, 1, 0, 0}, {6, 0, 1, 1}, {7, 1, 1, 1},
+  });
+  EXPECT_EQ(topology.numaNodes(), 2u);
+  EXPECT_EQ(topology.placementOrder(), (std::vector<uint32_t>{0, 1, 2, 3, 4, 5, 6, 7}));
+
+  // Siblings numbered next to each other are still placed after every physical core
+  const CpuTopology adjacent({{0, 0, 0, 0}, {1, 0, 0, 0}, {2, 1, 0, 0}, {3, 1, 0, 0}});
+  EXPECT_EQ(adjacent.placementOrder(), (std::vector<uint32_t>{0, 2, 1, 3}));
+}
+
+TEST(TopologyTests, ThreadSeedsAreReproducibleAndDistinct) {
+  EXPECT_EQ(threadSeed(42, 3), threadSeed(42, 3));
+  EXPECT_NE(threadSeed(42, 3), threadSeed(42, 4));
+  EXPECT_NE(threadSeed(42, 3), threadSeed(43, 3));
+}
+
+TEST(TrainerTests, PinnedTrainerKeepsMasterSeed) {
+  TrainerOptions options;
+  options.numThreads = 2;
+  options.pinThreads = true;
+  options.masterSeed = 1234;
+  MultiThreadedTrainer<Preflop::Game, LockedMapStorage> trainer(options);
+  EXPECT_EQ(trainer.getMasterSeed(), 1234u);
+  EXPECT_EQ(trainer.getPinnedCpus().size(), 2u);
+  EXPECT_EQ(trainer.startRun(20).wait().iterations, 20u);
+}
+}
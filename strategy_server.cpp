@@ -0,0 +1,32 @@
+#include <csignal>
+#include <iostream>
+
+#include "Storage/FrozenStrategy.hpp"
+#include "Storage/StrategyServer.hpp"
+
+// Serves a frozen strategy file on a Unix socket until interrupted
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "usage: " << argv[0] << " <frozen strategy file> <socket path> [--preload]\n";
+        return 2;
+    }
+    const bool preload = argc > 3 && std::string_view(argv[3]) == "--preload";
+
+    // block the stop signals before any thread starts so only sigwait sees them
+    sigset_t stopSignals;
+    sigemptyset(&stopSignals);
+    sigaddset(&stopSignals, SIGINT);
+    sigaddset(&stopSignals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stopSignals, nullptr);
+
+    CFR::FrozenStrategy strategy(argv[1], preload);
+    CFR::StrategyServer server(strategy, argv[2]);
+    std::cout << "Serving " << strategy.size() << " info sets on " << server.socketPath().string() << std::endl;
+
+    int signal = 0;
+    sigwait(&stopSignals, &signal);
+
+    const CFR::LatencyHistogram::Snapshot latency = server.batchLatency();
+    std::cout << "Answered " << server.queriesServed() << " queries in " << latency.count << " batches, batch p50 "
+              << latency.percentileNanos(0.5) << " ns p99 " << latency.percentileNanos(0.99) << " ns" << std::endl;
+}